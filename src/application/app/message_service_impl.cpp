@@ -3,6 +3,7 @@
 #include <jsoncpp/json/json.h>
 
 #include "core/base/macro.hpp"
+#include "core/io/future.hpp"
 #include "core/util/time_util.hpp"
 
 #include "interface/api/ws_gateway_module.hpp"
@@ -821,6 +822,15 @@ Result<dto::MessageRecord> MessageServiceImpl::SendMessage(const uint64_t curren
     Result<dto::MessageRecord> result;
     std::string err;
 
+    // 0. 单聊好友关系校验是一次 RPC，与下面事务内的会话/序列号操作互不依赖，先并发发起
+    IM::Future<Result<IM::dto::ContactDetails>> contact_future;
+    if (talk_mode == 1 && m_contact_query_service) {
+        auto contact_service = m_contact_query_service;
+        contact_future = IM::Async([contact_service, to_from_id, current_user_id]() {
+            return contact_service->GetContactDetail(to_from_id, current_user_id);
+        });
+    }
+
     // 1. 开启事务。
     auto trans = IM::MySQLMgr::GetInstance()->openTransaction(kDBName, false);
     if (!trans) {
@@ -874,7 +884,7 @@ Result<dto::MessageRecord> MessageServiceImpl::SendMessage(const uint64_t curren
     bool deliver_to_receiver = true;    // 是否投递给接收者
     bool mark_invalid_message = false;  // 是否标记为失效（对方已删除我）
     if (talk_mode == 1) {
-        if (!m_contact_query_service) {
+        if (!contact_future.valid()) {
             trans->rollback();
             result.code = 500;
             result.err = "contact query service not ready";
@@ -882,7 +892,7 @@ Result<dto::MessageRecord> MessageServiceImpl::SendMessage(const uint64_t curren
         }
 
         // 查询接收者视角下是否仍是好友：owner=接收者, friend=发送者
-        auto rcv = m_contact_query_service->GetContactDetail(to_from_id, current_user_id);
+        auto rcv = contact_future.get();
         if (!rcv.ok) {
             trans->rollback();
             IM_LOG_ERROR(g_logger) << "SendMessage GetContactDetail(receiver_view) failed, err=" << rcv.err;
@@ -3,6 +3,7 @@
 #include <jsoncpp/json/json.h>
 
 #include "core/base/macro.hpp"
+#include "core/io/compute_pool.hpp"
 #include "core/util/password.hpp"
 #include "core/util/security_util.hpp"
 #include "core/util/time_util.hpp"
@@ -548,9 +549,9 @@ Result<model::User> UserServiceImpl::Authenticate(const std::string &mobile, con
     Result<model::User> result;
     std::string err;
 
-    // 密码解密
+    // 密码解密(RSA)，在计算池执行，登录高峰时不阻塞 IO 线程
     std::string decrypted_pwd;
-    auto dec_res = IM::util::DecryptPassword(password, decrypted_pwd);
+    auto dec_res = ComputePool::Await([&] { return IM::util::DecryptPassword(password, decrypted_pwd); });
     if (!dec_res.ok) {
         result.code = dec_res.code;
         result.err = dec_res.err;
@@ -592,8 +593,8 @@ Result<model::User> UserServiceImpl::Authenticate(const std::string &mobile, con
         return result;
     }
 
-    // 验证密码
-    if (!IM::util::Password::Verify(decrypted_pwd, ua.password_hash)) {
+    // 验证密码(PBKDF2)，在计算池执行
+    if (!ComputePool::Await([&] { return IM::util::Password::Verify(decrypted_pwd, ua.password_hash); })) {
         result.err = "手机号或密码错误";
         return result;
     }
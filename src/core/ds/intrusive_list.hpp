@@ -0,0 +1,113 @@
+/**
+ * @file intrusive_list.hpp
+ * @brief 侵入式双向链表
+ * @author DreamTraveler233
+ * @date 2026-01-10
+ *
+ * 链表指针保存在元素自身中，入队/出队/从中间摘除都是 O(1) 且不分配内存。
+ * 链表不拥有元素，元素的生命周期由调用方管理；同一时刻一个元素只能挂在一个链表上。
+ * 不加锁，由调用方负责同步。
+ */
+
+#ifndef __IM_DS_INTRUSIVE_LIST_HPP__
+#define __IM_DS_INTRUSIVE_LIST_HPP__
+
+#include <cstddef>
+
+#include "core/base/noncopyable.hpp"
+
+namespace IM::ds {
+/**
+ * @brief 侵入式双向链表
+ * @tparam T 元素类型
+ * @tparam PrevPtr 元素中的前驱指针成员
+ * @tparam NextPtr 元素中的后继指针成员
+ */
+template <class T, T *T::*PrevPtr = &T::prev, T *T::*NextPtr = &T::next>
+class IntrusiveList : public Noncopyable {
+   public:
+    /**
+     * @brief 首元素，空链表返回nullptr
+     */
+    T *front() const { return m_head; }
+
+    /**
+     * @brief 尾元素，空链表返回nullptr
+     */
+    T *back() const { return m_tail; }
+
+    /**
+     * @brief 元素的后继，到达尾部返回nullptr
+     */
+    static T *Next(T *node) { return node->*NextPtr; }
+
+    bool empty() const { return m_head == nullptr; }
+    size_t size() const { return m_size; }
+
+    /**
+     * @brief 追加到尾部
+     */
+    void push_back(T *node) {
+        node->*PrevPtr = m_tail;
+        node->*NextPtr = nullptr;
+        if (m_tail) {
+            m_tail->*NextPtr = node;
+        } else {
+            m_head = node;
+        }
+        m_tail = node;
+        ++m_size;
+    }
+
+    /**
+     * @brief 取出首元素，空链表返回nullptr
+     */
+    T *pop_front() {
+        T *node = m_head;
+        if (node) {
+            erase(node);
+        }
+        return node;
+    }
+
+    /**
+     * @brief 取出尾元素，空链表返回nullptr
+     */
+    T *pop_back() {
+        T *node = m_tail;
+        if (node) {
+            erase(node);
+        }
+        return node;
+    }
+
+    /**
+     * @brief 从链表中摘除元素
+     * @param[in] node 必须在本链表中
+     */
+    void erase(T *node) {
+        T *prev = node->*PrevPtr;
+        T *next = node->*NextPtr;
+        if (prev) {
+            prev->*NextPtr = next;
+        } else {
+            m_head = next;
+        }
+        if (next) {
+            next->*PrevPtr = prev;
+        } else {
+            m_tail = prev;
+        }
+        node->*PrevPtr = nullptr;
+        node->*NextPtr = nullptr;
+        --m_size;
+    }
+
+   private:
+    T *m_head = nullptr;  ///< 首元素
+    T *m_tail = nullptr;  ///< 尾元素
+    size_t m_size = 0;    ///< 元素数量
+};
+}  // namespace IM::ds
+
+#endif  // __IM_DS_INTRUSIVE_LIST_HPP__
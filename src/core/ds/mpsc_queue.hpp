@@ -0,0 +1,186 @@
+/**
+ * @file mpsc_queue.hpp
+ * @brief 无锁多生产者单消费者队列
+ * @author DreamTraveler233
+ * @date 2026-01-10
+ *
+ * 基于 Dmitry Vyukov 的侵入式 MPSC 队列算法：
+ * - 生产者 push 只有一次原子交换，wait-free，任意线程可并发调用
+ * - 消费者 pop 无需任何原子读改写，只允许一个线程调用
+ * 队列额外维护一个原子计数，push 可得知队列是否由空变为非空，便于调用方合并唤醒。
+ * MpscQueue 按值存放元素，每次 push 分配一个节点；IntrusiveMpscQueue 把链接指针放在元素自身中，不分配内存。
+ */
+
+#ifndef __IM_DS_MPSC_QUEUE_HPP__
+#define __IM_DS_MPSC_QUEUE_HPP__
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+#include "core/base/noncopyable.hpp"
+
+namespace IM::ds {
+/**
+ * @brief 多生产者单消费者无锁队列
+ * @tparam T 元素类型，需支持移动构造与移动赋值
+ *
+ * 注意：生产者完成原子交换但尚未链接 next 指针的瞬间，消费者可能短暂看到队列为空，
+ * 因此调用方应在 push 之后再唤醒消费者，而不是依赖 pop 的结果判断是否还有数据。
+ */
+template <class T>
+class MpscQueue : public Noncopyable {
+   private:
+    struct Node {
+        Node() = default;
+        explicit Node(T &&v) : value(std::move(v)) {}
+
+        std::atomic<Node *> next = {nullptr};
+        T value;
+    };
+
+   public:
+    MpscQueue() : m_head(&m_stub), m_tail(&m_stub) {}
+
+    ~MpscQueue() {
+        T tmp;
+        while (pop(tmp));
+        if (m_tail != &m_stub) {
+            delete m_tail;
+        }
+    }
+
+    /**
+     * @brief 入队(任意线程)
+     * @param[in] v 入队元素
+     * @return bool 入队前队列为空时返回true，调用方据此决定是否唤醒消费者
+     */
+    bool push(T v) {
+        Node *node = new Node(std::move(v));
+        Node *prev = m_head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+        return m_size.fetch_add(1, std::memory_order_acq_rel) == 0;
+    }
+
+    /**
+     * @brief 出队(仅消费者线程)
+     * @param[out] v 出队元素
+     * @return bool 成功取到元素返回true
+     */
+    bool pop(T &v) {
+        Node *tail = m_tail;
+        Node *next = tail->next.load(std::memory_order_acquire);
+        if (!next) {
+            return false;
+        }
+        // next 成为新的哨兵节点，其值移出后不再使用
+        v = std::move(next->value);
+        m_tail = next;
+        if (tail != &m_stub) {
+            delete tail;
+        }
+        m_size.fetch_sub(1, std::memory_order_acq_rel);
+        return true;
+    }
+
+    /**
+     * @brief 队列中的元素数量(近似值，仅供统计与唤醒判断)
+     */
+    size_t size() const { return m_size.load(std::memory_order_acquire); }
+
+    /**
+     * @brief 队列是否为空(近似值)
+     */
+    bool empty() const { return size() == 0; }
+
+   private:
+    std::atomic<Node *> m_head;             ///< 生产者端，指向最后入队的节点
+    alignas(64) Node *m_tail;               ///< 消费者端，指向当前哨兵节点(独占缓存行，避免与生产者伪共享)
+    alignas(64) std::atomic<size_t> m_size = {0};  ///< 元素数量
+    Node m_stub;                            ///< 初始哨兵节点
+};
+
+/**
+ * @brief 侵入式多生产者单消费者无锁队列
+ * @tparam T 元素类型，需可默认构造(用作哨兵)
+ * @tparam Next 元素中的原子后继指针成员
+ *
+ * 队列不拥有元素，pop 返回的元素由调用方管理；同一时刻一个元素只能在一个队列中。
+ * 与 MpscQueue 一样，push 完成交换但尚未链接的瞬间消费者可能看到队列为空。
+ */
+template <class T, std::atomic<T *> T::*Next>
+class IntrusiveMpscQueue : public Noncopyable {
+   public:
+    IntrusiveMpscQueue() : m_head(&m_stub), m_tail(&m_stub) { (m_stub.*Next).store(nullptr); }
+
+    /**
+     * @brief 入队(任意线程)
+     * @param[in] node 入队元素
+     * @return bool 入队前队列为空时返回true，调用方据此决定是否唤醒消费者
+     */
+    bool push(T *node) {
+        link(node);
+        return m_size.fetch_add(1, std::memory_order_acq_rel) == 0;
+    }
+
+    /**
+     * @brief 出队(仅消费者线程)
+     * @return T* 出队元素，队列为空(或生产者尚未完成链接)时返回nullptr
+     */
+    T *pop() {
+        T *tail = m_tail;
+        T *next = (tail->*Next).load(std::memory_order_acquire);
+        // 跳过哨兵
+        if (tail == &m_stub) {
+            if (!next) {
+                return nullptr;
+            }
+            m_tail = next;
+            tail = next;
+            next = (next->*Next).load(std::memory_order_acquire);
+        }
+        if (next) {
+            m_tail = next;
+            m_size.fetch_sub(1, std::memory_order_acq_rel);
+            return tail;
+        }
+        // tail 是最后一个元素：重新挂上哨兵，使 tail 的后继可用
+        if (tail != m_head.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        link(&m_stub);
+        next = (tail->*Next).load(std::memory_order_acquire);
+        if (next) {
+            m_tail = next;
+            m_size.fetch_sub(1, std::memory_order_acq_rel);
+            return tail;
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief 队列中的元素数量(近似值，仅供统计与唤醒判断)
+     */
+    size_t size() const { return m_size.load(std::memory_order_acquire); }
+
+    /**
+     * @brief 队列是否为空(近似值)
+     */
+    bool empty() const { return size() == 0; }
+
+   private:
+    void link(T *node) {
+        (node->*Next).store(nullptr, std::memory_order_relaxed);
+        T *prev = m_head.exchange(node, std::memory_order_acq_rel);
+        (prev->*Next).store(node, std::memory_order_release);
+    }
+
+   private:
+    std::atomic<T *> m_head;                       ///< 生产者端，指向最后入队的元素
+    alignas(64) T *m_tail;                         ///< 消费者端，指向下一个待出队的元素或哨兵
+    alignas(64) std::atomic<size_t> m_size = {0};  ///< 元素数量
+    T m_stub;                                      ///< 哨兵元素
+};
+}  // namespace IM::ds
+
+#endif  // __IM_DS_MPSC_QUEUE_HPP__
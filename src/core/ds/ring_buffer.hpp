@@ -0,0 +1,154 @@
+/**
+ * @file ring_buffer.hpp
+ * @brief 定长字节环形缓冲区
+ * @author DreamTraveler233
+ * @date 2026-01-10
+ *
+ * 用作连接的用户态接收缓冲：一次 readv 把内核中已到达的数据尽量读满缓冲区的空闲空间(绕回处拆成两段)，
+ * 解码器再通过 peek/consume 从中解析完整的帧，多个小帧一起到达时只需一次系统调用。
+ * 非线程安全，同一时刻只能由一个协程读写。
+ */
+
+#ifndef __IM_DS_RING_BUFFER_HPP__
+#define __IM_DS_RING_BUFFER_HPP__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <sys/uio.h>
+
+#include "core/base/noncopyable.hpp"
+
+namespace IM::ds {
+class RingBuffer : public Noncopyable {
+   public:
+    explicit RingBuffer(size_t capacity = 0) { reset(capacity); }
+
+    /**
+     * @brief 重新分配缓冲区，已缓存的数据被丢弃
+     * @param[in] capacity 容量，0 表示释放缓冲区
+     */
+    void reset(size_t capacity) {
+        m_data.reset(capacity ? new char[capacity] : nullptr);
+        m_capacity = capacity;
+        clear();
+    }
+
+    /**
+     * @brief 丢弃所有已缓存的数据
+     */
+    void clear() {
+        m_read = 0;
+        m_size = 0;
+    }
+
+    size_t capacity() const { return m_capacity; }
+
+    /**
+     * @brief 已缓存的字节数
+     */
+    size_t size() const { return m_size; }
+
+    /**
+     * @brief 空闲字节数
+     */
+    size_t available() const { return m_capacity - m_size; }
+
+    bool empty() const { return m_size == 0; }
+
+    /**
+     * @brief 获取可读数据所在的内存段，不移动读位置
+     * @param[out] iov 至少2个元素
+     * @param[in] len 最多取的字节数
+     * @return size_t 使用的段数(0~2)
+     */
+    size_t getReadBuffers(iovec *iov, size_t len) const {
+        len = std::min(len, m_size);
+        if (!len) {
+            return 0;
+        }
+        size_t first = std::min(len, m_capacity - m_read);
+        iov[0].iov_base = m_data.get() + m_read;
+        iov[0].iov_len = first;
+        if (first == len) {
+            return 1;
+        }
+        iov[1].iov_base = m_data.get();
+        iov[1].iov_len = len - first;
+        return 2;
+    }
+
+    /**
+     * @brief 复制数据但不移出
+     * @return size_t 实际复制的字节数
+     */
+    size_t peek(void *buf, size_t len) const {
+        iovec iov[2];
+        size_t cnt = getReadBuffers(iov, len);
+        size_t rt = 0;
+        for (size_t i = 0; i < cnt; ++i) {
+            memcpy((char *)buf + rt, iov[i].iov_base, iov[i].iov_len);
+            rt += iov[i].iov_len;
+        }
+        return rt;
+    }
+
+    /**
+     * @brief 移出数据
+     * @param[in] len 移出的字节数，超过已缓存数据时按已缓存数据计
+     */
+    void consume(size_t len) {
+        len = std::min(len, m_size);
+        m_size -= len;
+        // 读空后回到起点，下次写入尽量是一整段连续内存
+        m_read = m_size ? (m_read + len) % m_capacity : 0;
+    }
+
+    /**
+     * @brief 复制并移出数据
+     * @return size_t 实际读取的字节数
+     */
+    size_t read(void *buf, size_t len) {
+        size_t rt = peek(buf, len);
+        consume(rt);
+        return rt;
+    }
+
+    /**
+     * @brief 获取空闲空间所在的内存段，供 readv/recvmsg 直接写入
+     * @param[out] iov 至少2个元素
+     * @return size_t 使用的段数(0~2)
+     */
+    size_t getWriteBuffers(iovec *iov) const {
+        size_t free = available();
+        if (!free) {
+            return 0;
+        }
+        size_t write = (m_read + m_size) % m_capacity;
+        size_t first = std::min(free, m_capacity - write);
+        iov[0].iov_base = m_data.get() + write;
+        iov[0].iov_len = first;
+        if (first == free) {
+            return 1;
+        }
+        iov[1].iov_base = m_data.get();
+        iov[1].iov_len = free - first;
+        return 2;
+    }
+
+    /**
+     * @brief 确认已写入 getWriteBuffers 返回的空间
+     * @param[in] len 写入的字节数
+     */
+    void commitWrite(size_t len) { m_size += std::min(len, available()); }
+
+   private:
+    std::unique_ptr<char[]> m_data;  ///< 缓冲区
+    size_t m_capacity = 0;           ///< 容量
+    size_t m_read = 0;               ///< 读位置
+    size_t m_size = 0;               ///< 已缓存的字节数
+};
+}  // namespace IM::ds
+
+#endif  // __IM_DS_RING_BUFFER_HPP__
@@ -0,0 +1,436 @@
+/**
+ * @file channel.hpp
+ * @brief 协程间通信的有界多生产者多消费者通道
+ * @author DreamTraveler233
+ * @date 2026-01-10
+ *
+ * Channel<T> 语义与 Go channel 类似：
+ * - 容量为 capacity 的缓冲区，满时 send 挂起当前协程，空时 recv 挂起当前协程；capacity 为0时收发双方直接交接
+ * - 有等待的接收方时发送方直接把值交给它，不经过缓冲区
+ * - close 后 send 返回false，recv 先取完缓冲区中剩余的值再返回false，所有等待者被唤醒
+ * ChannelSelect 同时等待多个通道的接收，任一通道可读(或已关闭)时返回对应分支。
+ * 与 CoroutineMutex 一样，在普通线程中使用时阻塞在信号量上。
+ *
+ *     Channel<int> jobs(128);
+ *     Channel<std::string> quit(1);
+ *     ChannelSelect sel;
+ *     int job_case = sel.recv(jobs, job);
+ *     int quit_case = sel.recv(quit, reason);
+ *     int which = sel.wait();
+ */
+
+#ifndef __IM_IO_CHANNEL_HPP__
+#define __IM_IO_CHANNEL_HPP__
+
+#include <atomic>
+#include <deque>
+#include <list>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "core/io/lock.hpp"
+
+namespace IM {
+class ChannelSelect;
+
+/**
+ * @brief 有界 MPMC 通道
+ * @tparam T 元素类型，需可移动构造
+ */
+template <class T>
+class Channel : Noncopyable {
+   public:
+    using ptr = std::shared_ptr<Channel>;
+
+    /**
+     * @brief 构造函数
+     * @param[in] capacity 缓冲区容量，0表示无缓冲(发送方等待接收方取走)
+     */
+    explicit Channel(size_t capacity) : m_capacity(capacity) {}
+
+    /**
+     * @brief 发送，缓冲区满时挂起
+     * @return 通道已关闭时返回false，值被丢弃
+     */
+    bool send(T value) {
+        std::shared_ptr<SyncWaitState> wake;
+        {
+            SpinLock::Lock lock(m_mutex);
+            if (m_closed) {
+                return false;
+            }
+            if (putLocked(value, wake)) {
+                lock.unlock();
+                Wake(wake);
+                return true;
+            }
+        }
+        SyncParker parker;
+        auto node = std::make_shared<SendNode>();
+        node->state = std::make_shared<SyncWaitState>();
+        node->state->waiter = parker.waiter();
+        node->value.emplace(std::move(value));
+        {
+            SpinLock::Lock lock(m_mutex);
+            if (m_closed) {
+                return false;
+            }
+            if (putLocked(*node->value, wake)) {
+                lock.unlock();
+                Wake(wake);
+                return true;
+            }
+            m_sendq.push_back(node);
+        }
+        // 被接收方取走或通道关闭时唤醒
+        parker.park();
+        return node->ok;
+    }
+
+    /**
+     * @brief 尝试发送，不等待
+     * @param[in,out] value 发送成功时被移走
+     * @return 通道已满或已关闭时返回false
+     */
+    bool trySend(T &value) {
+        std::shared_ptr<SyncWaitState> wake;
+        {
+            SpinLock::Lock lock(m_mutex);
+            if (m_closed || !putLocked(value, wake)) {
+                return false;
+            }
+        }
+        Wake(wake);
+        return true;
+    }
+
+    /**
+     * @brief 接收，通道为空时挂起
+     * @param[out] out 接收到的值
+     * @return 通道已关闭且没有剩余数据时返回false
+     */
+    bool recv(T &out) {
+        if (tryRecv(out)) {
+            return true;
+        }
+        SyncParker parker;
+        auto node = std::make_shared<RecvNode>();
+        node->state = std::make_shared<SyncWaitState>();
+        node->state->waiter = parker.waiter();
+        if (selectRecv(node) == 0) {
+            parker.park();
+        }
+        if (!node->value) {
+            return false;
+        }
+        out = std::move(*node->value);
+        return true;
+    }
+
+    /**
+     * @brief 尝试接收，不等待
+     * @return 通道为空(或已关闭且为空)时返回false
+     */
+    bool tryRecv(T &out) {
+        std::shared_ptr<SyncWaitState> wake;
+        std::optional<T> value;
+        {
+            SpinLock::Lock lock(m_mutex);
+            if (!takeLocked(value, wake)) {
+                return false;
+            }
+        }
+        Wake(wake);
+        out = std::move(*value);
+        return true;
+    }
+
+    /**
+     * @brief 关闭通道，唤醒所有等待的收发方
+     */
+    void close() {
+        std::list<std::shared_ptr<RecvNode>> recvq;
+        std::list<std::shared_ptr<SendNode>> sendq;
+        {
+            SpinLock::Lock lock(m_mutex);
+            if (m_closed) {
+                return;
+            }
+            m_closed = true;
+            recvq.swap(m_recvq);
+            sendq.swap(m_sendq);
+        }
+        for (auto &i : recvq) {
+            if (i->state->tryFire(i->index)) {
+                Wake(i->state);
+            }
+        }
+        for (auto &i : sendq) {
+            if (i->state->tryFire(i->index)) {
+                Wake(i->state);
+            }
+        }
+    }
+
+    bool isClosed() const {
+        SpinLock::Lock lock(m_mutex);
+        return m_closed;
+    }
+
+    /**
+     * @brief 缓冲区中的元素数量
+     */
+    size_t size() const {
+        SpinLock::Lock lock(m_mutex);
+        return m_buffer.size();
+    }
+
+    size_t capacity() const { return m_capacity; }
+
+   private:
+    friend class ChannelSelect;
+
+    /**
+     * @brief 等待接收的节点
+     */
+    struct RecvNode {
+        std::shared_ptr<SyncWaitState> state;  ///< 等待状态
+        int index = 0;                            ///< 所属分支
+        std::optional<T> value;                   ///< 接收到的值，为空表示通道已关闭
+    };
+
+    /**
+     * @brief 等待发送的节点
+     */
+    struct SendNode {
+        std::shared_ptr<SyncWaitState> state;  ///< 等待状态
+        int index = 0;                            ///< 所属分支
+        std::optional<T> value;                   ///< 待发送的值
+        bool ok = false;                          ///< 是否已被接收方取走
+    };
+
+    static void Wake(const std::shared_ptr<SyncWaitState> &state) {
+        if (state) {
+            state->waiter.wake();
+        }
+    }
+
+    /**
+     * @brief 交给等待的接收方或放入缓冲区，需持有锁
+     * @param[out] wake 需要在释放锁后唤醒的等待者
+     */
+    bool putLocked(T &value, std::shared_ptr<SyncWaitState> &wake) {
+        while (!m_recvq.empty()) {
+            auto node = std::move(m_recvq.front());
+            m_recvq.pop_front();
+            // select 的其他分支已经完成时跳过该节点
+            if (node->state->tryFire(node->index)) {
+                node->value.emplace(std::move(value));
+                wake = node->state;
+                return true;
+            }
+        }
+        if (m_buffer.size() < m_capacity) {
+            m_buffer.push_back(std::move(value));
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief 从缓冲区或等待的发送方取值，需持有锁
+     * @param[out] wake 需要在释放锁后唤醒的等待者
+     */
+    bool takeLocked(std::optional<T> &out, std::shared_ptr<SyncWaitState> &wake) {
+        if (!m_buffer.empty()) {
+            out.emplace(std::move(m_buffer.front()));
+            m_buffer.pop_front();
+            // 缓冲区腾出位置，补入一个等待的发送方
+            while (!m_sendq.empty()) {
+                auto node = std::move(m_sendq.front());
+                m_sendq.pop_front();
+                if (node->state->tryFire(node->index)) {
+                    m_buffer.push_back(std::move(*node->value));
+                    node->ok = true;
+                    wake = node->state;
+                    break;
+                }
+            }
+            return true;
+        }
+        while (!m_sendq.empty()) {
+            auto node = std::move(m_sendq.front());
+            m_sendq.pop_front();
+            if (node->state->tryFire(node->index)) {
+                out.emplace(std::move(*node->value));
+                node->ok = true;
+                wake = node->state;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief 为接收节点取值或登记等待
+     * @return 1 已取到值或确认通道关闭(节点已完成)，0 已登记等待，-1 节点所属的 select 已由其他分支完成
+     */
+    int selectRecv(const std::shared_ptr<RecvNode> &node) {
+        std::shared_ptr<SyncWaitState> wake;
+        {
+            SpinLock::Lock lock(m_mutex);
+            if (!m_buffer.empty() || !m_sendq.empty() || m_closed) {
+                if (!node->state->tryFire(node->index)) {
+                    return -1;
+                }
+                // 通道已关闭且没有剩余数据时 value 保持为空
+                takeLocked(node->value, wake);
+            } else {
+                m_recvq.push_back(node);
+                return 0;
+            }
+        }
+        Wake(wake);
+        return 1;
+    }
+
+    /**
+     * @brief 撤销登记的接收节点
+     */
+    void cancelRecv(const std::shared_ptr<RecvNode> &node) {
+        SpinLock::Lock lock(m_mutex);
+        for (auto it = m_recvq.begin(); it != m_recvq.end(); ++it) {
+            if (*it == node) {
+                m_recvq.erase(it);
+                break;
+            }
+        }
+    }
+
+   private:
+    mutable SpinLock m_mutex;                      ///< 保护以下所有成员
+    size_t m_capacity;                             ///< 缓冲区容量
+    bool m_closed = false;                         ///< 是否已关闭
+    std::deque<T> m_buffer;                        ///< 缓冲区
+    std::list<std::shared_ptr<RecvNode>> m_recvq;  ///< 等待接收的节点
+    std::list<std::shared_ptr<SendNode>> m_sendq;  ///< 等待发送的节点
+};
+
+/**
+ * @brief 同时等待多个通道的接收
+ * @details 先用 recv 登记分支，再调用 wait/tryWait。一个 ChannelSelect 对象只能等待一次。
+ */
+class ChannelSelect : Noncopyable {
+   public:
+    /**
+     * @brief 登记一个接收分支
+     * @param[in] ch 通道，等待期间必须有效
+     * @param[out] out 该分支完成时接收到的值
+     * @param[out] ok 可选，该分支完成时是否取到值(false表示通道已关闭)
+     * @return int 分支下标
+     */
+    template <class T>
+    int recv(Channel<T> &ch, T &out, bool *ok = nullptr) {
+        m_cases.emplace_back(new RecvCase<T>(ch, out, ok));
+        return m_cases.size() - 1;
+    }
+
+    /**
+     * @brief 等待任一分支完成
+     * @return int 完成的分支下标
+     */
+    int wait() { return doWait(true); }
+
+    /**
+     * @brief 不等待，检查是否有分支可以立即完成
+     * @return int 完成的分支下标，没有时返回-1
+     */
+    int tryWait() { return doWait(false); }
+
+   private:
+    struct Case {
+        virtual ~Case() {}
+        /// 登记到通道，返回值同 Channel::selectRecv
+        virtual int enqueue(const std::shared_ptr<SyncWaitState> &state, int index) = 0;
+        /// 从通道撤销登记
+        virtual void cancel() = 0;
+        /// 把接收到的值交给调用方
+        virtual void complete() = 0;
+    };
+
+    template <class T>
+    struct RecvCase : Case {
+        RecvCase(Channel<T> &ch, T &out, bool *ok) : ch(ch), out(out), ok(ok) {}
+
+        int enqueue(const std::shared_ptr<SyncWaitState> &state, int index) override {
+            node = std::make_shared<typename Channel<T>::RecvNode>();
+            node->state = state;
+            node->index = index;
+            return ch.selectRecv(node);
+        }
+
+        void cancel() override { ch.cancelRecv(node); }
+
+        void complete() override {
+            if (ok) {
+                *ok = (bool)node->value;
+            }
+            if (node->value) {
+                out = std::move(*node->value);
+            }
+        }
+
+        Channel<T> &ch;
+        T &out;
+        bool *ok;
+        std::shared_ptr<typename Channel<T>::RecvNode> node;
+    };
+
+    int doWait(bool block) {
+        SyncParker parker;
+        auto state = std::make_shared<SyncWaitState>();
+        if (block) {
+            state->waiter = parker.waiter();
+        }
+        bool ready = false;
+        size_t enqueued = 0;
+        for (; enqueued < m_cases.size(); ++enqueued) {
+            int rt = m_cases[enqueued]->enqueue(state, enqueued);
+            if (rt != 0) {
+                // 1: 本分支直接完成；-1: 已有其他通道的发送方完成了某个分支并会唤醒我们
+                ready = rt == 1;
+                ++enqueued;
+                break;
+            }
+        }
+        if (!block && state->fired.load() < 0) {
+            // 非阻塞：没有分支完成，抢先占用状态防止之后的发送方再完成分支
+            if (state->tryFire(m_cases.size())) {
+                for (size_t i = 0; i < enqueued; ++i) {
+                    m_cases[i]->cancel();
+                }
+                return -1;
+            }
+        }
+        if (!ready) {
+            if (block) {
+                parker.park();
+            } else {
+                // 非阻塞且分支已被其他线程的发送方完成，发送方唤醒时 waiter 为空，无需等待
+            }
+        }
+        for (size_t i = 0; i < enqueued; ++i) {
+            m_cases[i]->cancel();
+        }
+        int fired = state->fired.load();
+        m_cases[fired]->complete();
+        return fired;
+    }
+
+   private:
+    std::vector<std::unique_ptr<Case>> m_cases;  ///< 各分支
+};
+}  // namespace IM
+
+#endif  // __IM_IO_CHANNEL_HPP__
@@ -0,0 +1,58 @@
+#include "core/io/compute_pool.hpp"
+
+#include <atomic>
+
+#include "core/config/config.hpp"
+#include "core/io/worker.hpp"
+#include "core/util/util.hpp"
+
+namespace IM {
+static auto g_compute_worker =
+    Config::Lookup("compute.worker", std::string("compute"), "compute pool name in workers config");
+static auto g_compute_max_pending =
+    Config::Lookup("compute.max_pending", (uint32_t)1024, "compute pool max queued and running tasks");
+
+static std::atomic<uint64_t> s_pending = {0};
+
+Scheduler *ComputePool::GetScheduler() {
+    return WorkerMgr::GetInstance()->get(g_compute_worker->getValue()).get();
+}
+
+uint64_t ComputePool::GetPending() {
+    return s_pending.load(std::memory_order_relaxed);
+}
+
+Scheduler *ComputePool::Acquire() {
+    Scheduler *caller = Scheduler::GetThis();
+    if (!caller) {
+        return nullptr;
+    }
+    // 调度器主协程(run 所在协程)不能挂起，共享栈协程挂起后栈上的参数不可访问
+    Coroutine *self = Coroutine::GetThis().get();
+    if (self == Scheduler::GetMainCoroutine() || self->isSharedStack()) {
+        return nullptr;
+    }
+    Scheduler *pool = GetScheduler();
+    if (!pool || pool == caller) {
+        return nullptr;
+    }
+    if (s_pending.fetch_add(1, std::memory_order_relaxed) >= g_compute_max_pending->getValue()) {
+        s_pending.fetch_sub(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    return pool;
+}
+
+void ComputePool::Run(Scheduler *pool, TaskFunc job) {
+    Scheduler *caller = Scheduler::GetThis();
+    Coroutine::ptr self = Coroutine::GetThis();
+    pid_t thread = GetThreadId();
+    pool->schedule([job = std::move(job), caller, self = std::move(self), thread]() mutable {
+        job();
+        s_pending.fetch_sub(1, std::memory_order_relaxed);
+        // 投递回挂起前所在的线程，该线程在协程让出前不会从信箱取出它
+        caller->schedule(std::move(self), thread);
+    });
+    Coroutine::YieldToHold();
+}
+}  // namespace IM
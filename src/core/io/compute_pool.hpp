@@ -0,0 +1,107 @@
+/**
+ * @file compute_pool.hpp
+ * @brief CPU 密集任务的计算池与协程等待接口
+ * @author DreamTraveler233
+ * @date 2026-01-10
+ *
+ * 密码哈希、RSA 解密、大包 gzip 等 CPU 密集操作若直接在 IO 线程执行，会阻塞同线程上的所有连接。
+ * 计算池是 workers 配置中的一个独立调度器(名称由 compute.worker 指定，默认 compute)，
+ * ComputePool::Await 把函数投递到计算池执行，当前协程让出 IO 线程，结果就绪后再被投递回原线程继续运行：
+ *
+ *     bool ok = ComputePool::Await([&] { return Password::Verify(pwd, hash); });
+ *
+ * 以下情况直接在当前线程执行，行为与同步调用一致：
+ * - 不在调度器的任务协程中(如主线程、独立线程)
+ * - 当前是共享栈协程：挂起后栈内容被换出，计算线程无法访问其栈上的参数
+ * - 计算池未配置，或当前已在计算池线程上
+ * - 计算池中排队与执行中的任务数达到 compute.max_pending(调用方执行，形成反压)
+ * 函数抛出的异常会在等待方协程中重新抛出。
+ */
+
+#ifndef __IM_IO_COMPUTE_POOL_HPP__
+#define __IM_IO_COMPUTE_POOL_HPP__
+
+#include <exception>
+#include <optional>
+#include <stdint.h>
+#include <type_traits>
+
+#include "core/io/task_func.hpp"
+
+namespace IM {
+class Scheduler;
+
+/**
+ * @brief 计算池
+ */
+class ComputePool {
+   public:
+    /**
+     * @brief 在计算池中执行函数并等待结果
+     * @param[in] f 无参可调用对象，由计算池线程执行，执行期间等待方协程挂起，可按引用捕获等待方的局部变量
+     * @return 函数的返回值
+     */
+    template <class F>
+    static auto Await(F &&f) -> decltype(f()) {
+        using R = decltype(f());
+        static_assert(!std::is_reference<R>::value, "ComputePool::Await returns by value");
+        Scheduler *pool = Acquire();
+        if (!pool) {
+            return f();
+        }
+        // 等待方协程在任务完成前不会恢复，结果可以直接放在它的栈上
+        State<R> state;
+        Run(pool, [&state, &f]() {
+            try {
+                if constexpr (std::is_void<R>::value) {
+                    f();
+                } else {
+                    state.value.emplace(f());
+                }
+            } catch (...) {
+                state.error = std::current_exception();
+            }
+        });
+        if (state.error) {
+            std::rethrow_exception(state.error);
+        }
+        if constexpr (!std::is_void<R>::value) {
+            return std::move(*state.value);
+        }
+    }
+
+    /**
+     * @brief 获取计算池调度器
+     * @return 未配置时返回nullptr
+     */
+    static Scheduler *GetScheduler();
+
+    /**
+     * @brief 计算池中排队与执行中的任务数
+     */
+    static uint64_t GetPending();
+
+   private:
+    template <class R>
+    struct State {
+        using Value = typename std::conditional<std::is_void<R>::value, char, R>::type;
+        std::optional<Value> value;  ///< 返回值
+        std::exception_ptr error;    ///< 函数抛出的异常
+    };
+
+    /**
+     * @brief 检查能否把任务投递到计算池，能则占用一个排队名额
+     * @return 计算池调度器，需要在当前线程直接执行时返回nullptr
+     */
+    static Scheduler *Acquire();
+
+    /**
+     * @brief 把任务投递到计算池并挂起当前协程，任务执行完毕、协程被投递回原线程后返回
+     * @param[in] pool Acquire 返回的计算池
+     * @param[in] job 任务，不会抛出异常
+     */
+    static void Run(Scheduler *pool, TaskFunc job);
+};
+}  // namespace IM
+
+#endif  // __IM_IO_COMPUTE_POOL_HPP__
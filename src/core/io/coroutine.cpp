@@ -1,10 +1,16 @@
 #include "core/io/coroutine.hpp"
 
 #include <atomic>
+#include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <vector>
 
 #include "core/base/macro.hpp"
 #include "core/config/config.hpp"
 #include "core/io/scheduler.hpp"
+#include "core/io/stack_profiler.hpp"
+#include "core/util/time_util.hpp"
 #include "core/util/util.hpp"
 
 namespace IM {
@@ -33,25 +39,67 @@ struct CoroutineInit {
 };
 static CoroutineInit __coroutine_init;
 
-using StackAllocator = MallocStackAllocator;
+// 定义配置项--每个线程最多缓存的空闲协程栈数量--0表示不缓存
+static auto g_stack_pool_max_cached =
+    Config::Lookup<uint32_t>("coroutine.stack_pool.max_cached", 64, "max idle coroutine stacks cached per thread");
+// 定义配置项--空闲栈闲置多久后归还物理内存(毫秒)
+static auto g_stack_pool_idle_release_ms = Config::Lookup<uint32_t>(
+    "coroutine.stack_pool.idle_release_ms", 10000, "madvise idle pooled coroutine stacks after this many ms");
 
-Coroutine::Coroutine() : m_state(State::EXEC) {
-    // 获取上下文，接管当前线程
-    if (getcontext(&m_ctx)) {
-        IM_ASSERT2(false, "getcontext");
-        return;  // 如果有适当的错误处理机制，应该在这里处理
+using StackAllocator = PooledStackAllocator;
+
+static std::atomic<uint64_t> s_shared_coroutines = {0};  // 存活的共享栈协程数量
+static std::atomic<uint64_t> s_shared_saved = {0};       // 共享栈快照占用的字节数
+static std::atomic<uint64_t> s_shared_copies = {0};      // 共享栈拷贝次数
+
+// 共享栈依赖挂起时的精确栈指针，只有汇编上下文切换能提供，其他平台退化为私有栈
+#define IM_SHARED_STACK_SUPPORTED IM_CONTEXT_ASM
+
+/**
+ * @brief 线程共享栈
+ * @details 只由所属线程访问，occupant 为当前栈内容所属的协程
+ */
+struct SharedStack {
+    SharedStack() : size(s_coroutine_stack_size) { stack = StackAllocator::Alloc(size); }
+    ~SharedStack() { StackAllocator::Dealloc(stack, size); }
+
+    char *top() const { return (char *)stack + size; }
+
+    void *stack = nullptr;          // 栈空间
+    size_t size = 0;                // 栈大小
+    Coroutine *occupant = nullptr;  // 栈上当前驻留的协程
+};
+
+static thread_local std::unique_ptr<SharedStack> t_shared_stack;
+
+static SharedStack *GetSharedStack() {
+    if (!t_shared_stack) {
+        t_shared_stack.reset(new SharedStack);
     }
+    return t_shared_stack.get();
+}
 
+Coroutine::Coroutine() : m_state(State::EXEC) {
+    // 主协程运行在线程原生栈上，上下文在第一次切出时保存，无需初始化
     // 设置线程局部变量
     SetThis(this);
     ++s_coroutine_count;
     IM_LOG_DEBUG(g_logger) << "Coroutine::Coroutine() id=" << m_id;
 }
 
-Coroutine::Coroutine(std::function<void()> cb, size_t stack_size, bool use_caller) : m_id(++s_coroutine_id), m_cb(cb) {
-    IM_ASSERT(cb);
+Coroutine::Coroutine(TaskFunc cb, size_t stack_size, bool use_caller, bool shared_stack)
+    : m_id(++s_coroutine_id), m_cb(std::move(cb)) {
+    IM_ASSERT(m_cb);
     ++s_coroutine_count;
 
+    if (shared_stack && !use_caller && IM_SHARED_STACK_SUPPORTED) {
+        // 共享栈协程在首次 swapIn 时才绑定线程并初始化上下文
+        m_shared = true;
+        ++s_shared_coroutines;
+        IM_LOG_DEBUG(g_logger) << "Coroutine::Coroutine() shared id=" << m_id;
+        return;
+    }
+
     // 使用局部变量管理栈空间，确保异常安全性
     void *stack = nullptr;
     size_t stack_size_temp = stack_size ? stack_size : s_coroutine_stack_size;
@@ -61,23 +109,14 @@ Coroutine::Coroutine(std::function<void()> cb, size_t stack_size, bool use_calle
         stack = StackAllocator::Alloc(stack_size_temp);
         m_stack_size = stack_size_temp;
         m_stack = stack;
-
-        // 初始化上下文
-        m_ctx.uc_link = nullptr;                // 协程执行完成后返回的上下文
-        m_ctx.uc_stack.ss_sp = m_stack;         // 栈空间地址
-        m_ctx.uc_stack.ss_size = m_stack_size;  // 栈空间大小
-
-        // 获取当前线程上下文环境
-        if (getcontext(&m_ctx)) {
-            IM_ASSERT2(false, "getcontext");
+        // 栈深度统计：上下文初始化前填充哨兵值
+        if (!use_caller && StackProfiler::ShouldProfile()) {
+            StackProfiler::Paint(m_stack, m_stack_size);
+            m_stackProfiled = true;
         }
 
-        // 设置协程的入口函数
-        if (use_caller) {
-            makecontext(&m_ctx, &CallerMainFunc, 0);
-        } else {
-            makecontext(&m_ctx, &MainFunc, 0);
-        }
+        // 在协程栈上初始化上下文并设置协程的入口函数
+        m_ctx.make(m_stack, m_stack_size, use_caller ? &CallerMainFunc : &MainFunc);
     } catch (...) {
         // 如果发生异常，释放已分配的栈空间
         if (stack) {
@@ -91,9 +130,18 @@ Coroutine::Coroutine(std::function<void()> cb, size_t stack_size, bool use_calle
 
 Coroutine::~Coroutine() {
     IM_LOG_DEBUG(g_logger) << "Coroutine::~Coroutine" << " id=" << m_id;
-    if (m_stack)  // 说明为子协程
+    if (m_shared)  // 说明为共享栈子协程
     {
         IM_ASSERT(m_state == State::TERM || m_state == State::INIT || m_state == State::EXCEPT);
+        s_shared_saved -= m_saveCap;
+        free(m_saveBuf);
+        --s_shared_coroutines;
+    } else if (m_stack)  // 说明为子协程
+    {
+        IM_ASSERT(m_state == State::TERM || m_state == State::INIT || m_state == State::EXCEPT);
+        if (m_stackProfiled && m_state != State::INIT) {
+            recordStackDepth();
+        }
         StackAllocator::Dealloc(m_stack, m_stack_size);
     } else  // 说明为主协程
     {
@@ -109,20 +157,25 @@ Coroutine::~Coroutine() {
     --s_coroutine_count;
 }
 
-void Coroutine::reset(std::function<void()> cb) {
+void Coroutine::reset(TaskFunc cb) {
+    if (m_shared) {
+        // 已结束的共享栈协程不再占用共享栈，解除绑定后可在任意线程重新运行
+        IM_ASSERT(m_state == State::TERM || m_state == State::INIT || m_state == State::EXCEPT);
+        m_cb = std::move(cb);
+        m_sharedStack = nullptr;
+        m_boundThread = -1;
+        m_saveSize = 0;
+        m_state = State::INIT;
+        return;
+    }
     IM_ASSERT(m_stack);
     IM_ASSERT(m_stack_size > 0);
     IM_ASSERT(m_state == State::TERM || m_state == State::INIT || m_state == State::EXCEPT);
-    m_cb = cb;
-    if (getcontext(&m_ctx))  // 获取当前上下文环境
-    {
-        IM_ASSERT2(false, "getcontext");
+    if (m_stackProfiled && m_state != State::INIT) {
+        recordStackDepth();
     }
-    m_ctx.uc_link = nullptr;
-    m_ctx.uc_stack.ss_sp = m_stack;
-    m_ctx.uc_stack.ss_size = m_stack_size;
-
-    makecontext(&m_ctx, &MainFunc, 0);
+    m_cb = std::move(cb);
+    m_ctx.make(m_stack, m_stack_size, &MainFunc);
     m_state = State::INIT;
 }
 
@@ -130,42 +183,98 @@ void Coroutine::swapIn() {
     // 把当前运行协程设置为该子协程
     SetThis(this);
     IM_ASSERT(m_state != State::EXEC && m_state != State::TERM && m_state != State::EXCEPT);
+#if IM_SHARED_STACK_SUPPORTED
+    if (m_shared) {
+        SharedStack *ss = GetSharedStack();
+        if (!m_sharedStack) {
+            // 首次运行：绑定到当前线程的共享栈
+            m_sharedStack = ss;
+            m_boundThread = IM::GetThreadId();
+            m_ctx.make(ss->stack, ss->size, &MainFunc);
+        }
+        IM_ASSERT2(m_sharedStack == ss, "shared-stack coroutine resumed on foreign thread id=" + std::to_string(m_id));
+        // 栈上驻留的是其他协程时才需要拷贝：先换出占用者，再换入自己的快照
+        if (ss->occupant != this) {
+            if (ss->occupant) {
+                ss->occupant->saveStack();
+            }
+            restoreStack();
+            ss->occupant = this;
+        }
+    }
+#endif
     m_state = State::EXEC;
 
     // 从主协程切换到当前线程（子协程）
-    if (swapcontext(&Scheduler::GetMainCoroutine()->m_ctx, &m_ctx)) {
-        IM_ASSERT2(false, "swapcontext");
+    Scheduler::GetMainCoroutine()->m_ctx.swapTo(m_ctx);
+    // 上下文已完整保存，此时才对其他线程发布挂起状态，见 YieldToHold
+    if (m_state == State::EXEC) {
+        m_state = State::HOLD;
     }
 }
 
 void Coroutine::swapOut() {
     // 从当前线程（子协程）切换回主协程
     SetThis(Scheduler::GetMainCoroutine());
-    if (swapcontext(&m_ctx, &Scheduler::GetMainCoroutine()->m_ctx)) {
-        IM_ASSERT2(false, "swapcontext");
-    }
+    m_ctx.swapTo(Scheduler::GetMainCoroutine()->m_ctx);
 }
 
 void Coroutine::call() {
+    IM_ASSERT(!m_shared);
     SetThis(this);
     IM_ASSERT(m_state != State::EXEC && m_state != State::TERM && m_state != State::EXCEPT);
     m_state = State::EXEC;
-    if (swapcontext(&t_thread_coroutine->m_ctx, &m_ctx)) {
-        IM_ASSERT2(false, "swapcontext");
+    t_thread_coroutine->m_ctx.swapTo(m_ctx);
+    if (m_state == State::EXEC) {
+        m_state = State::HOLD;
     }
 }
 
 void Coroutine::back() {
     SetThis(t_thread_coroutine.get());
-    if (swapcontext(&m_ctx, &t_thread_coroutine->m_ctx)) {
-        IM_ASSERT2(false, "swapcontext");
-    }
+    m_ctx.swapTo(t_thread_coroutine->m_ctx);
 }
 
 uint64_t Coroutine::getId() const {
     return m_id;
 }
 
+void Coroutine::saveStack() {
+#if IM_SHARED_STACK_SUPPORTED
+    // 协程挂起时保存的栈指针以上(含被保存的寄存器)即为全部活跃栈帧
+    char *top = m_sharedStack->top();
+    char *sp = (char *)m_ctx.getSp();
+    size_t size = top - sp;
+    // 缓冲区按实际使用量分配，明显偏大时收缩，保证空闲协程只占用真实栈深度
+    if (m_saveCap < size || m_saveCap > size * 2 + 4096) {
+        char *buf = (char *)realloc(m_saveBuf, size);
+        if (!buf) {
+            throw std::bad_alloc();
+        }
+        s_shared_saved += size;
+        s_shared_saved -= m_saveCap;
+        m_saveBuf = buf;
+        m_saveCap = size;
+    }
+    memcpy(m_saveBuf, sp, size);
+    m_saveSize = size;
+    ++s_shared_copies;
+#endif
+}
+
+void Coroutine::restoreStack() {
+    if (m_saveSize) {
+        memcpy(m_sharedStack->top() - m_saveSize, m_saveBuf, m_saveSize);
+        m_saveSize = 0;
+        ++s_shared_copies;
+    }
+}
+
+void Coroutine::recordStackDepth() {
+    StackProfiler::Record(m_stackEntry, StackProfiler::Measure(m_stack, m_stack_size), m_stack_size);
+    m_stackEntry = nullptr;
+}
+
 Coroutine::State Coroutine::getState() const {
     return m_state;
 }
@@ -202,7 +311,8 @@ void Coroutine::YieldToReady() {
 void Coroutine::YieldToHold() {
     Coroutine::ptr cur = GetThis();
     IM_ASSERT(cur->m_state == EXEC);
-    cur->m_state = State::HOLD;
+    // 不在这里置为 HOLD：挂起前协程可能已登记到 IO 事件或定时器上，其他线程一旦看到 HOLD
+    // 就会换入，而此时上下文还没有切走。保持 EXEC 直到切换完成，由 swapIn/call 返回后置为 HOLD
     cur->swapOut();
 }
 
@@ -231,6 +341,10 @@ void Coroutine::MainFunc() {
     // 协程执行完毕后，需要将控制权交还给主协程
     auto p = cur.get();
     cur.reset();
+    if (p->m_sharedStack) {
+        // 已结束的协程不需要保留栈内容，让出共享栈
+        p->m_sharedStack->occupant = nullptr;
+    }
     p->swapOut();
 
     IM_ASSERT2(false, "never reach coroutine id=" + std::to_string(p->getId()));
@@ -266,6 +380,10 @@ uint64_t Coroutine::GetCoroutineId() {
     return t_coroutine ? t_coroutine->m_id : 0;
 }
 
+std::string Coroutine::GetCurrentTraceId() {
+    return t_coroutine ? t_coroutine->m_traceId : std::string();
+}
+
 void *MallocStackAllocator::Alloc(size_t size) {
     return malloc(size);
 }
@@ -273,4 +391,174 @@ void *MallocStackAllocator::Alloc(size_t size) {
 void MallocStackAllocator::Dealloc(void *ptr, size_t size) {
     free(ptr);
 }
+
+static std::atomic<uint64_t> s_stack_pool_hits = {0};        // 空闲链表命中次数
+static std::atomic<uint64_t> s_stack_pool_misses = {0};      // 空闲链表未命中次数
+static std::atomic<uint64_t> s_stack_in_use = {0};           // 使用中的栈数量
+static std::atomic<uint64_t> s_stack_cached = {0};           // 缓存中的栈数量
+static std::atomic<uint64_t> s_stack_cached_resident = {0};  // 缓存中仍占用物理内存的栈数量
+
+static size_t GetPageSize() {
+    static size_t s_page_size = sysconf(_SC_PAGESIZE);
+    return s_page_size;
+}
+
+/**
+ * @brief 线程本地的空闲栈链表
+ * @details 协程可能在A线程创建、在B线程销毁，栈放回销毁线程的链表，无需跨线程同步
+ */
+struct StackCache {
+    struct Entry {
+        void *stack;       // 栈空间指针(不含保护页)
+        size_t size;       // 栈大小
+        uint64_t freedAt;  // 放入空闲链表的时间(毫秒)
+        bool resident;     // 是否仍占用物理内存
+    };
+
+    ~StackCache() {
+        for (auto &i : entries) {
+            if (i.resident) {
+                --s_stack_cached_resident;
+            }
+            --s_stack_cached;
+            Unmap(i.stack, i.size);
+        }
+    }
+
+    static void *Map(size_t size) {
+        size_t guard = GetPageSize();
+        void *base = mmap(nullptr, size + guard, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                          -1, 0);
+        if (base == MAP_FAILED) {
+            IM_LOG_ERROR(g_logger) << "mmap coroutine stack failed size=" << size << " errno=" << errno << " "
+                                   << strerror(errno);
+            throw std::bad_alloc();
+        }
+        // 栈向低地址增长，保护页放在最低端
+        if (mprotect(base, guard, PROT_NONE)) {
+            IM_LOG_ERROR(g_logger) << "mprotect coroutine stack guard failed errno=" << errno << " " << strerror(errno);
+        }
+        return (char *)base + guard;
+    }
+
+    static void Unmap(void *stack, size_t size) {
+        size_t guard = GetPageSize();
+        munmap((char *)stack - guard, size + guard);
+    }
+
+    // 把闲置过久的栈归还物理内存，每个线程最多每秒检查一次
+    void trim(uint64_t now) {
+        uint32_t idle_ms = g_stack_pool_idle_release_ms->getValue();
+        if (now < lastTrim + 1000) {
+            return;
+        }
+        lastTrim = now;
+        for (auto &i : entries) {
+            if (i.resident && now >= i.freedAt + idle_ms) {
+                madvise(i.stack, i.size, MADV_DONTNEED);
+                i.resident = false;
+                --s_stack_cached_resident;
+            }
+        }
+    }
+
+    std::vector<Entry> entries;  // 空闲栈，尾部为最近释放(最可能仍在缓存中)
+    uint64_t lastTrim = 0;       // 上次检查闲置栈的时间
+};
+
+// 空闲链表使用平凡类型的线程局部指针保存，线程退出时由 StackCacheReaper 释放，
+// 之后(例如静态对象析构时)再释放的栈直接解除映射
+static thread_local StackCache *t_stack_cache = nullptr;
+static thread_local bool t_stack_cache_closed = false;
+
+struct StackCacheReaper {
+    ~StackCacheReaper() {
+        delete t_stack_cache;
+        t_stack_cache = nullptr;
+        t_stack_cache_closed = true;
+    }
+};
+static thread_local StackCacheReaper t_stack_cache_reaper;
+
+static StackCache *GetStackCache() {
+    if (t_stack_cache_closed) {
+        return nullptr;
+    }
+    if (!t_stack_cache) {
+        (void)&t_stack_cache_reaper;  // 确保线程退出时释放缓存
+        t_stack_cache = new StackCache;
+    }
+    return t_stack_cache;
+}
+
+void *PooledStackAllocator::Alloc(size_t size) {
+    size_t page = GetPageSize();
+    size = (size + page - 1) / page * page;
+
+    StackCache *cache = GetStackCache();
+    if (!cache) {
+        ++s_stack_pool_misses;
+        ++s_stack_in_use;
+        return StackCache::Map(size);
+    }
+
+    auto &entries = cache->entries;
+    for (auto it = entries.rbegin(); it != entries.rend(); ++it) {
+        if (it->size != size) {
+            continue;
+        }
+        void *stack = it->stack;
+        if (it->resident) {
+            --s_stack_cached_resident;
+        }
+        entries.erase(std::next(it).base());
+        --s_stack_cached;
+        ++s_stack_pool_hits;
+        ++s_stack_in_use;
+        return stack;
+    }
+
+    void *stack = StackCache::Map(size);
+    ++s_stack_pool_misses;
+    ++s_stack_in_use;
+    return stack;
+}
+
+void PooledStackAllocator::Dealloc(void *ptr, size_t size) {
+    size_t page = GetPageSize();
+    size = (size + page - 1) / page * page;
+    --s_stack_in_use;
+
+    StackCache *cache = GetStackCache();
+    if (!cache || cache->entries.size() >= g_stack_pool_max_cached->getValue()) {
+        StackCache::Unmap(ptr, size);
+        return;
+    }
+
+    uint64_t now = TimeUtil::NowToMS();
+    cache->entries.push_back({ptr, size, now, true});
+    ++s_stack_cached;
+    ++s_stack_cached_resident;
+    cache->trim(now);
+}
+
+void PooledStackAllocator::Trim() {
+    // 只检查已有缓存的线程，不为从未使用栈池的线程创建缓存
+    if (t_stack_cache) {
+        t_stack_cache->trim(TimeUtil::NowToMS());
+    }
+}
+
+StackPoolStats PooledStackAllocator::GetStats() {
+    StackPoolStats stats;
+    stats.hits = s_stack_pool_hits;
+    stats.misses = s_stack_pool_misses;
+    stats.inUse = s_stack_in_use;
+    stats.cached = s_stack_cached;
+    stats.cachedResident = s_stack_cached_resident;
+    stats.sharedCoroutines = s_shared_coroutines;
+    stats.sharedSavedBytes = s_shared_saved;
+    stats.sharedCopies = s_shared_copies;
+    return stats;
+}
 }  // namespace IM
\ No newline at end of file
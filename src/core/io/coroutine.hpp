@@ -5,24 +5,37 @@
  * @brief 协程实现模块
  *
  * 该文件提供了协程的实现，包括协程的创建、切换、状态管理等功能。
- * 基于ucontext实现协程上下文切换，支持协程的挂起、恢复等操作。
+ * 基于 CoroutineContext 实现协程上下文切换(x86-64/aarch64 为手写汇编，其他平台为ucontext)，
+ * 支持协程的挂起、恢复等操作。
+ *
+ * 共享栈模式(copy-on-switch)：
+ * - 协程不单独分配栈，而是在其首次运行的线程的共享栈上执行，并从此绑定到该线程
+ * - 切换到另一个共享栈协程时，才把原占用者实际使用的栈区间拷贝到按需大小的堆缓冲区，恢复时再拷回原地址
+ * - 大量长期空闲的连接协程只保留几KB的栈快照，而不是各自常驻一整块栈
+ * - 约束：协程挂起期间，其栈上对象的地址不能被其他协程或线程访问；协程不能切换到其他调度器
  */
 
 #ifndef __IM_IO_COROUTINE_HPP__
 #define __IM_IO_COROUTINE_HPP__
 
+#include <atomic>
 #include <functional>
 #include <memory>
-#include <ucontext.h>
+#include <sys/types.h>
 
 #include "core/base/noncopyable.hpp"
+#include "core/io/coroutine_context.hpp"
+#include "core/io/task_func.hpp"
 
 namespace IM {
+struct SharedStack;
+struct StackProfileEntry;
+
 /**
  * @brief 协程类
  *
  * 实现了协程的基本功能，包括创建、执行、挂起、恢复等操作。
- * 使用ucontext_t保存和恢复协程上下文，通过状态机管理协程生命周期。
+ * 使用CoroutineContext保存和恢复协程上下文，通过状态机管理协程生命周期。
  */
 class Coroutine : public std::enable_shared_from_this<Coroutine>, Noncopyable {
    public:
@@ -41,6 +54,16 @@ class Coroutine : public std::enable_shared_from_this<Coroutine>, Noncopyable {
         EXCEPT  /// 异常状态 - 表示协程执行过程中发生异常，已终止
     };
 
+    /**
+     * @brief 调度优先级，数值越小越先被调度
+     */
+    enum Priority {
+        HIGH = 0,       /// 高优先级 - 心跳、在线状态、PING/PONG等控制类流量
+        NORMAL = 1,     /// 普通优先级 - 默认
+        LOW = 2,        /// 低优先级 - 历史消息加载、群广播扇出等批量任务
+        PRIORITY_COUNT  /// 优先级数量
+    };
+
    private:
     /**
      * @brief 默认构造函数，用于创建主协程
@@ -53,8 +76,9 @@ class Coroutine : public std::enable_shared_from_this<Coroutine>, Noncopyable {
      * @param[in] cb 协程执行的回调函数
      * @param[in] stack_size 协程栈大小，默认为0表示使用默认大小
      * @param[in] use_caller 是否使用调用者上下文，默认为false
+     * @param[in] shared_stack 是否运行在线程共享栈上(copy-on-switch)，此时忽略stack_size
      */
-    Coroutine(std::function<void()> cb, size_t stack_size = 0, bool use_caller = false);
+    Coroutine(TaskFunc cb, size_t stack_size = 0, bool use_caller = false, bool shared_stack = false);
 
     /**
      * @brief 析构函数
@@ -65,7 +89,7 @@ class Coroutine : public std::enable_shared_from_this<Coroutine>, Noncopyable {
      * @brief 重置协程函数，并重置状态
      * @param[in] cb 新的协程执行回调函数
      */
-    void reset(std::function<void()> cb);
+    void reset(TaskFunc cb);
 
     /**
      * @brief 切换到当前协程执行
@@ -105,6 +129,27 @@ class Coroutine : public std::enable_shared_from_this<Coroutine>, Noncopyable {
      */
     void setState(State state);
 
+    /**
+     * @brief 是否为共享栈协程
+     */
+    bool isSharedStack() const { return m_shared; }
+
+    /**
+     * @brief 获取共享栈协程绑定的线程id
+     * @return 尚未运行或非共享栈协程返回-1，调度器据此把协程投递回所属线程
+     */
+    pid_t getBoundThread() const { return m_boundThread; }
+
+    /**
+     * @brief 是否参与栈深度统计(见 StackProfiler)
+     */
+    bool isStackProfiled() const { return m_stackProfiled; }
+
+    /**
+     * @brief 设置本次运行所属的栈深度统计入口，协程回收时按该入口记录
+     */
+    void setStackEntry(StackProfileEntry *entry) { m_stackEntry = entry; }
+
    public:
     /**
      * @brief 设置当前协程
@@ -150,6 +195,13 @@ class Coroutine : public std::enable_shared_from_this<Coroutine>, Noncopyable {
      */
     static uint64_t GetCoroutineId();
 
+    /**
+     * @brief 获取当前协程的Trace ID
+     * @return 线程上还没有协程时返回空串
+     * @note 不创建主协程也不调用 shared_from_this，主协程构造与析构期间打日志也可以安全调用
+     */
+    static std::string GetCurrentTraceId();
+
     /**
      * @brief 获取Trace ID
      */
@@ -160,14 +212,62 @@ class Coroutine : public std::enable_shared_from_this<Coroutine>, Noncopyable {
      */
     void setTraceId(const std::string &v) { m_traceId = v; }
 
+    /**
+     * @brief 获取截止时间(毫秒时间戳)，0表示未设置
+     */
+    uint64_t getDeadline() const { return m_deadline; }
+
+    /**
+     * @brief 设置截止时间
+     */
+    void setDeadline(uint64_t v) { m_deadline = v; }
+
+    /**
+     * @brief 获取调度优先级，协程被唤醒重新调度时按该优先级入队
+     */
+    Priority getPriority() const { return m_priority.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 设置调度优先级
+     */
+    void setPriority(Priority v) { m_priority.store(v, std::memory_order_relaxed); }
+
+   private:
+    /**
+     * @brief 把共享栈上正在使用的栈区间保存到私有缓冲区
+     */
+    void saveStack();
+
+    /**
+     * @brief 把私有缓冲区中的栈快照拷回共享栈
+     */
+    void restoreStack();
+
+    /**
+     * @brief 测量并记录本次运行的栈深度
+     */
+    void recordStackDepth();
+
    private:
-    uint64_t m_id = 0;            /// 协程id
-    uint32_t m_stack_size = 0;    /// 协程栈大小
-    State m_state = State::INIT;  /// 协程当前状态
-    ucontext_t m_ctx;             /// 协程上下文，用于保存和切换上下文环境
-    void *m_stack = nullptr;      /// 协程栈空间
-    std::function<void()> m_cb;   /// 协程要执行的回调函数
-    std::string m_traceId;        /// Trace ID
+    uint64_t m_id = 0;                            /// 协程id
+    uint32_t m_stack_size = 0;                    /// 协程栈大小
+    std::atomic<State> m_state = {State::INIT};   /// 协程当前状态，调度线程间共享
+    CoroutineContext m_ctx;                       /// 协程上下文，用于保存和切换上下文环境
+    void *m_stack = nullptr;                      /// 协程栈空间
+    TaskFunc m_cb;                                /// 协程要执行的回调函数
+    std::string m_traceId;                        /// Trace ID
+    uint64_t m_deadline = 0;                      /// 截止时间(毫秒时间戳)，0表示未设置
+    std::atomic<Priority> m_priority = {NORMAL};  /// 调度优先级，唤醒方线程读取
+
+    bool m_shared = false;                 /// 是否为共享栈协程
+    pid_t m_boundThread = -1;              /// 共享栈协程绑定的线程id
+    SharedStack *m_sharedStack = nullptr;  /// 共享栈协程所使用的线程共享栈
+    char *m_saveBuf = nullptr;             /// 被换出时的栈快照
+    size_t m_saveSize = 0;                 /// 栈快照大小
+    size_t m_saveCap = 0;                  /// 栈快照缓冲区容量
+
+    bool m_stackProfiled = false;               /// 是否参与栈深度统计
+    StackProfileEntry *m_stackEntry = nullptr;  /// 本次运行所属的栈深度统计入口
 };
 
 /**
@@ -191,6 +291,56 @@ class MallocStackAllocator : public Noncopyable {
      */
     static void Dealloc(void *ptr, size_t size);
 };
+
+/**
+ * @brief 协程栈池统计信息
+ */
+struct StackPoolStats {
+    uint64_t hits = 0;              ///< 从线程本地空闲链表复用栈的次数
+    uint64_t misses = 0;            ///< 空闲链表未命中、新建映射的次数
+    uint64_t inUse = 0;             ///< 正在被协程使用的栈数量
+    uint64_t cached = 0;            ///< 缓存在空闲链表中的栈数量
+    uint64_t cachedResident = 0;    ///< 空闲链表中尚未 madvise 释放物理内存的栈数量
+    uint64_t sharedCoroutines = 0;  ///< 存活的共享栈协程数量
+    uint64_t sharedSavedBytes = 0;  ///< 共享栈协程栈快照占用的字节数
+    uint64_t sharedCopies = 0;      ///< 共享栈换入换出拷贝次数
+};
+
+/**
+ * @brief 基于 mmap 的池化协程栈分配器
+ *
+ * - 每个栈通过 mmap 映射，并在低地址端放置 PROT_NONE 保护页，栈溢出时立即触发 SIGSEGV
+ * - 释放的栈放入当前线程的空闲链表，下次分配同尺寸栈时直接复用，避免 mmap/munmap
+ * - 在空闲链表中闲置超过 coroutine.stack_pool.idle_release_ms 的栈通过 madvise(MADV_DONTNEED)
+ *   归还物理内存，虚拟地址仍保留以便复用；检查在 Dealloc 与调度器空闲循环中进行
+ */
+class PooledStackAllocator : public Noncopyable {
+   public:
+    /**
+     * @brief 分配栈空间
+     * @param[in] size 栈大小
+     * @return 栈空间指针(不含保护页)
+     */
+    static void *Alloc(size_t size);
+
+    /**
+     * @brief 释放栈空间(放回当前线程的空闲链表或解除映射)
+     * @param[in] ptr 栈空间指针
+     * @param[in] size 栈大小
+     */
+    static void Dealloc(void *ptr, size_t size);
+
+    /**
+     * @brief 把当前线程空闲链表中闲置过久的栈归还物理内存
+     * @details Dealloc 时会顺带检查；协程不再创建销毁时由调度器空闲时调用，每个线程最多每秒检查一次
+     */
+    static void Trim();
+
+    /**
+     * @brief 获取栈池统计信息
+     */
+    static StackPoolStats GetStats();
+};
 }  // namespace IM
 
 #endif  // __IM_IO_COROUTINE_HPP__
\ No newline at end of file
@@ -0,0 +1,107 @@
+#include "core/io/coroutine_context.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+#include "core/base/macro.hpp"
+
+#if defined(__x86_64__)
+// System V AMD64：被调用者保存 rbx rbp r12-r15，以及 MXCSR 控制位与 x87 控制字
+// 栈布局(低 -> 高)：[mxcsr|fpcw] r15 r14 r13 r12 rbx rbp ret
+__asm__(
+    ".text\n"
+    ".globl im_context_swap\n"
+    ".type im_context_swap,@function\n"
+    ".align 16\n"
+    "im_context_swap:\n"
+    "    pushq %rbp\n"
+    "    pushq %rbx\n"
+    "    pushq %r12\n"
+    "    pushq %r13\n"
+    "    pushq %r14\n"
+    "    pushq %r15\n"
+    "    subq $8, %rsp\n"
+    "    stmxcsr (%rsp)\n"
+    "    fnstcw 4(%rsp)\n"
+    "    movq %rsp, (%rdi)\n"
+    "    movq %rsi, %rsp\n"
+    "    ldmxcsr (%rsp)\n"
+    "    fldcw 4(%rsp)\n"
+    "    addq $8, %rsp\n"
+    "    popq %r15\n"
+    "    popq %r14\n"
+    "    popq %r13\n"
+    "    popq %r12\n"
+    "    popq %rbx\n"
+    "    popq %rbp\n"
+    "    ret\n"
+    ".size im_context_swap,.-im_context_swap\n");
+#elif defined(__aarch64__)
+// AAPCS64：被调用者保存 x19-x28、fp(x29)、lr(x30) 以及 d8-d15
+// 栈布局(低 -> 高)：x19..x30 d8..d15，共 160 字节
+__asm__(
+    ".text\n"
+    ".globl im_context_swap\n"
+    ".type im_context_swap,%function\n"
+    ".align 4\n"
+    "im_context_swap:\n"
+    "    sub sp, sp, #160\n"
+    "    stp x19, x20, [sp, #0]\n"
+    "    stp x21, x22, [sp, #16]\n"
+    "    stp x23, x24, [sp, #32]\n"
+    "    stp x25, x26, [sp, #48]\n"
+    "    stp x27, x28, [sp, #64]\n"
+    "    stp x29, x30, [sp, #80]\n"
+    "    stp d8, d9, [sp, #96]\n"
+    "    stp d10, d11, [sp, #112]\n"
+    "    stp d12, d13, [sp, #128]\n"
+    "    stp d14, d15, [sp, #144]\n"
+    "    mov x9, sp\n"
+    "    str x9, [x0]\n"
+    "    mov sp, x1\n"
+    "    ldp x19, x20, [sp, #0]\n"
+    "    ldp x21, x22, [sp, #16]\n"
+    "    ldp x23, x24, [sp, #32]\n"
+    "    ldp x25, x26, [sp, #48]\n"
+    "    ldp x27, x28, [sp, #64]\n"
+    "    ldp x29, x30, [sp, #80]\n"
+    "    ldp d8, d9, [sp, #96]\n"
+    "    ldp d10, d11, [sp, #112]\n"
+    "    ldp d12, d13, [sp, #128]\n"
+    "    ldp d14, d15, [sp, #144]\n"
+    "    add sp, sp, #160\n"
+    "    ret\n"
+    ".size im_context_swap,.-im_context_swap\n");
+#endif
+
+namespace IM {
+void CoroutineContext::make(void *stack, size_t size, void (*entry)()) {
+#if defined(__x86_64__)
+    // 栈顶按16字节对齐；ret 进入 entry 时 rsp ≡ 8 (mod 16)，与 call 指令进入函数时一致
+    uintptr_t top = ((uintptr_t)stack + size) & ~(uintptr_t)15;
+    uint64_t *sp = (uint64_t *)(top - 72);
+    memset(sp, 0, 72);
+    uint32_t mxcsr = 0x1F80;  // 默认 MXCSR：屏蔽全部浮点异常，就近舍入
+    uint16_t fpcw = 0x037F;   // 默认 x87 控制字
+    memcpy((char *)sp, &mxcsr, sizeof(mxcsr));
+    memcpy((char *)sp + 4, &fpcw, sizeof(fpcw));
+    sp[7] = (uint64_t)entry;  // ret 的返回地址
+    sp[8] = 0;                // entry 的伪返回地址，栈回溯到此终止
+    m_sp = sp;
+#elif defined(__aarch64__)
+    uintptr_t top = ((uintptr_t)stack + size) & ~(uintptr_t)15;
+    uint64_t *sp = (uint64_t *)(top - 160);
+    memset(sp, 0, 160);
+    sp[11] = (uint64_t)entry;  // x30(lr)：ret 跳转到 entry；x29(fp)为0，栈回溯到此终止
+    m_sp = sp;
+#else
+    if (getcontext(&m_uc)) {
+        IM_ASSERT2(false, "getcontext");
+    }
+    m_uc.uc_link = nullptr;
+    m_uc.uc_stack.ss_sp = stack;
+    m_uc.uc_stack.ss_size = size;
+    makecontext(&m_uc, entry, 0);
+#endif
+}
+}  // namespace IM
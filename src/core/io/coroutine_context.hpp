@@ -0,0 +1,84 @@
+/**
+ * @file coroutine_context.hpp
+ * @brief 协程上下文切换
+ * @author DreamTraveler233
+ * @date 2026-01-10
+ *
+ * x86-64 与 aarch64 上使用手写汇编切换上下文：只保存 ABI 规定的被调用者保存寄存器
+ * (以及浮点控制字)，整个切换不进入内核。swapcontext 每次切换都要执行 rt_sigprocmask
+ * 系统调用保存/恢复信号掩码，协程从不依赖按协程区分的信号掩码，这部分开销完全可以省去。
+ * 其他平台退化为 ucontext 实现。
+ */
+
+#ifndef __IM_IO_COROUTINE_CONTEXT_HPP__
+#define __IM_IO_COROUTINE_CONTEXT_HPP__
+
+#include <cstddef>
+
+#if defined(__x86_64__) || defined(__aarch64__)
+#define IM_CONTEXT_ASM 1
+#else
+#define IM_CONTEXT_ASM 0
+#include <ucontext.h>
+#endif
+
+#if IM_CONTEXT_ASM
+extern "C" {
+/**
+ * @brief 保存当前被调用者保存寄存器到当前栈，把栈指针写入 *from_sp，再切换到 to_sp 并恢复
+ * @param[out] from_sp 保存当前上下文栈指针的位置
+ * @param[in] to_sp 目标上下文栈指针
+ */
+void im_context_swap(void **from_sp, void *to_sp);
+}
+#endif
+
+namespace IM {
+/**
+ * @brief 协程执行上下文
+ *
+ * 未经 make 初始化的上下文只能作为 swapTo 的保存目标(例如线程主协程)。
+ */
+class CoroutineContext {
+   public:
+    /**
+     * @brief 在指定栈上初始化上下文，切换进入后从 entry 开始执行
+     * @param[in] stack 栈空间(低地址)
+     * @param[in] size 栈大小
+     * @param[in] entry 入口函数，不允许返回
+     */
+    void make(void *stack, size_t size, void (*entry)());
+
+    /**
+     * @brief 保存当前执行上下文到本对象，并切换到 to
+     * @param[in] to 目标上下文
+     */
+    void swapTo(CoroutineContext &to) {
+#if IM_CONTEXT_ASM
+        im_context_swap(&m_sp, to.m_sp);
+#else
+        swapcontext(&m_uc, &to.m_uc);
+#endif
+    }
+
+    /**
+     * @brief 挂起时保存的栈指针，其上即为全部活跃栈帧(仅汇编实现可用)
+     */
+    void *getSp() const {
+#if IM_CONTEXT_ASM
+        return m_sp;
+#else
+        return nullptr;
+#endif
+    }
+
+   private:
+#if IM_CONTEXT_ASM
+    void *m_sp = nullptr;  /// 挂起时的栈指针，寄存器保存在该地址起的栈上
+#else
+    ucontext_t m_uc;  /// ucontext 上下文
+#endif
+};
+}  // namespace IM
+
+#endif  // __IM_IO_COROUTINE_CONTEXT_HPP__
@@ -0,0 +1,147 @@
+#include "core/io/cpu_affinity.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sstream>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "core/base/macro.hpp"
+
+namespace IM {
+static auto g_logger = IM_LOG_NAME("system");
+
+// NUMA 节点信息所在目录
+static const char *kNodeDir = "/sys/devices/system/node/";
+
+/**
+ * @brief 读取 /sys 下的 cpulist 格式文件
+ */
+static std::vector<int> ReadCpuListFile(const std::string &path) {
+    std::ifstream ifs(path);
+    std::string line;
+    if (!ifs || !std::getline(ifs, line)) {
+        return {};
+    }
+    return ThreadAffinity::ParseCpuList(line);
+}
+
+ThreadAffinity ThreadAffinity::forThread(size_t index) const {
+    ThreadAffinity rt = *this;
+    if (pin && !cpus.empty()) {
+        rt.cpus = {cpus[index % cpus.size()]};
+    }
+    return rt;
+}
+
+bool ThreadAffinity::apply() const {
+    bool ok = true;
+    if (!cpus.empty()) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : cpus) {
+            if (cpu >= 0 && cpu < CPU_SETSIZE) {
+                CPU_SET(cpu, &set);
+            }
+        }
+        int rt = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (rt) {
+            IM_LOG_WARN(g_logger) << "pthread_setaffinity_np fail, rt=" << rt << " " << toString();
+            ok = false;
+        }
+    }
+    if (numaNode >= 0) {
+        // 优先从指定节点分配，节点内存不足时回退到其他节点
+        const size_t bits = sizeof(unsigned long) * 8;
+        std::vector<unsigned long> mask(numaNode / bits + 1, 0);
+        mask[numaNode / bits] |= 1ul << (numaNode % bits);
+        if (syscall(SYS_set_mempolicy, MPOL_PREFERRED, mask.data(), mask.size() * bits + 1) != 0) {
+            IM_LOG_WARN(g_logger) << "set_mempolicy fail, errno=" << errno << " " << toString();
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+std::string ThreadAffinity::toString() const {
+    std::stringstream ss;
+    ss << "cpus=";
+    for (size_t i = 0; i < cpus.size(); ++i) {
+        if (i) {
+            ss << ",";
+        }
+        ss << cpus[i];
+    }
+    ss << " numa_node=" << numaNode << " pin=" << pin;
+    return ss.str();
+}
+
+ThreadAffinity ThreadAffinity::Create(const std::string &cpus, int numa_node, bool pin) {
+    ThreadAffinity rt;
+    rt.numaNode = numa_node;
+    rt.pin = pin;
+    if (!cpus.empty()) {
+        rt.cpus = ParseCpuList(cpus);
+    } else if (numa_node >= 0) {
+        rt.cpus = GetNumaNodeCpus(numa_node);
+        if (rt.cpus.empty()) {
+            IM_LOG_WARN(g_logger) << "numa node " << numa_node << " has no cpu, cpu affinity not set";
+        }
+    }
+    return rt;
+}
+
+std::vector<int> ThreadAffinity::ParseCpuList(const std::string &str) {
+    std::vector<int> rt;
+    std::stringstream ss(str);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        int first = 0;
+        int last = 0;
+        char dash = 0;
+        std::stringstream is(item);
+        if (!(is >> first)) {
+            continue;
+        }
+        last = first;
+        if (is >> dash) {
+            if (dash != '-' || !(is >> last)) {
+                continue;
+            }
+        }
+        for (int cpu = first; cpu <= last && cpu >= 0; ++cpu) {
+            rt.push_back(cpu);
+        }
+    }
+    std::sort(rt.begin(), rt.end());
+    rt.erase(std::unique(rt.begin(), rt.end()), rt.end());
+    return rt;
+}
+
+std::vector<int> ThreadAffinity::GetNumaNodeCpus(int node) {
+    if (node < 0) {
+        return {};
+    }
+    return ReadCpuListFile(std::string(kNodeDir) + "node" + std::to_string(node) + "/cpulist");
+}
+
+int ThreadAffinity::GetNumaNodeCount() {
+    std::vector<int> nodes = ReadCpuListFile(std::string(kNodeDir) + "online");
+    return nodes.empty() ? 1 : nodes.back() + 1;
+}
+
+int ThreadAffinity::GetCurrentCpu(int *node) {
+    unsigned cpu = 0;
+    unsigned numa = 0;
+    if (syscall(SYS_getcpu, &cpu, &numa, nullptr) != 0) {
+        return -1;
+    }
+    if (node) {
+        *node = numa;
+    }
+    return cpu;
+}
+}  // namespace IM
@@ -0,0 +1,88 @@
+/**
+ * @file cpu_affinity.hpp
+ * @brief 线程 CPU 亲和性与 NUMA 内存策略
+ * @author DreamTraveler233
+ * @date 2026-01-10
+ *
+ * workers.yaml 中每个线程池可以配置：
+ *
+ *     ws_worker:
+ *         thread_num: 4
+ *         numa_node: 0     # 线程只在节点0的CPU上运行，内存优先从节点0分配
+ *         cpus: "2-5"      # 显式指定CPU集合，优先于numa_node推导出的CPU集合
+ *         cpu_pin: true    # 第i个线程固定到cpus[i % n]，否则每个线程可在整个集合内迁移
+ *
+ * 亲和性在线程启动时由线程自己设置。内存策略使用 MPOL_PREFERRED(直接调用 set_mempolicy，
+ * 不依赖 libnuma)，线程此后分配的协程栈、任务缓存、连接对象等都优先落在本节点，
+ * 本节点内存不足时回退到其他节点而不是失败。
+ */
+
+#ifndef __IM_IO_CPU_AFFINITY_HPP__
+#define __IM_IO_CPU_AFFINITY_HPP__
+
+#include <string>
+#include <vector>
+
+namespace IM {
+/**
+ * @brief 线程的 CPU 亲和性与 NUMA 内存策略
+ */
+struct ThreadAffinity {
+    std::vector<int> cpus;  ///< 允许运行的CPU，为空表示不限制
+    int numaNode = -1;      ///< 内存优先分配的NUMA节点，-1表示不设置
+    bool pin = false;       ///< 是否把每个线程固定到单个CPU
+
+    /**
+     * @brief 是否没有任何设置
+     */
+    bool empty() const { return cpus.empty() && numaNode < 0; }
+
+    /**
+     * @brief 线程池中第 index 个线程的亲和性
+     * @details pin 为true时只保留 cpus[index % cpus.size()]，否则与整体设置相同
+     */
+    ThreadAffinity forThread(size_t index) const;
+
+    /**
+     * @brief 应用到当前线程
+     * @return 全部设置成功返回true，失败时记录警告日志，线程照常运行
+     */
+    bool apply() const;
+
+    std::string toString() const;
+
+    /**
+     * @brief 由配置构造
+     * @param[in] cpus CPU列表，格式如 "0-3,8,10-11"，为空时取 numa_node 的CPU
+     * @param[in] numa_node NUMA节点，-1表示不设置
+     * @param[in] pin 是否把每个线程固定到单个CPU
+     */
+    static ThreadAffinity Create(const std::string &cpus, int numa_node, bool pin);
+
+    /**
+     * @brief 解析CPU列表，格式同 /sys 下的 cpulist，如 "0-3,8,10-11"
+     * @return 去重排序后的CPU编号，格式错误的片段被忽略
+     */
+    static std::vector<int> ParseCpuList(const std::string &str);
+
+    /**
+     * @brief 获取NUMA节点上的CPU
+     * @return 节点不存在时返回空
+     */
+    static std::vector<int> GetNumaNodeCpus(int node);
+
+    /**
+     * @brief NUMA节点数量，非NUMA系统返回1
+     */
+    static int GetNumaNodeCount();
+
+    /**
+     * @brief 当前线程所在的CPU与NUMA节点
+     * @param[out] node 可选，NUMA节点
+     * @return int CPU编号，失败返回-1
+     */
+    static int GetCurrentCpu(int *node = nullptr);
+};
+}  // namespace IM
+
+#endif  // __IM_IO_CPU_AFFINITY_HPP__
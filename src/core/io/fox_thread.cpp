@@ -19,33 +19,39 @@ thread_local FoxThread *s_thread = nullptr;
 
 void FoxThread::read_cb(evutil_socket_t sock, short which, void *args) {
     FoxThread *thread = static_cast<FoxThread *>(args);
+    // 唤醒字节只是信号，全部读掉；一次唤醒批量执行队列中的所有回调
     uint8_t cmd[4096];
-    if (recv(sock, cmd, sizeof(cmd), 0) > 0) {
-        std::list<callback> callbacks;
-        RWMutex::WriteLock lock(thread->m_mutex);
-        callbacks.swap(thread->m_callbacks);
-        lock.unlock();
-        thread->m_working = true;
-        for (auto it = callbacks.begin(); it != callbacks.end(); ++it) {
-            if (*it) {
-                try {
-                    (*it)();
-                } catch (std::exception &ex) {
-                    IM_LOG_ERROR(g_logger) << "exception:" << ex.what();
-                } catch (const char *c) {
-                    IM_LOG_ERROR(g_logger) << "exception:" << c;
-                } catch (...) {
-                    IM_LOG_ERROR(g_logger) << "uncatch exception";
-                }
-            } else {
-                event_base_loopbreak(thread->m_base);
-                thread->m_start = false;
-                thread->unsetThis();
-                break;
-            }
+    while (recv(sock, cmd, sizeof(cmd), 0) > 0) {
+    }
+    thread->m_working = true;
+    uint64_t count = 0;
+    while (CallbackNode *node = thread->m_queue.pop()) {
+        if (!node->cb) {
+            delete node;
+            event_base_loopbreak(thread->m_base);
+            thread->m_start = false;
+            thread->unsetThis();
+            Atomic::addFetch(thread->m_total, count);
+            thread->m_working = false;
+            return;
+        }
+        ++count;
+        try {
+            node->cb();
+        } catch (std::exception &ex) {
+            IM_LOG_ERROR(g_logger) << "exception:" << ex.what();
+        } catch (const char *c) {
+            IM_LOG_ERROR(g_logger) << "exception:" << c;
+        } catch (...) {
+            IM_LOG_ERROR(g_logger) << "uncatch exception";
         }
-        Atomic::addFetch(thread->m_total, callbacks.size());
-        thread->m_working = false;
+        delete node;
+    }
+    Atomic::addFetch(thread->m_total, count);
+    thread->m_working = false;
+    // 有生产者已计入数量但尚未完成链接，它不会再发唤醒字节，由本线程重新触发一次
+    if (!thread->m_queue.empty()) {
+        event_active(thread->m_event, EV_READ, 0);
     }
 }
 
@@ -82,8 +88,7 @@ FoxThread::FoxThread(const std::string &name, struct event_base *base)
 }
 
 void FoxThread::dump(std::ostream &os) {
-    RWMutex::ReadLock lock(m_mutex);
-    os << "[thread name=" << m_name << " working=" << m_working << " tasks=" << m_callbacks.size()
+    os << "[thread name=" << m_name << " working=" << m_working << " tasks=" << m_queue.size()
        << " total=" << m_total << "]" << std::endl;
 }
 
@@ -123,6 +128,9 @@ FoxThread::~FoxThread() {
     if (m_base) {
         event_base_free(m_base);
     }
+    while (CallbackNode *node = m_queue.pop()) {
+        delete node;
+    }
 }
 
 void FoxThread::start() {
@@ -146,19 +154,23 @@ void FoxThread::thread_cb() {
     event_base_loop(m_base, 0);
 }
 
-bool FoxThread::dispatch(callback cb) {
-    RWMutex::WriteLock lock(m_mutex);
-    m_callbacks.push_back(cb);
-    // if(m_callbacks.size() > 1) {
-    //     std::cout << std::this_thread::get_id() << ":" << m_callbacks.size() << " " << m_name << std::endl;
-    // }
-    lock.unlock();
+bool FoxThread::push(callback cb) {
+    CallbackNode *node = new CallbackNode;
+    node->cb = std::move(cb);
+    return m_queue.push(node);
+}
+
+bool FoxThread::wakeup() {
     uint8_t cmd = 1;
-    // write(m_write, &cmd, sizeof(cmd));
-    if (send(m_write, &cmd, sizeof(cmd), 0) <= 0) {
-        return false;
+    return send(m_write, &cmd, sizeof(cmd), 0) > 0;
+}
+
+bool FoxThread::dispatch(callback cb) {
+    // 队列非空说明事件循环已被唤醒且尚未取完，不再重复写唤醒字节
+    if (!push(std::move(cb))) {
+        return true;
     }
-    return true;
+    return wakeup();
 }
 
 bool FoxThread::dispatch(uint32_t id, callback cb) {
@@ -166,16 +178,14 @@ bool FoxThread::dispatch(uint32_t id, callback cb) {
 }
 
 bool FoxThread::batchDispatch(const std::vector<callback> &cbs) {
-    RWMutex::WriteLock lock(m_mutex);
+    bool notify = false;
     for (auto &i : cbs) {
-        m_callbacks.push_back(i);
+        notify = push(i) || notify;
     }
-    lock.unlock();
-    uint8_t cmd = 1;
-    if (send(m_write, &cmd, sizeof(cmd), 0) <= 0) {
-        return false;
+    if (!notify) {
+        return true;
     }
-    return true;
+    return wakeup();
 }
 
 void FoxThread::broadcast(callback cb) {
@@ -183,17 +193,10 @@ void FoxThread::broadcast(callback cb) {
 }
 
 void FoxThread::stop() {
-    RWMutex::WriteLock lock(m_mutex);
-    m_callbacks.push_back(nullptr);
+    push(nullptr);
     if (m_thread) {
-        uint8_t cmd = 0;
-        // write(m_write, &cmd, sizeof(cmd));
-        send(m_write, &cmd, sizeof(cmd), 0);
+        wakeup();
     }
-    // if(m_data) {
-    //     delete m_data;
-    //     m_data = NULL;
-    // }
 }
 
 void FoxThread::join() {
@@ -254,12 +257,13 @@ void FoxThreadPool::releaseFoxThread(FoxThread *t) {
 }
 
 bool FoxThreadPool::dispatch(callback cb) {
+    Atomic::addFetch(m_total, (uint64_t)1);
+    if (!m_advance) {
+        // 轮询选线程只需原子自增，投递本身由各线程的无锁队列保证
+        return m_threads[m_cur++ % m_size]->dispatch(std::move(cb));
+    }
     do {
-        Atomic::addFetch(m_total, (uint64_t)1);
         RWMutex::WriteLock lock(m_mutex);
-        if (!m_advance) {
-            return m_threads[m_cur++ % m_size]->dispatch(cb);
-        }
         m_callbacks.push_back(cb);
     } while (0);
     check();
@@ -268,13 +272,13 @@ bool FoxThreadPool::dispatch(callback cb) {
 
 bool FoxThreadPool::batchDispatch(const std::vector<callback> &cbs) {
     Atomic::addFetch(m_total, cbs.size());
-    RWMutex::WriteLock lock(m_mutex);
     if (!m_advance) {
-        for (auto cb : cbs) {
+        for (auto &cb : cbs) {
             m_threads[m_cur++ % m_size]->dispatch(cb);
         }
         return true;
     }
+    RWMutex::WriteLock lock(m_mutex);
     for (auto cb : cbs) {
         m_callbacks.push_back(cb);
     }
@@ -13,6 +13,7 @@
 #include <event2/buffer.h>
 #include <event2/bufferevent.h>
 #include <event2/listener.h>
+#include <atomic>
 #include <list>
 #include <map>
 #include <string>
@@ -20,6 +21,7 @@
 #include <vector>
 
 #include "core/base/singleton.hpp"
+#include "core/ds/mpsc_queue.hpp"
 #include "core/io/lock.hpp"
 
 namespace IM {
@@ -84,6 +86,25 @@ class FoxThread : public IFoxThread {
     virtual uint64_t getTotal() { return m_total; }
 
    private:
+    /**
+     * @brief 待执行回调的队列节点，cb 为空表示停止线程
+     */
+    struct CallbackNode {
+        callback cb;
+        std::atomic<CallbackNode *> next = {nullptr};
+    };
+
+    /**
+     * @brief 入队回调
+     * @return bool 队列由空变为非空时返回true，此时需要唤醒事件循环
+     */
+    bool push(callback cb);
+
+    /**
+     * @brief 写唤醒字节
+     */
+    bool wakeup();
+
     void thread_cb();
     static void read_cb(evutil_socket_t sock, short which, void *args);
 
@@ -93,8 +114,8 @@ class FoxThread : public IFoxThread {
     struct event_base *m_base;
     struct event *m_event;
     std::thread *m_thread;
-    RWMutex m_mutex;
-    std::list<callback> m_callbacks;
+    /// 待执行回调：任意线程无锁入队，只有事件循环线程出队
+    ds::IntrusiveMpscQueue<CallbackNode, &CallbackNode::next> m_queue;
 
     std::string m_name;
     init_cb m_initCb;
@@ -140,7 +161,7 @@ class FoxThreadPool : public IFoxThread {
 
    private:
     uint32_t m_size;
-    uint32_t m_cur;
+    std::atomic<uint32_t> m_cur;
     std::string m_name;
     bool m_advance;
     bool m_start;
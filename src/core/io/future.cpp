@@ -0,0 +1,107 @@
+#include "core/io/future.hpp"
+
+#include "core/util/time_util.hpp"
+
+namespace IM {
+bool FutureStateBase::isReady() const {
+    SpinLock::Lock lock(m_mutex);
+    return m_ready;
+}
+
+void FutureStateBase::markReady() {
+    std::vector<std::pair<std::shared_ptr<SyncWaitState>, int>> waiters;
+    {
+        SpinLock::Lock lock(m_mutex);
+        m_ready = true;
+        waiters.swap(m_waiters);
+    }
+    for (auto &i : waiters) {
+        if (i.first->tryFire(i.second)) {
+            i.first->waiter.wake();
+        }
+    }
+}
+
+bool FutureStateBase::addWaiter(const std::shared_ptr<SyncWaitState> &state, int index) {
+    SpinLock::Lock lock(m_mutex);
+    if (m_ready) {
+        return false;
+    }
+    m_waiters.emplace_back(state, index);
+    return true;
+}
+
+void FutureStateBase::removeWaiter(const std::shared_ptr<SyncWaitState> &state) {
+    SpinLock::Lock lock(m_mutex);
+    for (auto it = m_waiters.begin(); it != m_waiters.end(); ++it) {
+        if (it->first == state) {
+            m_waiters.erase(it);
+            break;
+        }
+    }
+}
+
+int FutureStateBase::WaitAny(const std::vector<FutureStateBase *> &states, uint64_t timeout_ms) {
+    if (states.empty()) {
+        return -1;
+    }
+    SyncParker parker;
+    auto state = std::make_shared<SyncWaitState>();
+    // 不等待时不生成等待者，完成方的唤醒为空操作
+    if (timeout_ms) {
+        state->waiter = parker.waiter();
+    }
+    int timeout_index = states.size();
+    size_t added = 0;
+    bool ready = false;
+    for (; added < states.size(); ++added) {
+        if (!states[added]->addWaiter(state, added)) {
+            // 已就绪；tryFire 失败说明已登记的状态先完成了本次等待，它会唤醒我们
+            ready = state->tryFire(added);
+            break;
+        }
+    }
+    if (!ready) {
+        if (timeout_ms) {
+            parker.park(state, timeout_ms, timeout_index);
+        } else {
+            state->tryFire(timeout_index);
+        }
+    }
+    for (size_t i = 0; i < added; ++i) {
+        states[i]->removeWaiter(state);
+    }
+    int fired = state->fired.load(std::memory_order_acquire);
+    return fired == timeout_index ? -1 : fired;
+}
+
+bool FutureStateBase::WaitAll(const std::vector<FutureStateBase *> &states, uint64_t timeout_ms) {
+    uint64_t start = timeout_ms == kWaitForever ? 0 : TimeUtil::NowToMS();
+    for (auto state : states) {
+        if (state->isReady()) {
+            continue;
+        }
+        uint64_t left = kWaitForever;
+        if (timeout_ms != kWaitForever) {
+            uint64_t elapsed = TimeUtil::NowToMS() - start;
+            left = elapsed < timeout_ms ? timeout_ms - elapsed : 0;
+        }
+        if (WaitAny({state}, left) < 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Scheduler *FutureStateBase::GetAsyncScheduler(Scheduler *scheduler) {
+    Scheduler *current = Scheduler::GetThis();
+    if (current) {
+        // 调度器主协程不能挂起，共享栈协程挂起后栈上的局部变量不可访问
+        Coroutine *self = Coroutine::GetThis().get();
+        if (self == Scheduler::GetMainCoroutine() || self->isSharedStack()) {
+            return nullptr;
+        }
+    }
+    return scheduler ? scheduler : current;
+}
+}  // namespace IM
@@ -0,0 +1,303 @@
+/**
+ * @file future.hpp
+ * @brief 协程的 Future/Promise 与并发扇出(Async/WhenAll/WhenAny)
+ * @author DreamTraveler233
+ * @date 2026-01-10
+ *
+ * 请求处理中互不依赖的 RPC、数据库查询可以并发发起，总耗时取最慢的一个而不是各次往返之和：
+ *
+ *     auto contact = Async([=] { return contact_service->GetContactDetail(to, from); });
+ *     auto user = Async([=] { return user_service->LoadUserInfo(from); });
+ *     if (!WhenAll({contact, user}, 500)) { ... 超时 ... }
+ *     auto c = contact.get();
+ *
+ * - Async 把函数投递到调度器(默认当前调度器)作为新协程执行，返回其结果的 Future
+ * - Future::wait/WhenAll/WhenAny 在协程中挂起当前协程，在普通线程中阻塞线程；均可指定超时(毫秒)，
+ *   超时只结束等待，不会中断已投递的任务，任务结束后结果被丢弃。协程运行在 IOManager 上时超时由其
+ *   定时器触发；运行在普通 Scheduler 上时由一个进程内共享的定时器线程触发(首次使用时创建)
+ * - 任务抛出的异常在 Future::get 时重新抛出
+ * - 任务继承调用方的截止时间(见 deadline_context.hpp)
+ * 以下情况 Async 直接在当前协程中同步执行函数：
+ * - 未指定调度器且当前不在调度器中
+ * - 当前是共享栈协程：挂起后栈内容被换出，任务若按引用捕获了调用方的局部变量将读到错误数据
+ * - 当前是调度器主协程：它不能挂起，等待时会阻塞线程，投递到同一调度器的任务可能无法执行
+ * 超时返回后任务仍可能在运行，因此超时等待时任务不应按引用捕获调用方的局部变量。
+ */
+
+#ifndef __IM_IO_FUTURE_HPP__
+#define __IM_IO_FUTURE_HPP__
+
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+#include "core/io/scheduler.hpp"
+#include "core/util/deadline_context.hpp"
+
+namespace IM {
+/// 不超时
+static const uint64_t kWaitForever = ~0ull;
+
+/**
+ * @brief Future 共享状态中与值类型无关的部分：就绪标志与等待者
+ */
+class FutureStateBase : Noncopyable {
+   public:
+    /**
+     * @brief 是否已就绪(已设置值或异常)
+     */
+    bool isReady() const;
+
+    /**
+     * @brief 等待任一状态就绪
+     * @param[in] states 等待的状态
+     * @param[in] timeout_ms 超时时间(毫秒)
+     * @return int 就绪的状态下标，超时返回-1
+     */
+    static int WaitAny(const std::vector<FutureStateBase *> &states, uint64_t timeout_ms);
+
+    /**
+     * @brief 等待所有状态就绪
+     * @return 超时返回false
+     */
+    static bool WaitAll(const std::vector<FutureStateBase *> &states, uint64_t timeout_ms);
+
+    /**
+     * @brief 获取 Async 实际投递的调度器
+     * @param[in] scheduler 指定的调度器，nullptr 表示当前调度器
+     * @return 需要在当前协程同步执行时返回nullptr
+     */
+    static Scheduler *GetAsyncScheduler(Scheduler *scheduler);
+
+   protected:
+    /**
+     * @brief 标记为就绪并唤醒等待者，须在写入值或异常之后调用
+     */
+    void markReady();
+
+   private:
+    /**
+     * @brief 登记等待状态
+     * @return 已就绪时返回false，不登记
+     */
+    bool addWaiter(const std::shared_ptr<SyncWaitState> &state, int index);
+
+    /**
+     * @brief 撤销登记的等待状态
+     */
+    void removeWaiter(const std::shared_ptr<SyncWaitState> &state);
+
+   private:
+    mutable SpinLock m_mutex;                                               ///< 保护以下成员
+    bool m_ready = false;                                                   ///< 是否已就绪
+    std::vector<std::pair<std::shared_ptr<SyncWaitState>, int>> m_waiters;  ///< 等待者及其下标
+};
+
+/**
+ * @brief Future 共享状态
+ */
+template <class T>
+class FutureState : public FutureStateBase {
+   public:
+    using Value = typename std::conditional<std::is_void<T>::value, char, T>::type;
+
+    void setValue(Value value) {
+        m_value.emplace(std::move(value));
+        markReady();
+    }
+
+    void setException(std::exception_ptr error) {
+        m_error = error;
+        markReady();
+    }
+
+    /**
+     * @brief 取出结果，须在就绪后调用
+     */
+    T take() {
+        if (m_error) {
+            std::rethrow_exception(m_error);
+        }
+        if constexpr (!std::is_void<T>::value) {
+            return std::move(*m_value);
+        }
+    }
+
+   private:
+    std::optional<Value> m_value;  ///< 结果
+    std::exception_ptr m_error;    ///< 异常
+};
+
+/**
+ * @brief 异步结果的持有方，与 Future 之间只有引用计数
+ */
+class FutureBase {
+   public:
+    /**
+     * @brief 是否关联了共享状态
+     */
+    bool valid() const { return (bool)m_state; }
+
+    /**
+     * @brief 是否已就绪
+     */
+    bool isReady() const { return m_state && m_state->isReady(); }
+
+    /**
+     * @brief 等待就绪
+     * @param[in] timeout_ms 超时时间(毫秒)
+     * @return 超时返回false
+     */
+    bool wait(uint64_t timeout_ms = kWaitForever) const {
+        return isReady() || FutureStateBase::WaitAll({m_state.get()}, timeout_ms);
+    }
+
+    FutureStateBase *state() const { return m_state.get(); }
+
+   protected:
+    explicit FutureBase(std::shared_ptr<FutureStateBase> state) : m_state(std::move(state)) {}
+
+   protected:
+    std::shared_ptr<FutureStateBase> m_state;  ///< 共享状态
+};
+
+/**
+ * @brief 异步结果
+ * @details 结果只能通过 get 取出一次
+ */
+template <class T>
+class Future : public FutureBase {
+   public:
+    Future() : FutureBase(nullptr) {}
+    explicit Future(std::shared_ptr<FutureState<T>> state) : FutureBase(std::move(state)) {}
+
+    /**
+     * @brief 等待并取出结果，任务抛出异常时重新抛出
+     */
+    T get() {
+        wait();
+        return static_cast<FutureState<T> *>(m_state.get())->take();
+    }
+};
+
+/**
+ * @brief 异步结果的写入方
+ */
+template <class T>
+class Promise {
+   public:
+    Promise() : m_state(std::make_shared<FutureState<T>>()) {}
+
+    Future<T> getFuture() const { return Future<T>(m_state); }
+
+    template <class V = T, class = typename std::enable_if<!std::is_void<V>::value>::type>
+    void setValue(V value) {
+        m_state->setValue(std::move(value));
+    }
+
+    template <class V = T, class = typename std::enable_if<std::is_void<V>::value>::type>
+    void setValue() {
+        m_state->setValue(0);
+    }
+
+    void setException(std::exception_ptr error) { m_state->setException(error); }
+
+    /**
+     * @brief 执行函数并以其返回值或异常完成
+     */
+    template <class F>
+    void run(F &f) {
+        try {
+            if constexpr (std::is_void<T>::value) {
+                f();
+                setValue();
+            } else {
+                setValue(f());
+            }
+        } catch (...) {
+            setException(std::current_exception());
+        }
+    }
+
+   private:
+    std::shared_ptr<FutureState<T>> m_state;  ///< 共享状态
+};
+
+/**
+ * @brief 在调度器上以新协程执行函数
+ * @param[in] f 无参可调用对象，按值保存
+ * @param[in] scheduler 调度器，nullptr 表示当前调度器
+ * @return 函数结果的 Future
+ */
+template <class F>
+auto Async(F &&f, Scheduler *scheduler = nullptr) -> Future<typename std::decay<decltype(f())>::type> {
+    using R = typename std::decay<decltype(f())>::type;
+    Promise<R> promise;
+    Future<R> future = promise.getFuture();
+    Scheduler *target = FutureStateBase::GetAsyncScheduler(scheduler);
+    if (!target) {
+        promise.run(f);
+        return future;
+    }
+    // 任务继承调用方的截止时间，执行完毕后清除，回调协程复用时不会带给下一个任务
+    uint64_t deadline = DeadlineContext::GetDeadline();
+    target->schedule([promise, deadline, f = std::forward<F>(f)]() mutable {
+        DeadlineContext::SetDeadline(deadline);
+        promise.run(f);
+        DeadlineContext::SetDeadline(0);
+    });
+    return future;
+}
+
+/**
+ * @brief 等待所有 Future 就绪
+ * @param[in] timeout_ms 总超时时间(毫秒)
+ * @return 超时返回false
+ */
+inline bool WhenAll(std::initializer_list<std::reference_wrapper<const FutureBase>> futures,
+                    uint64_t timeout_ms = kWaitForever) {
+    std::vector<FutureStateBase *> states;
+    for (auto &i : futures) {
+        states.push_back(i.get().state());
+    }
+    return FutureStateBase::WaitAll(states, timeout_ms);
+}
+
+template <class T>
+bool WhenAll(const std::vector<Future<T>> &futures, uint64_t timeout_ms = kWaitForever) {
+    std::vector<FutureStateBase *> states;
+    for (auto &i : futures) {
+        states.push_back(i.state());
+    }
+    return FutureStateBase::WaitAll(states, timeout_ms);
+}
+
+/**
+ * @brief 等待任一 Future 就绪
+ * @param[in] timeout_ms 超时时间(毫秒)
+ * @return int 就绪的 Future 下标(多个就绪时返回其中之一)，超时返回-1
+ */
+inline int WhenAny(std::initializer_list<std::reference_wrapper<const FutureBase>> futures,
+                   uint64_t timeout_ms = kWaitForever) {
+    std::vector<FutureStateBase *> states;
+    for (auto &i : futures) {
+        states.push_back(i.get().state());
+    }
+    return FutureStateBase::WaitAny(states, timeout_ms);
+}
+
+template <class T>
+int WhenAny(const std::vector<Future<T>> &futures, uint64_t timeout_ms = kWaitForever) {
+    std::vector<FutureStateBase *> states;
+    for (auto &i : futures) {
+        states.push_back(i.state());
+    }
+    return FutureStateBase::WaitAny(states, timeout_ms);
+}
+}  // namespace IM
+
+#endif  // __IM_IO_FUTURE_HPP__
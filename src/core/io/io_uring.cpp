@@ -0,0 +1,323 @@
+#include "core/io/io_uring.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+#include "core/base/macro.hpp"
+#include "core/io/scheduler.hpp"
+
+namespace IM {
+static auto g_logger = IM_LOG_NAME("system");
+
+static int SysSetup(unsigned entries, io_uring_params *p) {
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int SysEnter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0);
+}
+
+static int SysRegister(int fd, unsigned opcode, const void *arg, unsigned nr_args) {
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+IoUring::~IoUring() {
+    if (m_sqes) {
+        munmap(m_sqes, m_sqesSize);
+    }
+    if (m_cqRing && m_cqRing != m_sqRing) {
+        munmap(m_cqRing, m_cqRingSize);
+    }
+    if (m_sqRing) {
+        munmap(m_sqRing, m_sqRingSize);
+    }
+    if (m_ringFd != -1) {
+        close(m_ringFd);
+    }
+    if (m_eventFd != -1) {
+        close(m_eventFd);
+    }
+}
+
+bool IoUring::init(unsigned entries) {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    m_ringFd = SysSetup(entries, &params);
+    if (m_ringFd < 0) {
+        m_ringFd = -1;
+        IM_LOG_WARN(g_logger) << "io_uring_setup failed: " << strerror(errno);
+        return false;
+    }
+
+    // 映射提交队列、完成队列与提交项数组
+    m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+        m_sqRingSize = m_cqRingSize = std::max(m_sqRingSize, m_cqRingSize);
+    }
+    m_sqRing = mmap(nullptr, m_sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd,
+                    IORING_OFF_SQ_RING);
+    if (m_sqRing == MAP_FAILED) {
+        m_sqRing = nullptr;
+        IM_LOG_WARN(g_logger) << "io_uring mmap sq ring failed: " << strerror(errno);
+        return false;
+    }
+    if (single_mmap) {
+        m_cqRing = m_sqRing;
+    } else {
+        m_cqRing = mmap(nullptr, m_cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd,
+                        IORING_OFF_CQ_RING);
+        if (m_cqRing == MAP_FAILED) {
+            m_cqRing = nullptr;
+            IM_LOG_WARN(g_logger) << "io_uring mmap cq ring failed: " << strerror(errno);
+            return false;
+        }
+    }
+    m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    void *sqes = mmap(nullptr, m_sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd,
+                      IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        IM_LOG_WARN(g_logger) << "io_uring mmap sqes failed: " << strerror(errno);
+        return false;
+    }
+    m_sqes = (io_uring_sqe *)sqes;
+
+    char *sq = (char *)m_sqRing;
+    m_sqHead = (unsigned *)(sq + params.sq_off.head);
+    m_sqTail = (unsigned *)(sq + params.sq_off.tail);
+    m_sqMask = *(unsigned *)(sq + params.sq_off.ring_mask);
+    m_sqEntries = *(unsigned *)(sq + params.sq_off.ring_entries);
+    m_sqArray = (unsigned *)(sq + params.sq_off.array);
+    m_sqLocalTail = *m_sqTail;
+
+    char *cq = (char *)m_cqRing;
+    m_cqHead = (unsigned *)(cq + params.cq_off.head);
+    m_cqTail = (unsigned *)(cq + params.cq_off.tail);
+    m_cqMask = *(unsigned *)(cq + params.cq_off.ring_mask);
+    m_cqes = (io_uring_cqe *)(cq + params.cq_off.cqes);
+
+    if (!probe()) {
+        return false;
+    }
+
+    // 完成事件通过 eventfd 通知，接入 IOManager 的 epoll
+    m_eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_eventFd < 0) {
+        m_eventFd = -1;
+        IM_LOG_WARN(g_logger) << "io_uring eventfd failed: " << strerror(errno);
+        return false;
+    }
+    if (SysRegister(m_ringFd, IORING_REGISTER_EVENTFD, &m_eventFd, 1) < 0) {
+        IM_LOG_WARN(g_logger) << "io_uring register eventfd failed: " << strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+bool IoUring::probe() {
+    // hook 用到的操作码，缺任何一个都回退到 epoll
+    static const uint8_t s_ops[] = {IORING_OP_READ,    IORING_OP_WRITE,   IORING_OP_READV,        IORING_OP_WRITEV,
+                                    IORING_OP_RECV,    IORING_OP_SEND,    IORING_OP_RECVMSG,      IORING_OP_SENDMSG,
+                                    IORING_OP_ACCEPT,  IORING_OP_LINK_TIMEOUT, IORING_OP_ASYNC_CANCEL};
+    size_t len = sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op);
+    std::vector<char> buf(len, 0);
+    io_uring_probe *p = (io_uring_probe *)buf.data();
+    if (SysRegister(m_ringFd, IORING_REGISTER_PROBE, p, 256) < 0) {
+        IM_LOG_WARN(g_logger) << "io_uring register probe failed: " << strerror(errno);
+        return false;
+    }
+    for (uint8_t op : s_ops) {
+        if (op > p->last_op || !(p->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+            IM_LOG_WARN(g_logger) << "io_uring opcode " << (int)op << " not supported";
+            return false;
+        }
+    }
+
+    // close 依赖按 fd 取消全部操作(IORING_ASYNC_CANCEL_FD|ALL，5.19+)；操作码探测看不出标志位，
+    // 实际提交一次：旧内核以 -EINVAL 拒绝非零的 cancel_flags，新内核找不到匹配项时返回 0 或 -ENOENT
+    io_uring_sqe *sqe = getSqeNolock();
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->cancel_flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL;
+    flushNolock();
+    int rt;
+    do {
+        rt = SysEnter(m_ringFd, 1, 1, IORING_ENTER_GETEVENTS);
+    } while (rt < 0 && errno == EINTR);
+    if (rt < 0) {
+        IM_LOG_WARN(g_logger) << "io_uring probe enter failed: " << strerror(errno);
+        return false;
+    }
+    unsigned head = *m_cqHead;
+    if (head == __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE)) {
+        IM_LOG_WARN(g_logger) << "io_uring probe got no completion";
+        return false;
+    }
+    int res = m_cqes[head & m_cqMask].res;
+    __atomic_store_n(m_cqHead, head + 1, __ATOMIC_RELEASE);
+    if (res == -EINVAL) {
+        IM_LOG_WARN(g_logger) << "io_uring cancel by fd unsupported (kernel < 5.19)";
+        return false;
+    }
+    return true;
+}
+
+unsigned IoUring::sqSpaceNolock() const {
+    return m_sqEntries - (m_sqLocalTail - __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE));
+}
+
+io_uring_sqe *IoUring::getSqeNolock() {
+    if (sqSpaceNolock() == 0) {
+        return nullptr;
+    }
+    unsigned index = m_sqLocalTail & m_sqMask;
+    io_uring_sqe *sqe = &m_sqes[index];
+    m_sqArray[index] = index;
+    ++m_sqLocalTail;
+    memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+void IoUring::flushNolock() {
+    __atomic_store_n(m_sqTail, m_sqLocalTail, __ATOMIC_RELEASE);
+}
+
+int IoUring::submitNolock() {
+    unsigned pending = m_sqLocalTail - __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE);
+    while (pending > 0) {
+        int rt = SysEnter(m_ringFd, pending, 0, 0);
+        if (rt < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -errno;
+        }
+        if (rt == 0) {
+            // 内核暂时无法消费(资源不足)，剩余提交项留在队列中，由下一次提交一并送入内核
+            break;
+        }
+        pending -= std::min((unsigned)rt, pending);
+    }
+    return 0;
+}
+
+void IoUring::rollbackNolock(unsigned count) {
+    m_sqLocalTail -= count;
+    m_inflight -= count;
+    flushNolock();
+}
+
+ssize_t IoUring::doAwait(void (*prep)(io_uring_sqe *, const void *), const void *arg, uint64_t timeout_ms) {
+    Request req;
+    req.coroutine = Coroutine::GetThis();
+    req.scheduler = Scheduler::GetThis();
+    __kernel_timespec ts;
+    unsigned count = timeout_ms == ~0ull ? 1 : 2;
+    {
+        MutexType::Lock lock(m_sqMutex);
+        if (sqSpaceNolock() < count) {
+            return -EBUSY;
+        }
+        io_uring_sqe *sqe = getSqeNolock();
+        prep(sqe, arg);
+        sqe->user_data = (uint64_t)&req;
+        if (count == 2) {
+            // 链接超时：到期时内核取消前一个操作，操作以-ECANCELED完成
+            sqe->flags |= IOSQE_IO_LINK;
+            ts.tv_sec = timeout_ms / 1000;
+            ts.tv_nsec = (timeout_ms % 1000) * 1000000;
+            io_uring_sqe *tsqe = getSqeNolock();
+            tsqe->opcode = IORING_OP_LINK_TIMEOUT;
+            tsqe->fd = -1;
+            tsqe->addr = (uint64_t)&ts;
+            tsqe->len = 1;
+            // 低位标记为超时事件，Request 至少按8字节对齐
+            tsqe->user_data = (uint64_t)&req | 1;
+            req.pending = 2;
+        }
+        m_inflight += count;
+        flushNolock();
+
+        // 持锁提交：其他线程不会在操作与其链接超时之间插入 io_uring_enter，二者总是一起进入内核；
+        // 提交项(以及其引用的超时时间)在返回前已被内核消费，之后才能挂起
+        unsigned head = __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE);
+        int rt = submitNolock();
+        if (rt < 0) {
+            IM_LOG_ERROR(g_logger) << "io_uring_enter failed: " << strerror(-rt);
+            // 本次提交的项尚未被内核消费(队列头未推进)，撤回后返回错误，不能挂起等待永远不会到达的完成事件
+            if (__atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE) == head) {
+                rollbackNolock(count);
+                return rt;
+            }
+        }
+    }
+    Coroutine::YieldToHold();
+
+    if (req.timedOut && req.res == -ECANCELED) {
+        return -ETIMEDOUT;
+    }
+    return req.res;
+}
+
+void IoUring::cancelFd(int fd) {
+    if (m_inflight == 0) {
+        return;
+    }
+    MutexType::Lock lock(m_sqMutex);
+    io_uring_sqe *sqe = getSqeNolock();
+    if (!sqe) {
+        return;
+    }
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = fd;
+    sqe->cancel_flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL;
+    sqe->user_data = 0;
+    ++m_inflight;
+    flushNolock();
+    unsigned head = __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE);
+    int rt = submitNolock();
+    if (rt < 0) {
+        IM_LOG_ERROR(g_logger) << "io_uring cancel fd=" << fd << " failed: " << strerror(-rt);
+        if (__atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE) == head) {
+            rollbackNolock(1);
+        }
+    }
+}
+
+void IoUring::reap() {
+    std::vector<std::pair<Scheduler *, Coroutine::ptr>> ready;
+    {
+        MutexType::Lock lock(m_cqMutex);
+        unsigned head = *m_cqHead;
+        unsigned tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head) {
+            const io_uring_cqe &cqe = m_cqes[head & m_cqMask];
+            --m_inflight;
+            if (cqe.user_data == 0) {
+                continue;
+            }
+            Request *req = (Request *)(cqe.user_data & ~1ull);
+            if (cqe.user_data & 1) {
+                req->timedOut = cqe.res == -ETIME;
+            } else {
+                req->res = cqe.res;
+            }
+            // 最后一个完成事件到达后唤醒协程，此后不能再访问 req
+            if (--req->pending == 0) {
+                ready.emplace_back(req->scheduler, std::move(req->coroutine));
+            }
+        }
+        __atomic_store_n(m_cqHead, head, __ATOMIC_RELEASE);
+    }
+    for (auto &i : ready) {
+        i.first->schedule(std::move(i.second));
+    }
+}
+}  // namespace IM
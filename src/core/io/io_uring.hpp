@@ -0,0 +1,168 @@
+/**
+ * @file io_uring.hpp
+ * @brief io_uring 提交/完成队列封装
+ * @author DreamTraveler233
+ * @date 2026-01-10
+ *
+ * IOManager 的 io_uring 后端。直接使用 io_uring_setup/io_uring_enter/io_uring_register 系统调用，
+ * 不依赖 liburing。协程把一次 IO 操作写入提交队列后挂起，完成事件由 IOManager 的空闲线程
+ * 统一收割并唤醒对应协程：
+ * - 阻塞的 IO 只需一次 io_uring_enter，数据随完成事件一起返回，省去 epoll_ctl 重新挂载与再次读写
+ * - 完成队列通过注册的 eventfd 接入 IOManager 的 epoll，一次唤醒可以收割多个完成事件
+ * - 超时通过 IORING_OP_LINK_TIMEOUT 链接到 IO 操作上，由内核取消，无需额外的定时器
+ */
+
+#ifndef __IM_IO_IO_URING_HPP__
+#define __IM_IO_IO_URING_HPP__
+
+#include <atomic>
+#include <linux/io_uring.h>
+#include <sys/types.h>
+
+#include "core/base/noncopyable.hpp"
+
+#include "coroutine.hpp"
+#include "lock.hpp"
+
+namespace IM {
+class Scheduler;
+
+/**
+ * @brief io_uring 实例
+ */
+class IoUring : public Noncopyable {
+   public:
+    using MutexType = Mutex;
+
+    /**
+     * @brief 构造函数，不创建 ring，需调用 init
+     */
+    IoUring() = default;
+
+    /**
+     * @brief 析构函数，解除映射并关闭 ring 与 eventfd
+     */
+    ~IoUring();
+
+    /**
+     * @brief 创建 ring 并注册完成通知 eventfd
+     * @param[in] entries 提交队列长度
+     * @return bool 内核不支持 io_uring(或被禁用)、缺少所需操作码或不支持按 fd 取消(5.19 以下)时返回false
+     */
+    bool init(unsigned entries);
+
+    /**
+     * @brief 完成通知 eventfd，有完成事件时可读
+     */
+    int getEventFd() const { return m_eventFd; }
+
+    /**
+     * @brief 提交一次 IO 操作并挂起当前协程直到完成
+     * @param[in] prep 填写提交项的函数对象，签名为 void(io_uring_sqe *)
+     * @param[in] timeout_ms 超时时间(毫秒)，~0ull表示不超时
+     * @return ssize_t 操作结果；失败(含 io_uring_enter 提交失败)时返回负的错误码，超时返回-ETIMEDOUT，
+     *         提交队列已满返回-EBUSY
+     */
+    template <class Prep>
+    ssize_t await(const Prep &prep, uint64_t timeout_ms) {
+        return doAwait([](io_uring_sqe *sqe, const void *arg) { (*(const Prep *)arg)(sqe); }, &prep, timeout_ms);
+    }
+
+    /**
+     * @brief 取消指定文件描述符上所有未完成的操作(关闭fd前调用)
+     * @param[in] fd 文件描述符
+     */
+    void cancelFd(int fd);
+
+    /**
+     * @brief 收割全部完成事件并唤醒等待的协程
+     */
+    void reap();
+
+    /**
+     * @brief 尚未完成的操作数量
+     */
+    size_t getInflight() const { return m_inflight; }
+
+   private:
+    /**
+     * @brief 一次等待中的 IO 操作，位于发起协程的栈上
+     */
+    struct Request {
+        Coroutine::ptr coroutine;        ///< 等待完成的协程
+        Scheduler *scheduler = nullptr;  ///< 恢复协程的调度器
+        int32_t res = 0;                 ///< 操作结果
+        bool timedOut = false;           ///< 链接的超时是否触发
+        std::atomic<int> pending = {1};  ///< 尚未收到的完成事件数(带超时时为2)
+    };
+
+    /**
+     * @brief await 的类型擦除实现
+     */
+    ssize_t doAwait(void (*prep)(io_uring_sqe *, const void *), const void *arg, uint64_t timeout_ms);
+
+    /**
+     * @brief 取一个空闲提交项(需持有m_sqMutex)
+     * @return io_uring_sqe* 提交队列已满时返回nullptr
+     */
+    io_uring_sqe *getSqeNolock();
+
+    /**
+     * @brief 提交队列剩余空位(需持有m_sqMutex)
+     */
+    unsigned sqSpaceNolock() const;
+
+    /**
+     * @brief 发布已填写的提交项(需持有m_sqMutex)
+     */
+    void flushNolock();
+
+    /**
+     * @brief 通知内核消费全部已发布但尚未提交的提交项(需持有m_sqMutex)
+     * @details 必须持锁：否则一个线程的 io_uring_enter 可能只带走另一个线程的半条链接(操作与其链接超时)
+     * @return int 成功返回0，失败返回负的错误码
+     */
+    int submitNolock();
+
+    /**
+     * @brief 撤回队尾尚未被内核消费的提交项(需持有m_sqMutex)
+     * @param[in] count 撤回的数量
+     */
+    void rollbackNolock(unsigned count);
+
+    /**
+     * @brief 检查内核是否支持 hook 用到的操作码以及按 fd 取消(IORING_ASYNC_CANCEL_FD)
+     * @return bool 不支持时返回false，由 IOManager 回退到 epoll
+     */
+    bool probe();
+
+   private:
+    int m_ringFd = -1;   ///< io_uring 文件描述符
+    int m_eventFd = -1;  ///< 完成通知 eventfd
+
+    void *m_sqRing = nullptr;        ///< 提交队列映射
+    size_t m_sqRingSize = 0;         ///< 提交队列映射大小
+    void *m_cqRing = nullptr;        ///< 完成队列映射(SINGLE_MMAP时与提交队列相同)
+    size_t m_cqRingSize = 0;         ///< 完成队列映射大小
+    io_uring_sqe *m_sqes = nullptr;  ///< 提交项数组
+    size_t m_sqesSize = 0;           ///< 提交项数组映射大小
+
+    unsigned *m_sqHead = nullptr;   ///< 提交队列头(内核推进)
+    unsigned *m_sqTail = nullptr;   ///< 提交队列尾(用户推进)
+    unsigned m_sqMask = 0;          ///< 提交队列下标掩码
+    unsigned m_sqEntries = 0;       ///< 提交队列长度
+    unsigned *m_sqArray = nullptr;  ///< 提交队列下标数组
+    unsigned m_sqLocalTail = 0;     ///< 已填写但尚未发布的尾部
+
+    unsigned *m_cqHead = nullptr;    ///< 完成队列头(用户推进)
+    unsigned *m_cqTail = nullptr;    ///< 完成队列尾(内核推进)
+    unsigned m_cqMask = 0;           ///< 完成队列下标掩码
+    io_uring_cqe *m_cqes = nullptr;  ///< 完成事件数组
+
+    MutexType m_sqMutex;                   ///< 保护提交队列
+    MutexType m_cqMutex;                   ///< 保护完成队列
+    std::atomic<size_t> m_inflight = {0};  ///< 尚未完成的操作数量
+};
+}  // namespace IM
+
+#endif  // __IM_IO_IO_URING_HPP__
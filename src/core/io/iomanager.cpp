@@ -1,17 +1,45 @@
 #include "core/io/iomanager.hpp"
 
+#include <algorithm>
 #include <cerrno>
-#include <fcntl.h>
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <unistd.h>
 
 #include "core/base/macro.hpp"
+#include "core/config/config.hpp"
 #include "core/net/core/fd_manager.hpp"
+#include "core/util/time_util.hpp"
 
 namespace IM {
 static auto g_logger = IM_LOG_NAME("system");
 
-IOManager::IOManager(size_t threads, bool use_caller, const std::string &name) : Scheduler(threads, use_caller, name) {
+// 定义配置项--工作线程私有定时器管理器--默认开启
+static auto g_iomanager_per_worker_timers = Config::Lookup<bool>(
+    "iomanager.per_worker_timers", true, "timers armed on a worker thread fire on that worker thread");
+
+// 定义配置项--单次 epoll_wait 最多取回的事件数
+static auto g_iomanager_epoll_batch =
+    Config::Lookup<int>("iomanager.epoll_batch_size", 256, "max events returned by one epoll_wait");
+
+// 定义配置项--epoll_wait 最长等待时间(毫秒)
+static auto g_iomanager_epoll_max_timeout =
+    Config::Lookup<int>("iomanager.epoll_max_timeout_ms", 3000, "max epoll_wait timeout in milliseconds");
+
+// 定义配置项--IO后端--epoll或io_uring(内核不支持时回退到epoll)
+static auto g_iomanager_backend =
+    Config::Lookup<std::string>("iomanager.backend", std::string("epoll"), "io backend: epoll or io_uring");
+
+// 定义配置项--io_uring 提交队列长度
+static auto g_iomanager_io_uring_entries =
+    Config::Lookup<uint32_t>("iomanager.io_uring_entries", 4096, "io_uring submission queue entries");
+
+// 定义配置项--空闲线程睡眠前自旋轮询的时间上限(微秒)，0表示不自旋
+static auto g_iomanager_spin_us =
+    Config::Lookup<uint32_t>("iomanager.spin_us", 0, "busy-poll budget in microseconds before epoll_wait blocks");
+
+IOManager::IOManager(size_t threads, bool use_caller, const std::string &name, const ThreadAffinity &affinity)
+    : Scheduler(threads, use_caller, name, affinity) {
     int saved_errno;
     // 创建 epoll 实例，用于监听文件描述符事件
     FileDescriptor epfd(epoll_create1(EPOLL_CLOEXEC));  // 避免在子进程中继承文件描述符
@@ -21,46 +49,58 @@ IOManager::IOManager(size_t threads, bool use_caller, const std::string &name) :
         throw std::runtime_error("IOManager initialization failed");
     }
 
-    // 创建管道，用于唤醒调度器
-    int pipe_fd[2];
-    int rt = pipe(pipe_fd);
-    if (-1 == rt) {
+    // 创建 eventfd，用于唤醒调度器(相比管道只占一个文件描述符，读写都是一次8字节计数)
+    FileDescriptor tickle_fd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC));
+    if (!tickle_fd.isValid()) {
         saved_errno = errno;
-        IM_LOG_ERROR(g_logger) << "pipe failed: " << strerror(saved_errno);
+        IM_LOG_ERROR(g_logger) << "eventfd failed: " << strerror(saved_errno);
         throw std::runtime_error("IOManager initialization failed");
     }
 
-    FileDescriptor pipe_read_fd(pipe_fd[0]);
-    FileDescriptor pipe_write_fd(pipe_fd[1]);
-
     epoll_event ev = {};
-    ev.events = EPOLLIN | EPOLLET;    // 使用 ET 模式监听读事件
-    ev.data.fd = pipe_read_fd.get();  // 关联管道的读端
+    ev.events = EPOLLIN | EPOLLET;  // 使用 ET 模式监听读事件
+    ev.data.fd = tickle_fd.get();
 
-    // 将管道的读端设置为非阻塞模式，避免在读取时发生阻塞（若无数据可读或者是无法写入则立即返回）
-    rt = fcntl(pipe_read_fd.get(), F_SETFL, O_NONBLOCK);
+    // 将 eventfd 添加到 epoll 实例中，以监听其事件
+    int rt = epoll_ctl(epfd.get(), EPOLL_CTL_ADD, tickle_fd.get(), &ev);
     if (-1 == rt) {
         saved_errno = errno;
-        IM_LOG_ERROR(g_logger) << "fcntl failed: " << strerror(saved_errno);
+        IM_LOG_ERROR(g_logger) << "epoll_ctl failed: " << strerror(saved_errno);
         throw std::runtime_error("IOManager initialization failed");
     }
 
-    // 将管道的读端添加到 epoll 实例中，以监听其事件
-    rt = epoll_ctl(epfd.get(), EPOLL_CTL_ADD, pipe_read_fd.get(), &ev);
-    if (-1 == rt) {
-        saved_errno = errno;
-        IM_LOG_ERROR(g_logger) << "epoll_ctl failed: " << strerror(saved_errno);
-        throw std::runtime_error("IOManager initialization failed");
+    // io_uring 后端：完成通知 eventfd 同样挂到 epoll 上，由空闲线程收割完成事件
+    if (g_iomanager_backend->getValue() == "io_uring") {
+        std::unique_ptr<IoUring> uring(new IoUring);
+        if (uring->init(g_iomanager_io_uring_entries->getValue())) {
+            epoll_event uev = {};
+            uev.events = EPOLLIN | EPOLLET;
+            uev.data.fd = uring->getEventFd();
+            if (epoll_ctl(epfd.get(), EPOLL_CTL_ADD, uring->getEventFd(), &uev) == 0) {
+                m_uring = std::move(uring);
+            }
+        }
+        if (!m_uring) {
+            IM_LOG_WARN(g_logger) << "name=" << name << " io_uring unavailable, fall back to epoll";
+        }
     }
 
     // 所有资源初始化成功，释放所有权并保存到成员变量中
     m_epfd = epfd.release();
-    m_tickleFds[0] = pipe_read_fd.release();
-    m_tickleFds[1] = pipe_write_fd.release();
+    m_tickleFd = tickle_fd.release();
+    m_spinUs = g_iomanager_spin_us->getValue();
 
     // 初始化上下文存储容量，确保可以容纳足够的上下文对象
     contextResize(65535);
 
+    // 为每个工作线程(包括调用线程)准备私有的定时器管理器
+    if (g_iomanager_per_worker_timers->getValue()) {
+        m_workerTimers.reserve(getWorkerCount());
+        for (size_t i = 0; i < getWorkerCount(); ++i) {
+            m_workerTimers.emplace_back(new WorkerTimerManager(this, i));
+        }
+    }
+
     // 启动调度器，开始任务调度
     start();
 }
@@ -68,10 +108,9 @@ IOManager::IOManager(size_t threads, bool use_caller, const std::string &name) :
 IOManager::~IOManager() {
     stop();
 
-    // 关闭 epoll 文件描述符和管道文件描述符
+    // 关闭 epoll 文件描述符和 eventfd
     close(m_epfd);
-    close(m_tickleFds[0]);
-    close(m_tickleFds[1]);
+    close(m_tickleFd);
 
     // 遍历并释放所有的 FdContext 对象
     for (size_t i = 0; i < m_fdContexts.size(); ++i) {
@@ -321,15 +360,36 @@ void IOManager::tickle() {
     if (!hasIdleThreads()) {
         return;
     }
-    // 通过管道写入一个字节 "T" 以触发调度器
-    int rt = write(m_tickleFds[1], "T", 1);
-    IM_ASSERT(rt == 1)
+    // 已有尚未被取走的唤醒时不再重复写入，避免突发调度时反复陷入内核
+    if (m_ticklePending.exchange(true)) {
+        return;
+    }
+    uint64_t one = 1;
+    int rt = write(m_tickleFd, &one, sizeof(one));
+    IM_ASSERT(rt == sizeof(one))
+    if (getMetrics()) {
+        getMetrics()->onTickle();
+    }
 }
 
 bool IOManager::stopping(uint64_t &timeout) {
     timeout = getNextTimer();
+    int index = getWorkerIndex();
+    if (index != -1 && !m_workerTimers.empty()) {
+        timeout = std::min(timeout, m_workerTimers[index]->getNextTimer());
+    }
     // ~0ull表示没有定时器或者无限超时
-    return timeout == ~0ull && m_pendingEventCount == 0 && Scheduler::stopping();
+    if (timeout != ~0ull || m_pendingEventCount != 0 || (m_uring && m_uring->getInflight() != 0) ||
+        !Scheduler::stopping()) {
+        return false;
+    }
+    // 其他工作线程仍有定时器时不能退出，与共享定时器时的语义保持一致
+    for (auto &timers : m_workerTimers) {
+        if (timers->hasTimer()) {
+            return false;
+        }
+    }
+    return true;
 }
 
 bool IOManager::stopping() {
@@ -342,9 +402,17 @@ void IOManager::idle() {
     IM_LOG_DEBUG(g_logger) << "idle";
 
     // 分配 epoll_event 数组并使用智能指针管理内存，用于存储 epoll 等待到的事件
-    epoll_event *events = new epoll_event[64]();
+    const int batch = std::max(1, g_iomanager_epoll_batch->getValue());
+    epoll_event *events = new epoll_event[batch]();
     std::shared_ptr<epoll_event> shared_event(events, [](epoll_event *ptr) { delete[] ptr; });
 
+    // 本线程私有的定时器管理器
+    int index = getWorkerIndex();
+    TimerManager *worker_timers = index != -1 && !m_workerTimers.empty() ? m_workerTimers[index].get() : nullptr;
+
+    // 自适应自旋时长(微秒)：自旋期间等到事件时加倍，白白自旋时减半
+    uint32_t spin_us = m_spinUs;
+
     // 主空闲循环，持续运行直到满足停止条件
     while (true) {
         // ==========停止条件检查==========
@@ -352,23 +420,47 @@ void IOManager::idle() {
         uint64_t next_timeout = 0;
         if (stopping(next_timeout)) {
             IM_LOG_INFO(g_logger) << "name=" << getName() << " idle stopping exit";
+            // 唤醒是合并的，把停止信号继续传给下一个空闲线程
+            tickle();
             break;
         }
 
-        // ==========epoll_wait 等待事件==========
+        // 限制超时时间不超过上限，确保定时任务能够及时执行
+        const uint64_t max_timeout = std::max(1, g_iomanager_epoll_max_timeout->getValue());
+        int timeout = (int)std::min(next_timeout, max_timeout);
+
         int rt = 0;
-        do {
-            static const int MAX_TIMEOUT = 3000;  // 设置最大超时时间为3秒
-            if (next_timeout != ~0ull)            // 如果有定时器
-            {
-                // 限制超时时间不超过 MAX_TIMEOUT 毫秒
-                next_timeout = (int)next_timeout > MAX_TIMEOUT ? MAX_TIMEOUT : next_timeout;
-            } else {
-                next_timeout = MAX_TIMEOUT;
+        // ==========自旋轮询==========
+        // 延迟敏感的线程池先以非阻塞方式轮询一小段时间，事件在此期间到达时省去一次睡眠与唤醒
+        uint32_t spin_max = m_spinUs;
+        bool spun = false;
+        if (spin_max > 0 && timeout > 0) {
+            spin_us = std::min(std::max(spin_us, spin_max / 16), spin_max);
+            uint64_t deadline = TimeUtil::NowToUS() + std::min<uint64_t>(spin_us, timeout * 1000ull);
+            do {
+                rt = epoll_wait(m_epfd, events, batch, 0);
+            } while (rt == 0 && TimeUtil::NowToUS() < deadline);
+            spun = rt > 0;
+            if (spun) {
+                spin_us = std::min(spin_us * 2, spin_max);
             }
-            // 等待 epoll 事件，超时时间为 next_timeout 毫秒，确保定时任务能够及时执行
-            rt = epoll_wait(m_epfd, events, 64, (int)next_timeout);
-        } while (rt < 0 && errno == EINTR);
+        }
+
+        // ==========epoll_wait 等待事件==========
+        if (!spun) {
+            uint64_t begin = spin_max > 0 ? TimeUtil::NowToUS() : 0;
+            do {
+                rt = epoll_wait(m_epfd, events, batch, timeout);
+            } while (rt < 0 && errno == EINTR);
+            if (spin_max > 0) {
+                // 睡眠很快就被事件打断，说明多自旋一会儿就能等到
+                bool short_sleep = rt > 0 && TimeUtil::NowToUS() - begin <= spin_max;
+                spin_us = short_sleep ? std::min(spin_us * 2, spin_max) : spin_us / 2;
+            }
+        }
+
+        // 协程不再创建销毁时 Dealloc 不会被调用，由空闲循环归还闲置栈的物理内存
+        PooledStackAllocator::Trim();
 
         // ==========处理到期定时器==========
         std::vector<std::function<void()>> cbs;
@@ -378,15 +470,33 @@ void IOManager::idle() {
             schedule(cbs.begin(), cbs.end());
             cbs.clear();
         }
+        // 本线程私有的定时器回调投递到本线程信箱，留在本线程执行
+        if (worker_timers) {
+            worker_timers->listExpiredCb(cbs);
+            for (auto &cb : cbs) {
+                schedule(&cb, GetThreadId());
+            }
+            cbs.clear();
+        }
 
         // ==========处理 epoll 事件==========
         for (int i = 0; i < rt; ++i) {
             epoll_event &event = events[i];
 
-            // 如果事件来自用于唤醒调度器的管道，清空管道中的数据
-            if (event.data.fd == m_tickleFds[0]) {
-                uint8_t dummy;
-                while (read(m_tickleFds[0], &dummy, 1) == 1);
+            // 如果事件来自用于唤醒调度器的 eventfd，先清零计数再清除待处理标记。顺序不能颠倒：
+            // 清除标记后写入的唤醒若被这里读掉，内核重新检查可读性时会丢弃该事件，标记将永远无法复位
+            if (event.data.fd == m_tickleFd) {
+                uint64_t dummy;
+                while (read(m_tickleFd, &dummy, sizeof(dummy)) == sizeof(dummy));
+                m_ticklePending = false;
+                continue;
+            }
+
+            // io_uring 完成通知：先清零计数再收割，之后到达的完成事件会再次触发
+            if (m_uring && event.data.fd == m_uring->getEventFd()) {
+                uint64_t dummy;
+                while (read(m_uring->getEventFd(), &dummy, sizeof(dummy)) == sizeof(dummy));
+                m_uring->reap();
                 continue;
             }
 
@@ -457,6 +567,25 @@ void IOManager::onTimerInsertedAtFront() {
     tickle();
 }
 
+void IOManager::setSpinUs(uint32_t us) {
+    m_spinUs = us;
+}
+
+TimerManager *IOManager::selectTimerManager() {
+    int index = getWorkerIndex();
+    if (index == -1 || m_workerTimers.empty()) {
+        return this;
+    }
+    return m_workerTimers[index].get();
+}
+
+void IOManager::WorkerTimerManager::onTimerInsertedAtFront() {
+    // 属主线程自己添加的定时器无需唤醒：它回到idle时会重新计算等待时间
+    if (m_iom->getWorkerIndex() != m_index) {
+        m_iom->wakeWorker(m_index);
+    }
+}
+
 void IOManager::contextResize(size_t size) {
     m_fdContexts.resize(size);
 
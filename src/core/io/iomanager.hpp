@@ -8,11 +8,16 @@
  * 继承自Scheduler（协程调度器）和TimerManager（定时器管理器）。
  * IOManager能够监听文件描述符上的读写事件，并在事件就绪时自动调度
  * 相应的协程或回调函数执行，从而实现高效的异步IO编程。
+ * 开启 iomanager.per_worker_timers 时，每个工作线程拥有私有的定时器管理器，
+ * 工作线程上添加的定时器在本线程到期执行；非工作线程添加的定时器仍由共享管理器处理。
+ * iomanager.backend 设为 io_uring 时，hook 的 socket 读写在阻塞时改为提交到 io_uring，
+ * 完成通知 eventfd 挂在同一个 epoll 上，内核不支持时自动回退到 epoll。
  */
 
 #ifndef __IM_IO_IOMANAGER_HPP__
 #define __IM_IO_IOMANAGER_HPP__
 
+#include "io_uring.hpp"
 #include "scheduler.hpp"
 #include "timer.hpp"
 
@@ -82,14 +87,41 @@ class IOManager : public Scheduler, public TimerManager {
         MutexType mutex;      /// 保护该上下文的互斥锁
     };
 
+    /**
+     * @brief 工作线程私有的定时器管理器
+     * @details 工作线程上添加的定时器归属本线程的管理器，到期后也由本线程取出并在本线程执行，
+     *          定时器的增删与到期处理不再与其他线程竞争同一把锁
+     */
+    class WorkerTimerManager : public TimerManager {
+       public:
+        /**
+         * @brief 构造函数
+         * @param[in] iom 所属IOManager
+         * @param[in] index 工作线程下标
+         */
+        WorkerTimerManager(IOManager *iom, int index) : m_iom(iom), m_index(index) {}
+
+       protected:
+        /**
+         * @brief 其他线程把定时器提前到队首时，唤醒属主线程重新计算等待时间
+         */
+        void onTimerInsertedAtFront() override;
+
+       private:
+        IOManager *m_iom;  /// 所属IOManager
+        int m_index;       /// 工作线程下标
+    };
+
    public:
     /**
      * @brief 构造函数
      * @param[in] threads 线程数量
      * @param[in] use_caller 是否使用调用线程作为调度线程之一
      * @param[in] name 调度器名称
+     * @param[in] affinity 工作线程的CPU亲和性与NUMA内存策略
      */
-    IOManager(size_t threads = 1, bool use_caller = true, const std::string &name = "");
+    IOManager(size_t threads = 1, bool use_caller = true, const std::string &name = "",
+              const ThreadAffinity &affinity = ThreadAffinity());
 
     /**
      * @brief 析构函数
@@ -134,6 +166,24 @@ class IOManager : public Scheduler, public TimerManager {
      */
     static IOManager *GetThis();
 
+    /**
+     * @brief 设置空闲线程睡眠前自旋轮询的时间上限
+     * @details 适用于延迟敏感的线程池，实际自旋时长在上限内按命中情况自适应调整
+     * @param[in] us 自旋上限(微秒)，0表示不自旋，直接阻塞在epoll_wait上
+     */
+    void setSpinUs(uint32_t us);
+
+    /**
+     * @brief 获取自旋轮询的时间上限(微秒)
+     */
+    uint32_t getSpinUs() const { return m_spinUs; }
+
+    /**
+     * @brief 获取 io_uring 后端
+     * @return IoUring* 未启用或内核不支持时返回nullptr，此时使用epoll
+     */
+    IoUring *getIoUring() const { return m_uring.get(); }
+
    protected:
     /**
      * @brief 唤醒空闲线程
@@ -156,6 +206,12 @@ class IOManager : public Scheduler, public TimerManager {
      */
     void onTimerInsertedAtFront() override;
 
+    /**
+     * @brief 工作线程上添加的定时器归属该线程私有的定时器管理器，其他线程归属共享管理器
+     * @return TimerManager* 新定时器的归属管理器
+     */
+    TimerManager *selectTimerManager() override;
+
     /**
      * @brief 调整文件描述符上下文数组大小
      * @param[in] size 新的数组大小
@@ -171,10 +227,14 @@ class IOManager : public Scheduler, public TimerManager {
 
    private:
     int m_epfd = 0;                                 /// epoll文件描述符
-    int m_tickleFds[2];                             /// 用于唤醒epoll_wait的管道文件描述符
+    int m_tickleFd = -1;                            /// 用于唤醒epoll_wait的eventfd
+    std::atomic<bool> m_ticklePending = {false};    /// 是否已有尚未被取走的唤醒
+    std::atomic<uint32_t> m_spinUs = {0};           /// 空闲线程自旋轮询的时间上限(微秒)
     std::atomic<size_t> m_pendingEventCount = {0};  /// 待处理的事件数量
     RWMutexType m_mutex;                            /// 保护文件描述符上下文数组的读写锁
     std::vector<FdContext *> m_fdContexts;          /// 文件描述符上下文数组
+    std::vector<std::unique_ptr<WorkerTimerManager>> m_workerTimers;  /// 各工作线程私有的定时器管理器
+    std::unique_ptr<IoUring> m_uring;                                 /// io_uring后端，为空时使用epoll
 };
 }  // namespace IM
 
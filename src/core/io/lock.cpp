@@ -1,7 +1,9 @@
 #include "core/io/lock.hpp"
 
 #include "core/base/macro.hpp"
+#include "core/io/iomanager.hpp"
 #include "core/io/scheduler.hpp"
+#include "core/io/thread.hpp"
 
 namespace IM {
 Mutex::Mutex() {
@@ -98,4 +100,249 @@ void CoroutineSemaphore::notify() {
         ++m_concurrency;
     }
 }
+
+void SyncWaiter::wake() {
+    if (scheduler) {
+        scheduler->schedule(std::move(coroutine));
+    } else if (sem) {
+        sem->notify();
+    }
+}
+
+/**
+ * @brief 不在 IOManager 上的协程(普通 Scheduler)带超时等待时使用的定时器线程
+ * @details 进程内只有一个，首次使用时创建，不随静态对象析构(避免退出时等待者仍持有定时器)
+ */
+class SyncTimerThread : public TimerManager {
+   public:
+    static SyncTimerThread *GetInstance() {
+        static SyncTimerThread *s_instance = new SyncTimerThread;
+        return s_instance;
+    }
+
+   protected:
+    void onTimerInsertedAtFront() override { m_sem.notify(); }
+
+   private:
+    SyncTimerThread() : m_thread(new Thread(std::bind(&SyncTimerThread::run, this), "sync_timer")) {}
+
+    void run() {
+        std::vector<std::function<void()>> cbs;
+        while (true) {
+            uint64_t next = getNextTimer();
+            if (next == ~0ull) {
+                m_sem.wait();
+            } else if (next > 0) {
+                m_sem.waitFor(next);
+            }
+            listExpiredCb(cbs);
+            for (auto &cb : cbs) {
+                cb();
+            }
+            cbs.clear();
+        }
+    }
+
+   private:
+    Semaphore m_sem;        ///< 有更早的定时器插入时唤醒
+    Thread::ptr m_thread;   ///< 定时器线程
+};
+
+SyncParker::SyncParker() : m_coroutine(InCoroutine()) {}
+
+bool SyncParker::InCoroutine() {
+    return Scheduler::GetThis() && Coroutine::GetThis().get() != Scheduler::GetMainCoroutine();
+}
+
+SyncWaiter SyncParker::waiter() {
+    SyncWaiter waiter;
+    if (m_coroutine) {
+        waiter.scheduler = Scheduler::GetThis();
+        waiter.coroutine = Coroutine::GetThis();
+    } else {
+        waiter.sem = &m_sem;
+    }
+    return waiter;
+}
+
+void SyncParker::park() {
+    if (m_coroutine) {
+        Coroutine::YieldToHold();
+    } else {
+        m_sem.wait();
+    }
+}
+
+void SyncParker::park(const std::shared_ptr<SyncWaitState> &state, uint64_t timeout_ms, int timeout_index) {
+    if (timeout_ms == ~0ull) {
+        park();
+        return;
+    }
+    if (m_coroutine) {
+        std::weak_ptr<SyncWaitState> weak(state);
+        auto on_timeout = [weak, timeout_index]() {
+            auto state = weak.lock();
+            if (state && state->tryFire(timeout_index)) {
+                state->waiter.wake();
+            }
+        };
+        // 普通 Scheduler 没有定时器，超时交给独立的定时器线程，唤醒时协程投递回原调度器
+        IOManager *iom = IOManager::GetThis();
+        Timer::ptr timer = iom ? iom->addTimer(timeout_ms, on_timeout)
+                               : SyncTimerThread::GetInstance()->addTimer(timeout_ms, on_timeout);
+        Coroutine::YieldToHold();
+        if (timer) {
+            timer->cancel();
+        }
+        return;
+    }
+    if (m_sem.waitFor(timeout_ms) || state->tryFire(timeout_index)) {
+        return;
+    }
+    // 超时与等待源同时完成，等待源已经或即将通知信号量，必须等它通知后才能释放栈上的信号量
+    m_sem.wait();
+}
+
+bool CoroutineMutex::tryLock() {
+    SpinLock::Lock lock(m_mutex);
+    if (m_locked) {
+        return false;
+    }
+    m_locked = true;
+    return true;
+}
+
+void CoroutineMutex::lock() {
+    if (tryLock()) {
+        return;
+    }
+    SyncParker parker;
+    {
+        SpinLock::Lock lock(m_mutex);
+        if (!m_locked) {
+            m_locked = true;
+            return;
+        }
+        m_waiters.push_back(parker.waiter());
+    }
+    // 被唤醒时锁已经移交给当前协程
+    parker.park();
+}
+
+void CoroutineMutex::unlock() {
+    SyncWaiter next;
+    {
+        SpinLock::Lock lock(m_mutex);
+        IM_ASSERT(m_locked);
+        if (m_waiters.empty()) {
+            m_locked = false;
+            return;
+        }
+        next = std::move(m_waiters.front());
+        m_waiters.pop_front();
+    }
+    next.wake();
+}
+
+void CoroutineRWMutex::rdlock() {
+    {
+        SpinLock::Lock lock(m_mutex);
+        if (!m_writer && m_waitWriters.empty()) {
+            ++m_readers;
+            return;
+        }
+    }
+    SyncParker parker;
+    {
+        SpinLock::Lock lock(m_mutex);
+        if (!m_writer && m_waitWriters.empty()) {
+            ++m_readers;
+            return;
+        }
+        m_waitReaders.push_back(parker.waiter());
+    }
+    parker.park();
+}
+
+void CoroutineRWMutex::wrlock() {
+    {
+        SpinLock::Lock lock(m_mutex);
+        if (!m_writer && m_readers == 0) {
+            m_writer = true;
+            return;
+        }
+    }
+    SyncParker parker;
+    {
+        SpinLock::Lock lock(m_mutex);
+        if (!m_writer && m_readers == 0) {
+            m_writer = true;
+            return;
+        }
+        m_waitWriters.push_back(parker.waiter());
+    }
+    parker.park();
+}
+
+void CoroutineRWMutex::unlock() {
+    std::list<SyncWaiter> wakes;
+    {
+        SpinLock::Lock lock(m_mutex);
+        bool writer = m_writer;
+        if (writer) {
+            m_writer = false;
+        } else {
+            IM_ASSERT(m_readers > 0);
+            if (--m_readers > 0) {
+                return;
+            }
+        }
+        // 写锁释放时优先放行所有排队的读者；最后一个读者释放时交给下一个写者(读者是因写者排队才等待的)
+        if (!m_waitReaders.empty() && (writer || m_waitWriters.empty())) {
+            m_readers = m_waitReaders.size();
+            wakes.swap(m_waitReaders);
+        } else if (!m_waitWriters.empty()) {
+            m_writer = true;
+            wakes.splice(wakes.end(), m_waitWriters, m_waitWriters.begin());
+        }
+    }
+    for (auto &i : wakes) {
+        i.wake();
+    }
+}
+
+void CoroutineCondition::wait(CoroutineMutex::Lock &lock) {
+    SyncParker parker;
+    {
+        SpinLock::Lock guard(m_mutex);
+        m_waiters.push_back(parker.waiter());
+    }
+    lock.unlock();
+    parker.park();
+    lock.lock();
+}
+
+void CoroutineCondition::notifyOne() {
+    SyncWaiter next;
+    {
+        SpinLock::Lock lock(m_mutex);
+        if (m_waiters.empty()) {
+            return;
+        }
+        next = std::move(m_waiters.front());
+        m_waiters.pop_front();
+    }
+    next.wake();
+}
+
+void CoroutineCondition::notifyAll() {
+    std::list<SyncWaiter> wakes;
+    {
+        SpinLock::Lock lock(m_mutex);
+        wakes.swap(m_waiters);
+    }
+    for (auto &i : wakes) {
+        i.wake();
+    }
+}
 }  // namespace IM
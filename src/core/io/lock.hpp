@@ -7,6 +7,10 @@
  * 该文件定义了多种线程同步锁的封装，包括互斥锁、读写锁、自旋锁和原子锁等，
  * 并提供了RAII风格的锁管理器模板，确保锁的自动获取和释放，防止死锁和忘记释放锁的问题。
  * 所有锁类都继承自Noncopyable，禁止拷贝构造和赋值操作，确保锁的安全性。
+ *
+ * Mutex/RWMutex/SpinLock 竞争时阻塞整个线程，线程上的其他协程也随之停顿。
+ * CoroutineMutex/CoroutineRWMutex/CoroutineCondition 竞争时只挂起当前协程，由释放方投递回调度器；
+ * 在普通线程(非调度器协程)中使用时退化为阻塞在信号量上。临界区很短且不会让出时仍应优先使用 Mutex。
  */
 
 #ifndef __IM_IO_LOCK_HPP__
@@ -17,6 +21,7 @@
 #include <pthread.h>
 
 #include "core/base/noncopyable.hpp"
+#include "core/io/semaphore.hpp"
 
 #include "coroutine.hpp"
 
@@ -285,6 +290,156 @@ class CoroutineSemaphore : Noncopyable {
     std::list<std::pair<Scheduler *, Coroutine::ptr>> m_waiters;
     size_t m_concurrency;
 };
+
+/**
+ * @brief 协程同步原语的等待者，由唤醒方保存
+ */
+struct SyncWaiter {
+    Scheduler *scheduler = nullptr;  ///< 挂起协程所在的调度器
+    Coroutine::ptr coroutine;        ///< 挂起的协程
+    Semaphore *sem = nullptr;        ///< 普通线程等待时使用的信号量(位于等待线程栈上)
+
+    /**
+     * @brief 唤醒等待者：协程投递回调度器，线程通知信号量
+     */
+    void wake();
+};
+
+/**
+ * @brief 同时登记在多个等待队列上的一次等待(如 select 多个通道、等待多个 Future)，由所有等待源共享
+ * @details 等待源通过 tryFire 竞争完成本次等待，只有成功者负责唤醒等待者
+ */
+struct SyncWaitState {
+    SyncWaiter waiter;              ///< 等待者
+    std::atomic<int> fired = {-1};  ///< 完成本次等待的等待源下标，-1表示尚未完成
+
+    /**
+     * @brief 尝试以指定等待源完成本次等待，只有第一个调用者成功
+     */
+    bool tryFire(int index) {
+        int expected = -1;
+        return fired.compare_exchange_strong(expected, index, std::memory_order_acq_rel);
+    }
+};
+
+/**
+ * @brief 当前执行流的挂起器
+ * @details 先通过 waiter() 生成等待者登记到等待队列，释放保护等待队列的锁后调用 park() 挂起。
+ *          唤醒可能发生在 park() 之前：协程会在真正让出后才被调度器换入，信号量则保留计数，不会丢失唤醒。
+ */
+class SyncParker : Noncopyable {
+   public:
+    SyncParker();
+
+    /**
+     * @brief 是否在调度器协程中(可以挂起协程而不阻塞线程)
+     */
+    static bool InCoroutine();
+
+    /**
+     * @brief 生成指向当前执行流的等待者
+     */
+    SyncWaiter waiter();
+
+    /**
+     * @brief 挂起直到对应的等待者被唤醒
+     */
+    void park();
+
+    /**
+     * @brief 带超时的挂起，超时由 state 的 timeout_index 分支完成
+     * @param[in] state 等待状态，其 waiter 须由本挂起器生成
+     * @param[in] timeout_ms 超时时间(毫秒)，~0ull 表示不超时
+     * @param[in] timeout_index 超时时写入 state->fired 的下标
+     * @note 协程运行在 IOManager 上时由其定时器超时；运行在普通 Scheduler 上时由进程内共享的
+     *       定时器线程超时，精度与该线程的调度有关
+     */
+    void park(const std::shared_ptr<SyncWaitState> &state, uint64_t timeout_ms, int timeout_index);
+
+   private:
+    bool m_coroutine;  ///< 是否在调度器协程中
+    Semaphore m_sem;   ///< 线程等待使用的信号量
+};
+
+/**
+ * @brief 协程互斥锁
+ * @details 竞争时挂起协程而不是线程。解锁时若有等待者，锁直接移交给最早的等待者(FIFO，不允许插队)。
+ */
+class CoroutineMutex : Noncopyable {
+   public:
+    using Lock = ScopedLockImpl<CoroutineMutex>;
+
+    /**
+     * @brief 尝试加锁，不等待
+     */
+    bool tryLock();
+    void lock();
+    void unlock();
+
+   private:
+    SpinLock m_mutex;                 ///< 保护状态与等待队列
+    bool m_locked = false;            ///< 是否已被持有
+    std::list<SyncWaiter> m_waiters;  ///< 等待者
+};
+
+/**
+ * @brief 协程读写锁
+ * @details 有写者等待时新的读者排队，防止写者饿死；写锁释放时优先放行所有排队的读者，防止读者饿死。
+ *          锁直接移交给被唤醒的等待者。
+ */
+class CoroutineRWMutex : Noncopyable {
+   public:
+    using ReadLock = ReadScopedLockImpl<CoroutineRWMutex>;
+    using WriteLock = WriteScopedLockImpl<CoroutineRWMutex>;
+
+    void rdlock();
+    void wrlock();
+    void unlock();
+
+   private:
+    SpinLock m_mutex;                     ///< 保护状态与等待队列
+    uint32_t m_readers = 0;               ///< 持有读锁的数量
+    bool m_writer = false;                ///< 是否有写者持有
+    std::list<SyncWaiter> m_waitReaders;  ///< 等待的读者
+    std::list<SyncWaiter> m_waitWriters;  ///< 等待的写者
+};
+
+/**
+ * @brief 协程条件变量，配合 CoroutineMutex 使用
+ */
+class CoroutineCondition : Noncopyable {
+   public:
+    /**
+     * @brief 释放锁并等待通知，返回前重新加锁
+     * @param[in] lock 已持有的锁
+     * @note 可能虚假唤醒，调用方应在循环中检查条件
+     */
+    void wait(CoroutineMutex::Lock &lock);
+
+    /**
+     * @brief 等待直到条件成立
+     */
+    template <class Pred>
+    void wait(CoroutineMutex::Lock &lock, Pred pred) {
+        while (!pred()) {
+            wait(lock);
+        }
+    }
+
+    /**
+     * @brief 唤醒一个等待者
+     */
+    void notifyOne();
+
+    /**
+     * @brief 唤醒所有等待者
+     */
+    void notifyAll();
+
+   private:
+    SpinLock m_mutex;                 ///< 保护等待队列
+    std::list<SyncWaiter> m_waiters;  ///< 等待者
+};
 }  // namespace IM
 
 #endif  // __IM_IO_LOCK_HPP__
\ No newline at end of file
@@ -1,19 +1,192 @@
 #include "core/io/scheduler.hpp"
 
+#include <algorithm>
+
 #include "core/base/macro.hpp"
+#include "core/config/config.hpp"
 #include "core/net/core/hook.hpp"
 
 namespace IM {
 static auto g_logger = IM_LOG_NAME("system");
 
+// 定义配置项--是否启用工作窃取调度--默认关闭
+static auto g_scheduler_work_stealing =
+    Config::Lookup<bool>("scheduler.work_stealing", false, "scheduler per-thread run queues with work stealing");
+
+// 定义配置项--是否采集调度器运行时指标--默认关闭
+static auto g_scheduler_metrics =
+    Config::Lookup<bool>("scheduler.metrics", false, "scheduler queue wait/run time histograms and counters");
+
+// 定义配置项--较低优先级有任务等待时，较高优先级最多连续被调度的次数--默认16
+static auto g_scheduler_priority_burst = Config::Lookup<uint32_t>(
+    "scheduler.priority_burst", 16, "max consecutive higher-priority picks while a lower priority class is waiting");
+
+// 所有存活的调度器，供状态页遍历
+static Mutex &GetSchedulersMutex() {
+    static Mutex s_mutex;
+    return s_mutex;
+}
+static std::vector<Scheduler *> &GetSchedulers() {
+    static std::vector<Scheduler *> s_schedulers;
+    return s_schedulers;
+}
+
 // 当前线程的调度器对象
 static thread_local Scheduler *t_scheduler = nullptr;
 // 当前线程的协程对象
 static thread_local Coroutine *t_coroutine = nullptr;
+// 当前线程正在执行run方法的调度器(用于识别信箱与本地队列归属)
+static thread_local Scheduler *t_worker_scheduler = nullptr;
+// 当前线程在所属调度器中的下标(信箱与本地队列下标)
+static thread_local int t_worker_index = -1;
+
+// 任务节点缓存：线程本地缓存无锁分配/归还，超出上限或耗尽时与全局缓存批量交换
+static const size_t kTaskCacheBatch = 64;        // 与全局缓存每次交换的节点数
+static const size_t kTaskCacheLocalMax = 256;    // 线程本地缓存上限
+static const size_t kTaskCacheGlobalMax = 4096;  // 全局缓存上限，超出的节点直接释放
+
+// 节点通过 next 指针串成单链表
+struct TaskFreeList {
+    void *head = nullptr;
+    size_t count = 0;
+};
+
+// 线程本地缓存(平凡析构，线程退出时由 t_task_cache_guard 归还)
+static thread_local TaskFreeList t_task_cache;
+// 线程本地缓存是否已关闭，线程退出阶段的归还直接释放
+static thread_local bool t_task_cache_closed = false;
+
+static Mutex &GetTaskCacheMutex() {
+    static Mutex s_mutex;
+    return s_mutex;
+}
+static TaskFreeList &GetTaskCache() {
+    static TaskFreeList s_cache;
+    return s_cache;
+}
+
+Scheduler::Task *Scheduler::AllocTask() {
+    TaskFreeList &local = t_task_cache;
+    if (!local.head && !t_task_cache_closed) {
+        // 从全局缓存批量补充
+        Mutex::Lock lock(GetTaskCacheMutex());
+        TaskFreeList &global = GetTaskCache();
+        for (size_t i = 0; i < kTaskCacheBatch && global.head; ++i) {
+            Task *task = static_cast<Task *>(global.head);
+            global.head = task->next;
+            --global.count;
+            task->next = static_cast<Task *>(local.head);
+            local.head = task;
+            ++local.count;
+        }
+    }
+    if (!local.head) {
+        return new Task;
+    }
+    Task *task = static_cast<Task *>(local.head);
+    local.head = task->next;
+    --local.count;
+    task->next = nullptr;
+    return task;
+}
+
+void Scheduler::FreeTask(Task *task) {
+    // 先释放协程与回调，其析构过程可能再次调度任务
+    task->reset();
+    if (t_task_cache_closed) {
+        delete task;
+        return;
+    }
 
-Scheduler::Scheduler(size_t threads, bool use_caller, const std::string &name) : m_name(name) {
+    // 线程退出时把本地缓存归还全局缓存
+    struct CacheGuard {
+        ~CacheGuard() {
+            t_task_cache_closed = true;
+            TaskFreeList &local = t_task_cache;
+            while (local.head) {
+                Task *task = static_cast<Task *>(local.head);
+                local.head = task->next;
+                FreeToGlobal(task);
+            }
+            local.count = 0;
+        }
+        static void FreeToGlobal(Task *task) {
+            Mutex::Lock lock(GetTaskCacheMutex());
+            TaskFreeList &global = GetTaskCache();
+            if (global.count >= kTaskCacheGlobalMax) {
+                lock.unlock();
+                delete task;
+                return;
+            }
+            task->next = static_cast<Task *>(global.head);
+            global.head = task;
+            ++global.count;
+        }
+    };
+    static thread_local CacheGuard t_task_cache_guard;
+    (void)t_task_cache_guard;
+
+    TaskFreeList &local = t_task_cache;
+    task->next = static_cast<Task *>(local.head);
+    local.head = task;
+    if (++local.count <= kTaskCacheLocalMax) {
+        return;
+    }
+
+    // 本地缓存过多，批量归还全局缓存
+    Task *batch = nullptr;
+    for (size_t i = 0; i < kTaskCacheBatch; ++i) {
+        Task *node = static_cast<Task *>(local.head);
+        local.head = node->next;
+        node->next = batch;
+        batch = node;
+    }
+    local.count -= kTaskCacheBatch;
+    Mutex::Lock lock(GetTaskCacheMutex());
+    TaskFreeList &global = GetTaskCache();
+    while (batch) {
+        Task *node = batch;
+        batch = node->next;
+        if (global.count >= kTaskCacheGlobalMax) {
+            delete node;
+            continue;
+        }
+        node->next = static_cast<Task *>(global.head);
+        global.head = node;
+        ++global.count;
+    }
+}
+
+Scheduler::Scheduler(size_t threads, bool use_caller, const std::string &name, const ThreadAffinity &affinity)
+    : m_name(name), m_affinity(affinity) {
     IM_ASSERT(threads > 0);
 
+    // 为每个工作线程(包括调用线程)准备一个专属信箱
+    m_mailboxes.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        m_mailboxes.emplace_back(new Mailbox);
+    }
+
+    // 工作窃取模式：为每个工作线程(包括调用线程)准备一个本地队列
+    m_workStealing = g_scheduler_work_stealing->getValue();
+    if (m_workStealing) {
+        m_workQueues.reserve(threads);
+        for (size_t i = 0; i < threads; ++i) {
+            m_workQueues.emplace_back(new WorkQueue);
+        }
+    }
+
+    m_priorityBurst = std::max<uint32_t>(1, g_scheduler_priority_burst->getValue());
+
+    if (g_scheduler_metrics->getValue()) {
+        m_metrics.reset(new SchedulerMetrics(threads));
+    }
+
+    {
+        Mutex::Lock lock(GetSchedulersMutex());
+        GetSchedulers().push_back(this);
+    }
+
     // 如果使用调用线程，则将当前线程作为调度线程之一
     if (use_caller) {
         Coroutine::GetThis();  // 初始化当前线程的主协程
@@ -36,6 +209,11 @@ Scheduler::Scheduler(size_t threads, bool use_caller, const std::string &name) :
 
 Scheduler::~Scheduler() {
     IM_ASSERT(!m_isRunning);
+    {
+        Mutex::Lock lock(GetSchedulersMutex());
+        auto &schedulers = GetSchedulers();
+        schedulers.erase(std::remove(schedulers.begin(), schedulers.end(), this), schedulers.end());
+    }
     if (GetThis() == this) {
         t_scheduler = nullptr;
     }
@@ -56,6 +234,223 @@ bool Scheduler::hasIdleThreads() {
     return m_idleThreadCount > 0;
 }
 
+bool Scheduler::isWorkerThread() const {
+    return t_worker_scheduler == this;
+}
+
+int Scheduler::getWorkerIndex() const {
+    return isWorkerThread() ? t_worker_index : -1;
+}
+
+void Scheduler::wakeWorker(int index) {
+    Mailbox &mailbox = *m_mailboxes[index];
+    // 属主线程尚未进入run时，进入后自然会检查一遍
+    if (mailbox.threadId == -1) {
+        return;
+    }
+    // 投递一个空任务：信箱非空才能让误唤醒的线程把唤醒传递给属主线程
+    Task *task = AllocTask();
+    task->assign([] {}, -1);
+    if (pushMailbox(mailbox, task)) {
+        tickle();
+    }
+}
+
+Scheduler::Mailbox *Scheduler::getMailbox(uint64_t tid) {
+    // 工作线程数量很少，线性查找即可，与队列长度无关
+    for (auto &mailbox : m_mailboxes) {
+        if (mailbox->threadId == (pid_t)tid) {
+            return mailbox.get();
+        }
+    }
+    return nullptr;
+}
+
+size_t Scheduler::getQueueDepth() {
+    size_t depth = m_localTaskCount;
+    for (auto &mailbox : m_mailboxes) {
+        depth += mailbox->tasks.size();
+    }
+    MutexType::Lock lock(m_mutex);
+    for (auto &queue : m_taskQueue) {
+        depth += queue.size();
+    }
+    return depth;
+}
+
+size_t Scheduler::getQueueDepth(Priority priority) {
+    MutexType::Lock lock(m_mutex);
+    return m_taskQueue[priority].size();
+}
+
+void Scheduler::Visit(std::function<void(Scheduler *)> cb) {
+    Mutex::Lock lock(GetSchedulersMutex());
+    for (auto scheduler : GetSchedulers()) {
+        cb(scheduler);
+    }
+}
+
+bool Scheduler::enqueue(Task *task) {
+    if (m_metrics) {
+        task->enqueueTs = SchedulerMetrics::Now();
+        m_metrics->onEnqueue(getWorkerIndex());
+    }
+    if (task->threadId != -1) {
+        // 指定线程的任务直接投递到目标线程信箱
+        Mailbox *mailbox = getMailbox(task->threadId);
+        if (mailbox) {
+            return pushMailbox(*mailbox, task);
+        }
+    } else if (m_workStealing && isWorkerThread() && task->priority == Priority::NORMAL) {
+        // 工作窃取模式下，工作线程自身产生的普通任务直接进入本地队列，不竞争全局锁；
+        // 其他优先级进入全局队列，由全局的优先级与防饥饿规则统一调度
+        return pushLocal(task);
+    }
+    MutexType::Lock lock(m_mutex);
+    return pushGlobalLocked(task);
+}
+
+bool Scheduler::pushGlobalLocked(Task *task) {
+    // 如果队列为空，工作线程可能处于空闲状态，需要主动唤醒以处理新任务
+    bool need_tickle = globalEmptyLocked();
+    m_taskQueue[task->priority].push_back(task);
+    if (task->priority == Priority::HIGH) {
+        ++m_highTaskCount;
+    }
+    return need_tickle;
+}
+
+bool Scheduler::globalEmptyLocked() const {
+    for (auto &queue : m_taskQueue) {
+        if (!queue.empty()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Scheduler::Task *Scheduler::popGlobalLocked(bool &tickle_me) {
+    // 较低优先级是否有任务等待
+    auto lower_waiting = [this](int priority) {
+        for (int i = priority + 1; i < Priority::PRIORITY_COUNT; ++i) {
+            if (!m_taskQueue[i].empty()) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    // 确定本轮的检查顺序：按优先级从高到低，连续被选中次数已达上限且较低优先级有任务等待的排到最后
+    int order[Priority::PRIORITY_COUNT];
+    int count = 0;
+    int deferred[Priority::PRIORITY_COUNT];
+    int deferred_count = 0;
+    for (int i = 0; i < Priority::PRIORITY_COUNT; ++i) {
+        if (m_taskQueue[i].empty()) {
+            continue;
+        }
+        if (m_priorityStreak[i] >= m_priorityBurst && lower_waiting(i)) {
+            deferred[deferred_count++] = i;
+        } else {
+            order[count++] = i;
+        }
+    }
+    for (int i = 0; i < deferred_count; ++i) {
+        order[count++] = deferred[i];
+    }
+
+    for (int i = 0; i < count; ++i) {
+        int priority = order[i];
+        ds::IntrusiveList<Task> &queue = m_taskQueue[priority];
+        Task *it = queue.front();
+        while (it) {
+            // 当前任务指定了执行线程，且该线程不是当前线程，则跳过该任务，并标记为需要通知其他线程
+            if (it->threadId != -1 && it->threadId != GetThreadId()) {
+                it = queue.Next(it);
+                tickle_me = true;
+                continue;
+            }
+
+            IM_ASSERT(it->coroutine || it->cb);
+
+            // 如果it中保存的是协程，并且正在执行中，则跳过
+            if (it->coroutine && it->coroutine->getState() == Coroutine::State::EXEC) {
+                it = queue.Next(it);
+                continue;
+            }
+
+            // 取出任务，更新连续选中计数：较高优先级的计数清零(它们刚让出过一次或没有任务)
+            queue.erase(it);
+            if (priority == Priority::HIGH) {
+                --m_highTaskCount;
+            }
+            m_priorityStreak[priority] = lower_waiting(priority) ? m_priorityStreak[priority] + 1 : 0;
+            for (int k = 0; k < priority; ++k) {
+                m_priorityStreak[k] = 0;
+            }
+            return it;
+        }
+    }
+    return nullptr;
+}
+
+bool Scheduler::pushMailbox(Mailbox &mailbox, Task *task) {
+    mailbox.tasks.push(task);
+    // 投递到自己的信箱(例如在idle中)无需唤醒，回到调度循环时自然会取出
+    if (isWorkerThread() && m_mailboxes[t_worker_index].get() == &mailbox) {
+        return false;
+    }
+    // 与run中设置idle后再检查信箱的顺序配对，保证不会丢失唤醒
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return mailbox.idle;
+}
+
+bool Scheduler::hasPendingMailbox() {
+    for (size_t i = 0; i < m_mailboxes.size(); ++i) {
+        if ((int)i != t_worker_index && m_mailboxes[i]->idle && !m_mailboxes[i]->tasks.empty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Scheduler::pushLocal(Task *task) {
+    WorkQueue &queue = *m_workQueues[t_worker_index];
+    bool need_tickle = false;
+    {
+        WorkQueue::MutexType::Lock lock(queue.mutex);
+        // 本地队列由空变为非空时，唤醒空闲线程前来窃取
+        need_tickle = queue.tasks.empty();
+        queue.tasks.push_back(task);
+    }
+    ++m_localTaskCount;
+    return need_tickle;
+}
+
+Scheduler::Task *Scheduler::popLocal() {
+    WorkQueue &queue = *m_workQueues[t_worker_index];
+    WorkQueue::MutexType::Lock lock(queue.mutex);
+    Task *task = queue.tasks.pop_back();
+    if (task) {
+        --m_localTaskCount;
+    }
+    return task;
+}
+
+Scheduler::Task *Scheduler::steal() {
+    size_t count = m_workQueues.size();
+    for (size_t i = 1; i < count; ++i) {
+        WorkQueue &victim = *m_workQueues[(t_worker_index + i) % count];
+        WorkQueue::MutexType::Lock lock(victim.mutex);
+        Task *task = victim.tasks.pop_front();
+        if (task) {
+            --m_localTaskCount;
+            return task;
+        }
+    }
+    return nullptr;
+}
+
 Coroutine *Scheduler::GetMainCoroutine() {
     return t_coroutine;
 }
@@ -73,7 +468,8 @@ void Scheduler::start() {
     m_threads.resize(m_threadCount);  // 提前分配内存
     for (size_t i = 0; i < m_threadCount; ++i) {
         // 创建工作线程，绑定调度器的run方法作为线程执行函数
-        m_threads[i].reset(new Thread(std::bind(&Scheduler::run, this), m_name + "_" + std::to_string(i)));
+        m_threads[i].reset(new Thread(std::bind(&Scheduler::run, this), m_name + "_" + std::to_string(i),
+                                      m_affinity.forThread(i)));
         m_threadIds.push_back(m_threads[i]->getId());
     }
 
@@ -142,6 +538,10 @@ void Scheduler::stop() {
 
 void Scheduler::switchTo(int thread) {
     IM_ASSERT(Scheduler::GetThis() != nullptr);
+    // 共享栈协程的栈快照只能在绑定线程的共享栈上恢复，不能迁移到其他调度器或线程
+    IM_ASSERT2(Coroutine::GetThis()->getBoundThread() == -1 ||
+                   (Scheduler::GetThis() == this && (thread == -1 || thread == IM::GetThreadId())),
+               "shared-stack coroutine cannot switch scheduler");
     if (Scheduler::GetThis() == this) {
         if (thread == -1 || thread == IM::GetThreadId()) {
             return;
@@ -157,12 +557,21 @@ void Scheduler::tickle() {
 
 bool Scheduler::stopping() {
     MutexType::Lock lock(m_mutex);
-    return m_autoStop && m_taskQueue.empty() && !m_isRunning && m_activeThreadCount == 0;
+    if (!(m_autoStop && globalEmptyLocked() && m_localTaskCount == 0 && !m_isRunning && m_activeThreadCount == 0)) {
+        return false;
+    }
+    for (auto &mailbox : m_mailboxes) {
+        if (!mailbox->tasks.empty()) {
+            return false;
+        }
+    }
+    return true;
 }
 
 void Scheduler::idle() {
     IM_LOG_INFO(g_logger) << "thread idle";
     while (!stopping()) {
+        PooledStackAllocator::Trim();
         Coroutine::YieldToHold();
     }
 }
@@ -173,6 +582,13 @@ void Scheduler::run() {
 
     setThis();  // 设置当前线程的调度器实例
 
+    // 认领信箱(工作窃取模式下同时认领同下标的本地队列)
+    t_worker_index = m_nextWorkerIndex++;
+    IM_ASSERT(t_worker_index < (int)m_mailboxes.size());
+    t_worker_scheduler = this;
+    Mailbox &mailbox = *m_mailboxes[t_worker_index];
+    mailbox.threadId = GetThreadId();
+
     // 创建工作线程的主协程
     if (GetThreadId() != m_rootThreadId) {
         t_coroutine = Coroutine::GetThis().get();
@@ -186,42 +602,68 @@ void Scheduler::run() {
     Coroutine::ptr cb_coroutine;
 
     // 存储从协程队列中取出的协程或回调任务
-    Task task;
+    Task *task = nullptr;
+    // 本线程的指标分片，未开启时为空
+    WorkerMetrics *worker_metrics = m_metrics ? &m_metrics->worker(t_worker_index) : nullptr;
+    // 本次任务开始执行的时间
+    uint64_t run_begin = 0;
 
     while (true) {
         // ==========任务获取阶段==========
-        task.reset();            // 清除上一次循环中保存的任务，确保当前循环处理的是新任务
-        bool tickle_me = false;  // 是否需要通知其他线程
-        bool is_active = false;  // 线程是否处于活动状态
-        {
-            // 加锁访问协程队列
-            MutexType::Lock lock(m_mutex);
-            auto it = m_taskQueue.begin();
-            while (it != m_taskQueue.end()) {
-                // 当前任务指定了执行线程，且该线程不是当前线程，则跳过该任务，并标记为需要通知其他线程
-                if (it->threadId != -1 && it->threadId != GetThreadId()) {
-                    ++it;
-                    tickle_me = true;
-                    continue;
-                }
-
-                IM_ASSERT(it->coroutine || it->cb);
+        task = nullptr;           // 上一次循环的任务已经归还或重新入队
+        bool tickle_me = false;   // 是否需要通知其他线程
+        bool is_active = false;   // 线程是否处于活动状态
+        bool from_local = false;  // 任务是否来自信箱、本地队列或窃取
+
+        // 优先处理指定由本线程执行的任务
+        if ((task = mailbox.tasks.pop())) {
+            from_local = true;
+            if (worker_metrics) {
+                worker_metrics->mailboxTasks.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
 
-                // 如果it中保存的是协程，并且正在执行中，则跳过
-                if (it->coroutine && it->coroutine->getState() == Coroutine::State::EXEC) {
-                    ++it;
-                    continue;
-                }
+        // 工作窃取模式：其次从本线程的本地队列尾部取任务(全局队列有高优先级任务时先处理全局队列)
+        bool local_deferred = m_workStealing && m_highTaskCount > 0;
+        if (!from_local && m_workStealing && !local_deferred && (task = popLocal())) {
+            from_local = true;
+        }
 
-                // 取出协程任务
-                task = *it;
-                m_taskQueue.erase(it);
+        if (!from_local) {
+            // 加锁按优先级访问全局队列
+            MutexType::Lock lock(m_mutex);
+            if ((task = popGlobalLocked(tickle_me))) {
                 ++m_activeThreadCount;
                 is_active = true;
-                break;
             }
         }
 
+        // 之前为高优先级任务跳过了本地队列，而全局队列没有本线程可执行的任务时再回到本地队列
+        if (!from_local && !is_active && local_deferred && (task = popLocal())) {
+            from_local = true;
+        }
+
+        // 工作窃取模式：本地与全局队列都没有可执行任务时，从其他线程窃取
+        if (!from_local && !is_active && m_workStealing && (task = steal())) {
+            from_local = true;
+            if (worker_metrics) {
+                worker_metrics->steals.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        if (from_local) {
+            // 协程仍在其他线程上执行(已被唤醒但尚未完成让出)，转入全局队列稍后重试(保留指定线程)
+            if (task->coroutine && task->coroutine->getState() == Coroutine::State::EXEC) {
+                {
+                    MutexType::Lock lock(m_mutex);
+                    pushGlobalLocked(task);
+                }
+                continue;
+            }
+            ++m_activeThreadCount;
+            is_active = true;
+        }
+
         // ==========跨线程通知阶段==========
         // 如果有其他线程需要被唤醒，则触发tickle
         if (tickle_me) {
@@ -229,35 +671,51 @@ void Scheduler::run() {
         }
 
         // ==========任务处理阶段==========
-        if (task.coroutine &&  // 协程类型任务
-            task.coroutine->getState() != Coroutine::State::TERM &&
-            task.coroutine->getState() != Coroutine::State::EXCEPT) {
+        if (worker_metrics && task) {
+            run_begin = SchedulerMetrics::Now();
+            if (task->enqueueTs) {
+                worker_metrics->queueWait.record(run_begin - task->enqueueTs);
+            }
+        }
+        if (task && task->coroutine &&  // 协程类型任务
+            task->coroutine->getState() != Coroutine::State::TERM &&
+            task->coroutine->getState() != Coroutine::State::EXCEPT) {
+            // 取出协程后立即归还任务节点
+            Coroutine::ptr coroutine = std::move(task->coroutine);
+            FreeTask(task);
             // 进入目标协程
-            task.coroutine->swapIn();
+            coroutine->swapIn();
             // 离开目标协程
             --m_activeThreadCount;
-            // 如果协程状态为READY，说明协程主动让出了执行权，但仍需要继续执行，重新加入调度队列
-            if (task.coroutine->getState() == Coroutine::State::READY) {
-                schedule(task.coroutine);
+            if (worker_metrics) {
+                worker_metrics->executed.fetch_add(1, std::memory_order_relaxed);
+                worker_metrics->runTime.record(SchedulerMetrics::Now() - run_begin);
             }
-            // 如果协程未结束且无异常，设置为HOLD状态
-            else if (task.coroutine->getState() != Coroutine::State::TERM &&
-                     task.coroutine->getState() != Coroutine::State::EXCEPT) {
-                task.coroutine->setState(Coroutine::State::HOLD);
+            // 如果协程状态为READY，说明协程主动让出了执行权，但仍需要继续执行，重新加入调度队列
+            // 挂起(HOLD)的协程已由 swapIn 置位，此后可能已被其他线程换入，不能再修改其状态
+            if (coroutine->getState() == Coroutine::State::READY) {
+                schedule(std::move(coroutine));
             }
             // 如果协程是终止状态（TERM）或异常状态（EXCEPT），结束该协程的任务
-        } else if (task.cb)  // 回调函数类型任务
+        } else if (task && task->cb)  // 回调函数类型任务
         {
-            // 回调协程复用
+            // 回调协程复用，回调直接移入协程，随后归还任务节点
             if (cb_coroutine) {
-                cb_coroutine->reset(task.cb);
+                cb_coroutine->reset(std::move(task->cb));
             } else {
-                cb_coroutine.reset(new Coroutine(task.cb));
+                cb_coroutine.reset(new Coroutine(std::move(task->cb)));
             }
+            // 回调执行期间协程继承任务的优先级，挂起后被唤醒时按该优先级入队
+            cb_coroutine->setPriority(task->priority);
+            FreeTask(task);
             // 进入回调函数
             cb_coroutine->swapIn();
             // 离开回调函数
             --m_activeThreadCount;
+            if (worker_metrics) {
+                worker_metrics->executed.fetch_add(1, std::memory_order_relaxed);
+                worker_metrics->runTime.record(SchedulerMetrics::Now() - run_begin);
+            }
 
             // 如果协程状态为READY，重新加入调度队列
             if (cb_coroutine->getState() == Coroutine::State::READY) {
@@ -267,16 +725,18 @@ void Scheduler::run() {
                        cb_coroutine->getState() == Coroutine::State::EXCEPT) {
                 cb_coroutine->reset(nullptr);
             }
-            // 其他情况设置为HOLD状态并重置协程指针
+            // 其他情况(挂起)重置协程指针，协程由等待的事件持有
             else {
-                cb_coroutine->setState(Coroutine::State::HOLD);
                 cb_coroutine.reset();
             }
         }
         // ==========空闲处理阶段==========
         else {
-            // 任务队列不为空，但是没有取到合适的任务
+            // 任务队列不为空，但是没有取到合适的任务(或取到的协程已经结束)
             if (is_active) {
+                if (task) {
+                    FreeTask(task);
+                }
                 --m_activeThreadCount;
                 continue;
             }
@@ -284,12 +744,31 @@ void Scheduler::run() {
             // 空闲协程已经执行完毕
             if (idle_coroutine->getState() == Coroutine::State::TERM) {
                 IM_LOG_INFO(g_logger) << "idle coroutine over";
+                mailbox.threadId = -1;
+                t_worker_scheduler = nullptr;
+                t_worker_index = -1;
                 break;
             }
 
             ++m_idleThreadCount;
+            // 先标记空闲再检查信箱，与pushMailbox配对，避免投递者错过唤醒
+            mailbox.idle = true;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (!mailbox.tasks.empty()) {
+                mailbox.idle = false;
+                --m_idleThreadCount;
+                continue;
+            }
+            // 若本线程是被误唤醒的，把唤醒传递给信箱中有任务的空闲线程
+            if (hasPendingMailbox()) {
+                tickle();
+            }
             idle_coroutine->swapIn();
+            mailbox.idle = false;
             --m_idleThreadCount;
+            if (worker_metrics) {
+                worker_metrics->idleWakeups.fetch_add(1, std::memory_order_relaxed);
+            }
 
             // 如果空闲协程未结束且无异常，设置为HOLD状态
             if (idle_coroutine->getState() != Coroutine::State::EXCEPT &&
@@ -300,6 +779,16 @@ void Scheduler::run() {
     }
 }
 
+PriorityGuard::PriorityGuard(Coroutine::Priority priority) {
+    m_coroutine = Coroutine::GetThis().get();
+    m_previous = m_coroutine->getPriority();
+    m_coroutine->setPriority(priority);
+}
+
+PriorityGuard::~PriorityGuard() {
+    m_coroutine->setPriority(m_previous);
+}
+
 SchedulerSwitcher::SchedulerSwitcher(Scheduler *target) {
     m_caller = Scheduler::GetThis();
     if (target) {
@@ -315,7 +804,10 @@ SchedulerSwitcher::~SchedulerSwitcher() {
 
 std::ostream &Scheduler::dump(std::ostream &os) {
     os << "[Scheduler name=" << m_name << " size=" << m_threadCount << " active_count=" << m_activeThreadCount
-       << " idle_count=" << m_idleThreadCount << " Running=" << m_isRunning << " ]" << std::endl
+       << " idle_count=" << m_idleThreadCount << " Running=" << m_isRunning << " work_stealing=" << m_workStealing
+       << " local_tasks=" << m_localTaskCount << " queue_depth=" << getQueueDepth()
+       << " high=" << getQueueDepth(Priority::HIGH) << " normal=" << getQueueDepth(Priority::NORMAL)
+       << " low=" << getQueueDepth(Priority::LOW) << " ]" << std::endl
        << "    ";
     for (size_t i = 0; i < m_threadIds.size(); ++i) {
         if (i) {
@@ -12,13 +12,19 @@
 #ifndef __IM_IO_SCHEDULER_HPP__
 #define __IM_IO_SCHEDULER_HPP__
 
-#include <list>
+#include <atomic>
+#include <functional>
+#include <type_traits>
 #include <vector>
 
 #include "core/base/noncopyable.hpp"
+#include "core/ds/intrusive_list.hpp"
+#include "core/ds/mpsc_queue.hpp"
 
 #include "coroutine.hpp"
 #include "lock.hpp"
+#include "scheduler_metrics.hpp"
+#include "task_func.hpp"
 #include "thread.hpp"
 
 /*
@@ -90,7 +96,7 @@
    - 保持线程活跃状态
 
 5. 回调协程 (Callback Coroutine):
-   - 用于执行 std::function 回调函数
+   - 用于执行回调函数(TaskFunc)
    - 可复用以减少协程创建开销
    - 执行完回调后根据状态处理后续逻辑
 
@@ -109,6 +115,37 @@
 统一的调度模型:
   所有线程(包括调用线程和工作线程)都执行相同的 run 方法，
   从共享任务队列中竞争获取任务执行，实现了统一的工作线程模型。
+
+工作窃取模式 (scheduler.work_stealing = true):
+  每个工作线程额外拥有一个本地双端队列 (WorkQueue)，共享任务队列退化为全局注入队列。
+  - 工作线程内部 schedule 的任务(未指定线程) 压入本线程本地队列尾部
+  - 本线程从本地队列尾部取任务 (LIFO，缓存友好)
+  - 本地与全局队列都为空时，从其他线程本地队列头部窃取 (FIFO)
+  - 非工作线程提交的任务仍进入全局队列
+
+指定线程的任务 (schedule(cb, tid)):
+  每个工作线程拥有一个专属的无锁 MPSC 信箱 (Mailbox)，指定线程的任务直接投递到目标线程信箱，
+  目标线程每轮调度优先检查自己的信箱，出队 O(1)，其他线程无需扫描跳过这些任务；
+  仅当目标线程空闲时才触发 tickle。目标线程尚未进入 run 时回退到全局队列。
+
+运行时指标 (scheduler.metrics = true):
+  任务入队时记录时间戳，工作线程取出任务时统计排队等待时间，换入换出之间统计运行时间，
+  连同投递/执行/tickle/空闲唤醒/窃取计数一起写入本线程的指标分片(见 SchedulerMetrics)。
+  所有调度器登记在全局列表中，状态页通过 Scheduler::Visit 遍历输出。
+
+任务表示:
+  任务(Task)是侵入式链表节点，回调保存在小对象优化的 TaskFunc 中(48 字节内联存储，只移动)，
+  全局/本地队列是侵入式双向链表，信箱是侵入式 MPSC 队列，入队出队都不分配内存。
+  Task 节点由线程本地缓存回收复用(批量与全局缓存交换)，常见的 lambda/bind 回调在稳态下
+  schedule + 执行全程零堆分配；回调协程通过 reset 复用，回调也以 TaskFunc 形式移动进协程。
+
+优先级 (Coroutine::Priority):
+  全局队列按优先级分为 HIGH/NORMAL/LOW 三条，工作线程取任务时先取高优先级队列。
+  协程任务默认按协程自身的优先级入队，因此挂起在 IO/定时器/同步原语上的协程被唤醒时保持原优先级；
+  回调任务默认 NORMAL，执行回调的协程在执行期间继承任务的优先级。
+  防饥饿：较低优先级队列非空时，较高优先级连续被取 scheduler.priority_burst 次后让出一次给较低优先级。
+  工作窃取模式下只有 NORMAL 任务进入本地队列；全局队列中有 HIGH 任务时先于本地队列处理。
+  指定线程的任务仍走信箱，信箱本身先于所有队列处理。
  */
 
 namespace IM {
@@ -122,14 +159,18 @@ class Scheduler : public Noncopyable {
     using ptr = std::shared_ptr<Scheduler>;
     /// 互斥锁类型定义
     using MutexType = Mutex;
+    /// 调度优先级
+    using Priority = Coroutine::Priority;
 
     /**
      * @brief 构造函数
      * @param[in] threads 线程数量，默认为1
      * @param[in] use_caller 是否使用调用线程作为调度线程，默认为true
      * @param[in] name 调度器名称，默认为空
+     * @param[in] affinity 工作线程的CPU亲和性与NUMA内存策略，不作用于调用线程
      */
-    Scheduler(size_t threads = 1, bool use_caller = true, const std::string &name = "");
+    Scheduler(size_t threads = 1, bool use_caller = true, const std::string &name = "",
+              const ThreadAffinity &affinity = ThreadAffinity());
 
     /**
      * @brief 析构函数
@@ -169,15 +210,33 @@ class Scheduler : public Noncopyable {
      *
      * @param cb 要调度的协程或回调函数
      * @param tid 指定执行该任务的线程ID，默认为-1表示任意线程都可以执行
+     * @details 协程按其自身优先级入队，回调按 NORMAL 入队
      */
     template <class CoroutineOrcb>
     void schedule(CoroutineOrcb cb, uint64_t tid = -1) {
-        bool need_tickle = false;  // 用于标记是否需要唤醒工作线程
-        {
-            MutexType::Lock lock(m_mutex);
-            need_tickle = scheduleNolock(cb, tid);
+        Priority priority = DefaultPriority(cb);
+        schedule(std::move(cb), tid, priority);
+    }
+
+    /**
+     * @brief 按指定优先级调度单个协程或回调函数
+     *
+     * @param cb 要调度的协程或回调函数
+     * @param tid 指定执行该任务的线程ID，-1表示任意线程都可以执行
+     * @param priority 调度优先级
+     */
+    template <class CoroutineOrcb>
+    void schedule(CoroutineOrcb cb, uint64_t tid, Priority priority) {
+        // 共享栈协程只能回到绑定的线程上恢复执行
+        tid = PinnedThread(cb, tid);
+        Task *task = AllocTask();
+        task->assign(std::move(cb), tid);
+        task->priority = priority;
+        if (!task->coroutine && !task->cb) {
+            FreeTask(task);
+            return;
         }
-        if (need_tickle) {
+        if (enqueue(task)) {
             tickle();  // 唤醒工作线程
         }
     }
@@ -191,11 +250,24 @@ class Scheduler : public Noncopyable {
     template <class InputIterator>
     void schedule(InputIterator begin, InputIterator end) {
         bool need_tickle = false;  // 用于标记是否需要唤醒工作线程
-        {
+        if (m_workStealing && isWorkerThread()) {
+            while (begin != end) {
+                Task *task = AllocTask();
+                Priority priority = DefaultPriority(&*begin);
+                task->assign(&*begin, PinnedThread(&*begin, -1));
+                task->priority = priority;
+                if (task->coroutine || task->cb) {
+                    need_tickle = enqueue(task) || need_tickle;
+                } else {
+                    FreeTask(task);
+                }
+                ++begin;
+            }
+        } else {
             MutexType::Lock lock(m_mutex);
             while (begin != end) {
                 // 将每个任务通过scheduleNolock添加到调度队列
-                need_tickle = scheduleNolock(&*begin, -1) || need_tickle;
+                need_tickle = scheduleNolock(&*begin, PinnedThread(&*begin, -1)) || need_tickle;
                 ++begin;
             }
         }
@@ -217,6 +289,55 @@ class Scheduler : public Noncopyable {
      */
     std::ostream &dump(std::ostream &os);
 
+    /**
+     * @brief 是否启用工作窃取模式
+     * @return bool true表示启用
+     */
+    bool isWorkStealing() const { return m_workStealing; }
+
+    /**
+     * @brief 工作线程数量(包括调用线程)
+     */
+    size_t getWorkerCount() const { return m_mailboxes.size(); }
+
+    /**
+     * @brief 正在执行任务的线程数
+     */
+    size_t getActiveThreadCount() const { return m_activeThreadCount; }
+
+    /**
+     * @brief 空闲等待中的线程数
+     */
+    size_t getIdleThreadCount() const { return m_idleThreadCount; }
+
+    /**
+     * @brief 工作线程的CPU亲和性与NUMA内存策略
+     */
+    const ThreadAffinity &getAffinity() const { return m_affinity; }
+
+    /**
+     * @brief 获取运行时指标
+     * @return SchedulerMetrics* 未开启 scheduler.metrics 时返回nullptr
+     */
+    SchedulerMetrics *getMetrics() const { return m_metrics.get(); }
+
+    /**
+     * @brief 当前排队中的任务数(全局队列 + 本地队列 + 各线程信箱)
+     */
+    size_t getQueueDepth();
+
+    /**
+     * @brief 全局队列中指定优先级的任务数
+     */
+    size_t getQueueDepth(Priority priority);
+
+    /**
+     * @brief 遍历所有存活的调度器
+     * @details 遍历期间持有全局列表的锁，调度器在此期间不会析构
+     * @param[in] cb 回调函数
+     */
+    static void Visit(std::function<void(Scheduler *)> cb);
+
    protected:
     /**
      * @brief 唤醒空闲线程
@@ -250,6 +371,24 @@ class Scheduler : public Noncopyable {
      */
     bool hasIdleThreads();
 
+    /**
+     * @brief 判断当前线程是否为本调度器的工作线程
+     * @return bool true表示当前线程正在执行本调度器的run方法
+     */
+    bool isWorkerThread() const;
+
+    /**
+     * @brief 当前线程在本调度器中的工作线程下标
+     * @return int 下标，当前线程不是本调度器的工作线程时返回-1
+     */
+    int getWorkerIndex() const;
+
+    /**
+     * @brief 唤醒指定下标的工作线程，使其重新进入调度循环
+     * @param[in] index 工作线程下标
+     */
+    void wakeWorker(int index);
+
    private:
     /**
      * @brief 用于在不加锁的情况下将协程或回调函数添加到调度队列中
@@ -263,73 +402,223 @@ class Scheduler : public Noncopyable {
     bool scheduleNolock(CoroutineOrCb cb, uint64_t tid) {
         // 如果队列不为空，说明有其他任务正在等待处理，工作线程应该已经在运行或即将运行
         // 如果队列为空，工作线程可能处于空闲状态，需要主动唤醒以处理新任务
-        bool need_tickle = m_taskQueue.empty();
-        Task task(cb, tid);
-        if (task.coroutine || task.cb) {
-            m_taskQueue.push_back(task);
+        bool need_tickle = false;
+        Priority priority = DefaultPriority(cb);
+        Task *task = AllocTask();
+        task->assign(std::move(cb), tid);
+        task->priority = priority;
+        if (task->coroutine || task->cb) {
+            if (m_metrics) {
+                task->enqueueTs = SchedulerMetrics::Now();
+                m_metrics->onEnqueue(getWorkerIndex());
+            }
+            need_tickle = pushGlobalLocked(task);
+        } else {
+            FreeTask(task);
         }
         return need_tickle;
     }
 
-   private:
     /**
-     * @brief 协程和线程的封装结构体
-     * @details 用于封装待执行的协程或回调函数及其指定执行线程的信息
+     * @brief 共享栈协程已绑定线程时，未指定线程的调度改为投递到绑定线程
+     * @param[in] c 协程
+     * @param[in] tid 调用方指定的线程ID
+     * @return uint64_t 实际执行线程ID
      */
-    struct Task {
-        Coroutine::ptr coroutine;  ///< 协程智能指针，存储待执行的协程对象
-        std::function<void()> cb;  ///< 回调函数，存储待执行的普通函数对象
-        pid_t threadId;            ///< 线程ID，指定该任务应在哪个线程上执行，-1表示任意线程
+    static uint64_t PinnedThread(const Coroutine::ptr &c, uint64_t tid) {
+        if ((pid_t)tid == -1 && c && c->getBoundThread() != -1) {
+            return c->getBoundThread();
+        }
+        return tid;
+    }
 
-        /**
-         * @brief 构造函数，使用协程指针和线程ID初始化
-         * @param[in] c 协程智能指针
-         * @param[in] tid 线程ID
-         */
-        Task(Coroutine::ptr c, uint64_t tid) : coroutine(c), threadId(tid) {}
+    static uint64_t PinnedThread(Coroutine::ptr *c, uint64_t tid) { return PinnedThread(*c, tid); }
 
-        /**
-         * @brief 构造函数，使用协程指针引用和线程ID初始化
-         * @param[in] c 协程智能指针引用
-         * @param[in] tid 线程ID
-         */
-        Task(Coroutine::ptr *c, uint64_t tid) : threadId(tid) { coroutine.swap(*c); }
+    template <class T>
+    static uint64_t PinnedThread(const T &, uint64_t tid) {
+        return tid;
+    }
 
-        /**
-         * @brief 构造函数，使用回调函数和线程ID初始化
-         * @param[in] f 回调函数
-         * @param[in] tid 线程ID
-         */
-        Task(std::function<void()> f, uint64_t tid) : cb(f), threadId(tid) {}
+    /**
+     * @brief 未指定优先级时的默认值：协程沿用自身优先级，回调为 NORMAL
+     */
+    static Priority DefaultPriority(const Coroutine::ptr &c) { return c ? c->getPriority() : Priority::NORMAL; }
 
-        /**
-         * @brief 构造函数，使用回调函数引用和线程ID初始化
-         * @param[in] f 回调函数引用
-         * @param[in] tid 线程ID
-         */
-        Task(std::function<void()> *f, uint64_t tid) : threadId(tid) { cb.swap(*f); }
+    static Priority DefaultPriority(Coroutine::ptr *c) { return DefaultPriority(*c); }
+
+    template <class T>
+    static Priority DefaultPriority(const T &) {
+        return Priority::NORMAL;
+    }
+
+   private:
+    /**
+     * @brief 协程和线程的封装结构体
+     * @details 用于封装待执行的协程或回调函数及其指定执行线程的信息。
+     *          任务节点从线程本地缓存分配并循环使用，自身带有队列链接指针，
+     *          回调使用小对象优化的 TaskFunc，入队出队过程中既不分配内存也不拷贝回调
+     */
+    struct Task {
+        Coroutine::ptr coroutine;                  ///< 协程智能指针，存储待执行的协程对象
+        TaskFunc cb;                               ///< 回调函数，存储待执行的普通函数对象
+        pid_t threadId = -1;                       ///< 线程ID，指定该任务应在哪个线程上执行，-1表示任意线程
+        uint64_t enqueueTs = 0;                    ///< 入队时间(纳秒)，仅开启运行时指标时记录
+        Priority priority = Priority::NORMAL;      ///< 调度优先级
+        Task *prev = nullptr;                      ///< 全局队列/本地队列中的前驱
+        Task *next = nullptr;                      ///< 全局队列/本地队列/空闲缓存中的后继
+        std::atomic<Task *> mpscNext = {nullptr};  ///< 信箱中的后继
 
         /**
-         * @brief 默认构造函数
+         * @brief 设置任务内容
+         * @details 协程指针或回调的指针(批量调度时)会被移走，原对象置空；其余可调用对象移入 TaskFunc
+         * @param[in] cb 协程、回调或它们的指针
+         * @param[in] tid 线程ID
          */
-        Task() : threadId(-1) {}
+        template <class CoroutineOrCb>
+        void assign(CoroutineOrCb &&cb, uint64_t tid) {
+            using Type = typename std::decay<CoroutineOrCb>::type;
+            threadId = tid;
+            if constexpr (std::is_same<Type, Coroutine::ptr>::value) {
+                coroutine = std::forward<CoroutineOrCb>(cb);
+            } else if constexpr (std::is_same<Type, Coroutine::ptr *>::value) {
+                coroutine.swap(*cb);
+            } else if constexpr (std::is_pointer<Type>::value &&
+                                 !std::is_function<typename std::remove_pointer<Type>::type>::value) {
+                this->cb = std::move(*cb);
+                *cb = nullptr;
+            } else {
+                this->cb = std::forward<CoroutineOrCb>(cb);
+            }
+        }
 
         /**
-         * @brief 重置所有成员变量
+         * @brief 清空任务内容，释放持有的协程与回调
          */
         void reset() {
             coroutine = nullptr;
             cb = nullptr;
             threadId = -1;
+            enqueueTs = 0;
+            priority = Priority::NORMAL;
         }
     };
 
+    /**
+     * @brief 从当前线程的缓存分配任务节点，缓存为空时从全局缓存批量补充
+     */
+    static Task *AllocTask();
+
+    /**
+     * @brief 清空任务节点并放回当前线程的缓存，缓存过多时批量归还全局缓存
+     */
+    static void FreeTask(Task *task);
+
+    /**
+     * @brief 工作线程本地任务队列(工作窃取模式)
+     * @details 属主线程在尾部压入/弹出(LIFO)，窃取线程从头部取走(FIFO)，
+     *          队列仅在属主与窃取者之间竞争，临界区极短，使用自旋锁保护
+     */
+    struct WorkQueue {
+        using MutexType = SpinLock;
+
+        MutexType mutex;                ///< 保护本地队列的自旋锁
+        ds::IntrusiveList<Task> tasks;  ///< 本地任务队列
+    };
+
+    /**
+     * @brief 工作线程专属信箱，存放指定由该线程执行的任务
+     * @details 任意线程可无锁投递，只有属主线程消费
+     */
+    struct Mailbox {
+        std::atomic<pid_t> threadId = {-1};  ///< 属主线程ID，-1表示属主线程尚未进入或已退出run
+        std::atomic<bool> idle = {false};    ///< 属主线程是否处于空闲(可能阻塞在idle中)
+        ds::IntrusiveMpscQueue<Task, &Task::mpscNext> tasks;  ///< 指定线程任务队列
+    };
+
+    /**
+     * @brief 按任务归属投递：指定线程的进信箱，工作窃取模式下工作线程自身产生的进本地队列，其余进全局队列
+     * @param[in] task 待投递的任务，投递后归队列所有
+     * @return bool 需要唤醒工作线程时返回true
+     */
+    bool enqueue(Task *task);
+
+    /**
+     * @brief 根据线程ID查找本调度器内对应工作线程的信箱
+     * @param[in] tid 线程ID
+     * @return Mailbox* 找不到(非本调度器线程或尚未启动)时返回nullptr
+     */
+    Mailbox *getMailbox(uint64_t tid);
+
+    /**
+     * @brief 将任务投递到信箱
+     * @param[in] mailbox 目标信箱
+     * @param[in] task 待投递的任务，投递后归信箱所有
+     * @return bool 目标线程空闲时返回true
+     */
+    bool pushMailbox(Mailbox &mailbox, Task *task);
+
+    /**
+     * @brief 检查是否存在空闲且信箱非空的其他工作线程
+     * @details 所有线程阻塞在同一个epoll上，tickle无法指定唤醒对象，
+     *          被误唤醒的线程借此把唤醒继续传递下去
+     * @return bool 存在时返回true
+     */
+    bool hasPendingMailbox();
+
+    /**
+     * @brief 将任务压入对应优先级的全局队列，需持有 m_mutex
+     * @param[in] task 待压入的任务，压入后归全局队列所有
+     * @return bool 全局队列原本为空时返回true，提示需要唤醒工作线程
+     */
+    bool pushGlobalLocked(Task *task);
+
+    /**
+     * @brief 按优先级(含防饥饿)从全局队列取出当前线程可执行的任务，需持有 m_mutex
+     * @param[out] tickle_me 跳过了指定给其他线程的任务时置为true
+     * @return Task* 取出的任务，没有可执行的任务时返回nullptr
+     */
+    Task *popGlobalLocked(bool &tickle_me);
+
+    /**
+     * @brief 全局队列是否为空，需持有 m_mutex
+     */
+    bool globalEmptyLocked() const;
+
+    /**
+     * @brief 将任务压入当前工作线程的本地队列尾部
+     * @param[in] task 待压入的任务，压入后归本地队列所有
+     * @return bool 本地队列由空变为非空时返回true，提示需要唤醒空闲线程窃取
+     */
+    bool pushLocal(Task *task);
+
+    /**
+     * @brief 从当前工作线程的本地队列尾部取出任务
+     * @return Task* 取出的任务，本地队列为空时返回nullptr
+     */
+    Task *popLocal();
+
+    /**
+     * @brief 从其他工作线程的本地队列头部窃取任务
+     * @return Task* 窃取到的任务，没有可窃取的任务时返回nullptr
+     */
+    Task *steal();
+
    private:
-    MutexType m_mutex;                   ///< 互斥锁，保护协程队列和线程安全
-    std::vector<Thread::ptr> m_threads;  ///< 线程池，存储所有工作线程
-    std::list<Task> m_taskQueue;         ///< 待执行的协程队列，存储待调度的协程和回调函数
-    Coroutine::ptr m_rootCoroutine;      ///< 主协程，调度器的根协程，负责调度其他协程
-    std::string m_name;                  ///< 协程调度器的名称
+    MutexType m_mutex;                    ///< 互斥锁，保护协程队列和线程安全
+    std::vector<Thread::ptr> m_threads;   ///< 线程池，存储所有工作线程
+    Coroutine::ptr m_rootCoroutine;       ///< 主协程，调度器的根协程，负责调度其他协程
+    std::string m_name;                   ///< 协程调度器的名称
+    bool m_workStealing = false;          ///< 是否启用工作窃取模式
+    uint32_t m_priorityBurst = 16;        ///< 较低优先级等待时较高优先级最多连续被选中的次数
+    ThreadAffinity m_affinity;            ///< 工作线程的CPU亲和性与NUMA内存策略
+    std::vector<std::unique_ptr<WorkQueue>> m_workQueues;           ///< 各工作线程的本地队列
+    std::atomic<size_t> m_localTaskCount = {0};                     ///< 所有本地队列中的任务总数
+    std::vector<std::unique_ptr<Mailbox>> m_mailboxes;              ///< 各工作线程的专属信箱
+    std::atomic<int> m_nextWorkerIndex = {0};                       ///< 下一个进入run的工作线程分配到的下标
+    std::unique_ptr<SchedulerMetrics> m_metrics;                    ///< 运行时指标，未开启时为空
+    ds::IntrusiveList<Task> m_taskQueue[Priority::PRIORITY_COUNT];  ///< 按优先级划分的全局任务队列(工作窃取模式下为注入队列)
+    uint32_t m_priorityStreak[Priority::PRIORITY_COUNT] = {};       ///< 各优先级在较低优先级等待期间被连续选中的次数
+    std::atomic<size_t> m_highTaskCount = {0};                      ///< 全局队列中的 HIGH 任务数，供工作线程免锁判断
 
    protected:
     std::vector<pid_t> m_threadIds;                 ///< 线程ID列表，存储工作线程的ID
@@ -341,6 +630,29 @@ class Scheduler : public Noncopyable {
     pid_t m_rootThreadId = 0;                       ///< 主线程ID（使用调用线程时的线程ID）
 };
 
+/**
+ * @brief 优先级守卫
+ * @details 在作用域内调整当前协程的调度优先级，析构时恢复。
+ *          协程在作用域内挂起后被唤醒时按调整后的优先级入队
+ */
+class PriorityGuard : public Noncopyable {
+   public:
+    /**
+     * @brief 构造函数，设置当前协程的优先级
+     * @param[in] priority 新的优先级
+     */
+    explicit PriorityGuard(Coroutine::Priority priority);
+
+    /**
+     * @brief 析构函数，恢复原优先级
+     */
+    ~PriorityGuard();
+
+   private:
+    Coroutine *m_coroutine;          ///< 当前协程
+    Coroutine::Priority m_previous;  ///< 原优先级
+};
+
 /**
  * @brief 调度器切换器类
  * @details 用于临时切换到指定的调度器上下文执行，析构时自动切换回原调度器
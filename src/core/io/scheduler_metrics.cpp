@@ -0,0 +1,105 @@
+#include "core/io/scheduler_metrics.hpp"
+
+#include <time.h>
+
+namespace IM {
+uint64_t LatencySnapshot::percentile(double p) const {
+    if (count == 0) {
+        return 0;
+    }
+    // 第 rank 个样本(从1开始)所在的桶
+    uint64_t rank = (uint64_t)(p / 100.0 * count + 0.5);
+    if (rank == 0) {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            // 上界不超过实际观察到的最大值
+            uint64_t upper = LatencyHistogram::BucketUpperBound(i);
+            return upper < max ? upper : max;
+        }
+    }
+    return max;
+}
+
+size_t LatencyHistogram::BucketIndex(uint64_t ns) {
+    if (ns < kSubBucketCount) {
+        return ns;
+    }
+    int exp = 63 - __builtin_clzll(ns);
+    if (exp >= kMaxValueBits) {
+        return kBucketCount - 1;
+    }
+    // ns >> shift 落在 [kSubBucketCount, 2 * kSubBucketCount) 内，区间内线性细分
+    int shift = exp - kSubBucketBits;
+    return (shift + 1) * kSubBucketCount + ((ns >> shift) - kSubBucketCount);
+}
+
+uint64_t LatencyHistogram::BucketUpperBound(size_t index) {
+    if (index < kSubBucketCount) {
+        return index;
+    }
+    int shift = index / kSubBucketCount - 1;
+    uint64_t sub = index % kSubBucketCount + kSubBucketCount;
+    return ((sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t ns) {
+    m_buckets[BucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(ns, std::memory_order_relaxed);
+    // 每个分片只有属主线程写入，无需 CAS 循环
+    if (ns > m_max.load(std::memory_order_relaxed)) {
+        m_max.store(ns, std::memory_order_relaxed);
+    }
+}
+
+void LatencyHistogram::mergeTo(LatencySnapshot &snapshot) const {
+    if (snapshot.buckets.size() != kBucketCount) {
+        snapshot.buckets.resize(kBucketCount);
+    }
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        snapshot.buckets[i] += m_buckets[i].load(std::memory_order_relaxed);
+    }
+    snapshot.count += m_count.load(std::memory_order_relaxed);
+    snapshot.sum += m_sum.load(std::memory_order_relaxed);
+    uint64_t max = m_max.load(std::memory_order_relaxed);
+    if (max > snapshot.max) {
+        snapshot.max = max;
+    }
+}
+
+SchedulerMetrics::SchedulerMetrics(size_t workers) {
+    m_workers.reserve(workers);
+    for (size_t i = 0; i < workers; ++i) {
+        m_workers.emplace_back(new WorkerMetrics);
+    }
+}
+
+void SchedulerMetrics::snapshot(SchedulerMetricsSnapshot &snapshot, int index) const {
+    size_t begin = index < 0 ? 0 : index;
+    size_t end = index < 0 ? m_workers.size() : index + 1;
+    for (size_t i = begin; i < end; ++i) {
+        const WorkerMetrics &w = *m_workers[i];
+        snapshot.enqueued += w.enqueued.load(std::memory_order_relaxed);
+        snapshot.executed += w.executed.load(std::memory_order_relaxed);
+        snapshot.idleWakeups += w.idleWakeups.load(std::memory_order_relaxed);
+        snapshot.mailboxTasks += w.mailboxTasks.load(std::memory_order_relaxed);
+        snapshot.steals += w.steals.load(std::memory_order_relaxed);
+        w.queueWait.mergeTo(snapshot.queueWait);
+        w.runTime.mergeTo(snapshot.runTime);
+    }
+    if (index < 0) {
+        snapshot.enqueued += externalEnqueued();
+        snapshot.tickles += tickles();
+    }
+}
+
+uint64_t SchedulerMetrics::Now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+}  // namespace IM
@@ -0,0 +1,181 @@
+/**
+ * @file scheduler_metrics.hpp
+ * @brief 调度器运行时指标
+ * @author DreamTraveler233
+ * @date 2026-01-10
+ *
+ * 通过 scheduler.metrics 开启(默认关闭，关闭时调度路径只多一次空指针判断)：
+ * - 计数器：投递、执行、tickle、空闲唤醒、信箱任务、窃取次数
+ * - 直方图：任务从入队到开始执行的等待时间，以及每次换入后运行到让出的时间
+ * 直方图采用 HDR 风格的对数-线性分桶，每个 2 的幂区间再等分 32 份，相对误差约 3%，覆盖 0 ~ 约18分钟(纳秒)。
+ * 计数与直方图按工作线程分片，记录时只做本线程分片上的 relaxed 原子加，读取时再汇总。
+ */
+
+#ifndef __IM_IO_SCHEDULER_METRICS_HPP__
+#define __IM_IO_SCHEDULER_METRICS_HPP__
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "core/base/noncopyable.hpp"
+
+namespace IM {
+/**
+ * @brief 延迟直方图快照，用于汇总多个分片并计算分位数
+ */
+struct LatencySnapshot {
+    std::vector<uint64_t> buckets;  ///< 各桶计数
+    uint64_t count = 0;             ///< 样本数
+    uint64_t sum = 0;               ///< 样本总和(纳秒)
+    uint64_t max = 0;               ///< 最大值(纳秒)
+
+    /**
+     * @brief 计算分位数
+     * @param[in] p 分位，取值(0, 100]，如 99.9
+     * @return uint64_t 分位数所在桶的上界(纳秒)，无样本时返回0
+     */
+    uint64_t percentile(double p) const;
+
+    /**
+     * @brief 平均值(纳秒)
+     */
+    uint64_t mean() const { return count ? sum / count : 0; }
+};
+
+/**
+ * @brief 对数-线性分桶的延迟直方图，可多线程并发记录
+ */
+class LatencyHistogram : public Noncopyable {
+   public:
+    static constexpr int kSubBucketBits = 5;                          ///< 每个 2 的幂区间的细分位数
+    static constexpr uint64_t kSubBucketCount = 1 << kSubBucketBits;  ///< 每个区间的桶数
+    static constexpr int kMaxValueBits = 40;                          ///< 可记录的最大值位数，超出按最大桶计
+    /// 桶总数
+    static constexpr size_t kBucketCount = (kMaxValueBits - kSubBucketBits + 1) * kSubBucketCount;
+
+    /**
+     * @brief 记录一个样本
+     * @param[in] ns 样本值(纳秒)
+     */
+    void record(uint64_t ns);
+
+    /**
+     * @brief 把本直方图累加到快照中
+     * @param[in,out] snapshot 快照
+     */
+    void mergeTo(LatencySnapshot &snapshot) const;
+
+    /**
+     * @brief 样本值所在桶的下标
+     */
+    static size_t BucketIndex(uint64_t ns);
+
+    /**
+     * @brief 桶的上界(纳秒，含)
+     */
+    static uint64_t BucketUpperBound(size_t index);
+
+   private:
+    std::atomic<uint64_t> m_buckets[kBucketCount] = {};  ///< 各桶计数
+    std::atomic<uint64_t> m_count = {0};                 ///< 样本数
+    std::atomic<uint64_t> m_sum = {0};                   ///< 样本总和
+    std::atomic<uint64_t> m_max = {0};                   ///< 最大值
+};
+
+/**
+ * @brief 单个工作线程的调度指标分片，只由属主线程写入
+ */
+struct alignas(64) WorkerMetrics {
+    std::atomic<uint64_t> enqueued = {0};      ///< 本线程投递的任务数
+    std::atomic<uint64_t> executed = {0};      ///< 本线程换入执行的次数
+    std::atomic<uint64_t> idleWakeups = {0};   ///< 从空闲协程返回调度循环的次数
+    std::atomic<uint64_t> mailboxTasks = {0};  ///< 从本线程信箱取出的任务数
+    std::atomic<uint64_t> steals = {0};        ///< 从其他线程窃取的任务数
+    LatencyHistogram queueWait;                ///< 入队到开始执行的等待时间
+    LatencyHistogram runTime;                  ///< 每次换入后运行到让出的时间
+};
+
+/**
+ * @brief 调度器指标汇总结果
+ */
+struct SchedulerMetricsSnapshot {
+    uint64_t enqueued = 0;      ///< 投递的任务数
+    uint64_t executed = 0;      ///< 换入执行的次数
+    uint64_t tickles = 0;       ///< 实际发出的 tickle 次数(仅调度器整体)
+    uint64_t idleWakeups = 0;   ///< 空闲唤醒次数
+    uint64_t mailboxTasks = 0;  ///< 信箱任务数
+    uint64_t steals = 0;        ///< 窃取任务数
+    LatencySnapshot queueWait;  ///< 排队等待时间
+    LatencySnapshot runTime;    ///< 运行时间
+};
+
+/**
+ * @brief 调度器指标
+ */
+class SchedulerMetrics : public Noncopyable {
+   public:
+    /**
+     * @brief 构造函数
+     * @param[in] workers 工作线程数量(包括调用线程)
+     */
+    explicit SchedulerMetrics(size_t workers);
+
+    /**
+     * @brief 单调时钟当前时间(纳秒)
+     */
+    static uint64_t Now();
+
+    /**
+     * @brief 记录一次任务投递
+     * @param[in] index 投递线程在调度器中的工作线程下标，非工作线程为-1
+     */
+    void onEnqueue(int index) {
+        if (index >= 0) {
+            m_workers[index]->enqueued.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            m_externalEnqueued.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief 记录一次实际发出的 tickle
+     */
+    void onTickle() { m_tickles.fetch_add(1, std::memory_order_relaxed); }
+
+    /**
+     * @brief 获取工作线程的指标分片
+     */
+    WorkerMetrics &worker(size_t index) { return *m_workers[index]; }
+    const WorkerMetrics &worker(size_t index) const { return *m_workers[index]; }
+
+    /**
+     * @brief 工作线程分片数量
+     */
+    size_t workerCount() const { return m_workers.size(); }
+
+    /**
+     * @brief 非工作线程投递的任务数
+     */
+    uint64_t externalEnqueued() const { return m_externalEnqueued.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 实际发出的 tickle 次数
+     */
+    uint64_t tickles() const { return m_tickles.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 汇总指标
+     * @param[out] snapshot 汇总结果
+     * @param[in] index 工作线程下标，-1表示汇总所有工作线程及非工作线程的投递
+     */
+    void snapshot(SchedulerMetricsSnapshot &snapshot, int index = -1) const;
+
+   private:
+    std::vector<std::unique_ptr<WorkerMetrics>> m_workers;       ///< 各工作线程的分片
+    alignas(64) std::atomic<uint64_t> m_externalEnqueued = {0};  ///< 非工作线程投递的任务数
+    alignas(64) std::atomic<uint64_t> m_tickles = {0};           ///< 实际发出的 tickle 次数
+};
+}  // namespace IM
+
+#endif  // __IM_IO_SCHEDULER_METRICS_HPP__
@@ -51,6 +51,13 @@ class Semaphore : public Noncopyable {
      */
     void wait();
 
+    /**
+     * @brief 带超时的等待
+     * @param[in] timeout_ms 超时时间(毫秒)
+     * @return 超时返回false
+     */
+    bool waitFor(uint64_t timeout_ms);
+
     /**
      * @brief 通知操作（V操作）
      *
@@ -0,0 +1,141 @@
+#include "core/io/stack_profiler.hpp"
+
+#include <map>
+#include <memory>
+
+#include "core/config/config.hpp"
+#include "core/io/coroutine.hpp"
+#include "core/io/lock.hpp"
+
+namespace IM {
+static auto g_stack_profile_enable =
+    Config::Lookup<bool>("coroutine.stack_profile.enable", false, "profile coroutine stack high-water mark");
+// 每 sample 个新建协程统计一个，1 表示全部统计
+static auto g_stack_profile_sample =
+    Config::Lookup<uint32_t>("coroutine.stack_profile.sample", 1, "profile one of every N new coroutines");
+
+static const uint64_t kCanary = 0xc3a5c3a5a5c3a5c3ull;  // 哨兵值，避开0与常见的小整数/指针
+static const size_t kMaxEntries = 256;                  // 入口数量上限，超出的记入 other
+
+static bool s_enabled = false;
+static uint32_t s_sample = 1;
+static std::atomic<uint64_t> s_created = {0};
+
+struct StackProfilerInit {
+    StackProfilerInit() {
+        s_enabled = g_stack_profile_enable->getValue();
+        s_sample = g_stack_profile_sample->getValue();
+        g_stack_profile_enable->addListener([](const bool &old_val, const bool &new_val) { s_enabled = new_val; });
+        g_stack_profile_sample->addListener(
+            [](const uint32_t &old_val, const uint32_t &new_val) { s_sample = new_val; });
+    }
+};
+static StackProfilerInit __stack_profiler_init;
+
+using EntryMap = std::map<std::string, std::unique_ptr<StackProfileEntry>>;
+
+static RWMutex &GetEntryMutex() {
+    static RWMutex s_mutex;
+    return s_mutex;
+}
+
+static EntryMap &GetEntries() {
+    static EntryMap s_entries;
+    return s_entries;
+}
+
+static StackProfileEntry *GetEntry(const std::string &name) {
+    {
+        RWMutex::ReadLock lock(GetEntryMutex());
+        auto it = GetEntries().find(name);
+        if (it != GetEntries().end()) {
+            return it->second.get();
+        }
+    }
+    RWMutex::WriteLock lock(GetEntryMutex());
+    EntryMap &entries = GetEntries();
+    auto it = entries.find(name);
+    if (it != entries.end()) {
+        return it->second.get();
+    }
+    // 入口名称来自请求路径，防止异常请求无限增加入口
+    const std::string &key = entries.size() < kMaxEntries ? name : "other";
+    auto &entry = entries[key];
+    if (!entry) {
+        entry.reset(new StackProfileEntry);
+        entry->name = key;
+    }
+    return entry.get();
+}
+
+bool StackProfiler::IsEnabled() {
+    return s_enabled;
+}
+
+bool StackProfiler::ShouldProfile() {
+    if (!s_enabled) {
+        return false;
+    }
+    uint32_t sample = s_sample;
+    return sample <= 1 || s_created.fetch_add(1, std::memory_order_relaxed) % sample == 0;
+}
+
+void StackProfiler::Paint(void *stack, size_t size) {
+    uint64_t *p = (uint64_t *)stack;
+    uint64_t *end = p + size / sizeof(uint64_t);
+    while (p < end) {
+        *p++ = kCanary;
+    }
+}
+
+size_t StackProfiler::Measure(void *stack, size_t size) {
+    uint64_t *begin = (uint64_t *)stack;
+    uint64_t *end = begin + size / sizeof(uint64_t);
+    uint64_t *p = begin;
+    // 栈向低地址增长，从栈底向上找到第一个被改写的字；先按 64 字节一组比较，减少分支
+    while (p + 8 <= end) {
+        uint64_t diff = (p[0] ^ kCanary) | (p[1] ^ kCanary) | (p[2] ^ kCanary) | (p[3] ^ kCanary) |
+                        (p[4] ^ kCanary) | (p[5] ^ kCanary) | (p[6] ^ kCanary) | (p[7] ^ kCanary);
+        if (diff) {
+            break;
+        }
+        p += 8;
+    }
+    while (p < end && *p == kCanary) {
+        ++p;
+    }
+    size_t used = (end - p) * sizeof(uint64_t);
+    Paint(p, used);
+    return used;
+}
+
+void StackProfiler::Record(StackProfileEntry *entry, size_t used, size_t stack_size) {
+    if (!entry) {
+        static StackProfileEntry *s_untagged = GetEntry("untagged");
+        entry = s_untagged;
+    }
+    entry->depth.record(used);
+    entry->stackSize.store(stack_size, std::memory_order_relaxed);
+}
+
+void StackProfiler::SetTag(const std::string &name) {
+    if (!s_enabled) {
+        return;
+    }
+    Coroutine::ptr cur = Coroutine::GetThis();
+    if (cur->isStackProfiled()) {
+        cur->setStackEntry(GetEntry(name));
+    }
+}
+
+void StackProfiler::Snapshot(std::vector<StackProfileSnapshot> &out) {
+    RWMutex::ReadLock lock(GetEntryMutex());
+    for (auto &i : GetEntries()) {
+        out.emplace_back();
+        StackProfileSnapshot &snapshot = out.back();
+        snapshot.name = i.first;
+        snapshot.stackSize = i.second->stackSize.load(std::memory_order_relaxed);
+        i.second->depth.mergeTo(snapshot.depth);
+    }
+}
+}  // namespace IM
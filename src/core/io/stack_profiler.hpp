@@ -0,0 +1,96 @@
+/**
+ * @file stack_profiler.hpp
+ * @brief 协程栈使用深度(高水位)统计
+ * @author DreamTraveler233
+ * @date 2026-01-10
+ *
+ * 用于确定各类服务实际需要的 coroutine.stack_size。通过 coroutine.stack_profile.enable 开启(默认关闭)：
+ * - 新建的私有栈协程按 coroutine.stack_profile.sample 抽样，被抽中的协程把整个栈填充为哨兵值
+ * - 协程回收(reset 复用或析构)时从栈底向上找到第一个被改写的字，得到本次运行的最大栈深度，
+ *   记入当前入口的直方图后把改写过的区域重新填充，供下一次运行测量
+ * - 入口由业务分发处通过 SetTag 标记(如 http:/api/v1/user/login、ws:/wss/default.io、rock:513)，
+ *   未标记的任务记入 untagged
+ * 共享栈协程不参与统计(其栈快照大小即挂起时的深度，见 shared_stack.saved_bytes)。
+ * 开启后每次回收需扫描被抽中协程的整个栈，有明显开销，只用于容量评估。
+ */
+
+#ifndef __IM_IO_STACK_PROFILER_HPP__
+#define __IM_IO_STACK_PROFILER_HPP__
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "core/io/scheduler_metrics.hpp"
+
+namespace IM {
+/**
+ * @brief 单个入口的栈深度统计
+ */
+struct StackProfileEntry {
+    std::string name;                       ///< 入口名称
+    LatencyHistogram depth;                 ///< 栈深度(字节)
+    std::atomic<uint64_t> stackSize = {0};  ///< 最近一次记录时的栈大小(字节)
+};
+
+/**
+ * @brief 入口统计快照
+ */
+struct StackProfileSnapshot {
+    std::string name;        ///< 入口名称
+    LatencySnapshot depth;   ///< 栈深度(字节)
+    uint64_t stackSize = 0;  ///< 栈大小(字节)
+};
+
+/**
+ * @brief 协程栈深度统计
+ */
+class StackProfiler {
+   public:
+    /**
+     * @brief 是否开启统计
+     */
+    static bool IsEnabled();
+
+    /**
+     * @brief 新建协程时调用，判断是否对该协程做统计(按抽样比例)
+     */
+    static bool ShouldProfile();
+
+    /**
+     * @brief 把栈填充为哨兵值
+     * @param[in] stack 栈底(低地址)
+     * @param[in] size 栈大小
+     */
+    static void Paint(void *stack, size_t size);
+
+    /**
+     * @brief 测量栈的最大使用深度，并把被改写的区域重新填充为哨兵值
+     * @param[in] stack 栈底(低地址)
+     * @param[in] size 栈大小
+     * @return size_t 从栈顶算起被改写过的字节数
+     */
+    static size_t Measure(void *stack, size_t size);
+
+    /**
+     * @brief 记录一次测量结果
+     * @param[in] entry 入口，nullptr 记入 untagged
+     * @param[in] used 使用深度(字节)
+     * @param[in] stack_size 栈大小(字节)
+     */
+    static void Record(StackProfileEntry *entry, size_t used, size_t stack_size);
+
+    /**
+     * @brief 标记当前协程正在执行的入口，未开启统计或当前协程未被抽中时忽略
+     * @param[in] name 入口名称
+     */
+    static void SetTag(const std::string &name);
+
+    /**
+     * @brief 获取所有入口的统计快照，按名称排序
+     */
+    static void Snapshot(std::vector<StackProfileSnapshot> &out);
+};
+}  // namespace IM
+
+#endif  // __IM_IO_STACK_PROFILER_HPP__
@@ -0,0 +1,163 @@
+/**
+ * @file task_func.hpp
+ * @brief 小对象优化的只移动回调
+ * @author DreamTraveler233
+ * @date 2026-01-10
+ *
+ * 调度器任务与协程入口使用的 void() 回调类型，用于替代 std::function：
+ * - 内联存储 48 字节，常见的 std::bind(&T::f, shared_ptr, shared_ptr) 与捕获几个指针/智能指针的 lambda
+ *   都可以放进对象内部，构造、移动、销毁都不分配堆内存
+ * - 只支持移动，因此可以容纳只移动的可调用对象，移动时转移所有权而不是增加引用计数
+ * - 超过内联容量、对齐要求过高或移动可能抛异常的可调用对象退回堆上存放
+ * - 可从 std::function 隐式构造(std::function 本身 32 字节，放在内联存储中)
+ */
+
+#ifndef __IM_IO_TASK_FUNC_HPP__
+#define __IM_IO_TASK_FUNC_HPP__
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace IM {
+/**
+ * @brief 小对象优化的只移动 void() 回调
+ */
+class TaskFunc {
+   public:
+    static constexpr size_t kInlineSize = 48;                          ///< 内联存储大小
+    static constexpr size_t kInlineAlign = alignof(std::max_align_t);  ///< 内联存储对齐
+
+    TaskFunc() noexcept = default;
+    TaskFunc(std::nullptr_t) noexcept {}
+
+    /**
+     * @brief 从任意可调用对象构造
+     * @param[in] f 可调用对象，签名需兼容 void()
+     */
+    template <class F, class D = typename std::decay<F>::type,
+              class = typename std::enable_if<!std::is_same<D, TaskFunc>::value>::type>
+    TaskFunc(F &&f) {
+        // 空的 std::function 或空函数指针构造出空回调
+        if (IsNull(f)) {
+            return;
+        }
+        if constexpr (IsInline<D>()) {
+            new (&m_storage) D(std::forward<F>(f));
+            m_ops = &InlineOps<D>::ops;
+        } else {
+            *reinterpret_cast<D **>(&m_storage) = new D(std::forward<F>(f));
+            m_ops = &HeapOps<D>::ops;
+        }
+    }
+
+    TaskFunc(TaskFunc &&other) noexcept { moveFrom(other); }
+
+    TaskFunc &operator=(TaskFunc &&other) noexcept {
+        if (this != &other) {
+            reset();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    TaskFunc &operator=(std::nullptr_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    TaskFunc(const TaskFunc &) = delete;
+    TaskFunc &operator=(const TaskFunc &) = delete;
+
+    ~TaskFunc() { reset(); }
+
+    /**
+     * @brief 调用回调
+     */
+    void operator()() { m_ops->invoke(&m_storage); }
+
+    /**
+     * @brief 是否持有可调用对象
+     */
+    explicit operator bool() const noexcept { return m_ops != nullptr; }
+
+    /**
+     * @brief 释放持有的可调用对象
+     */
+    void reset() noexcept {
+        if (m_ops) {
+            m_ops->destroy(&m_storage);
+            m_ops = nullptr;
+        }
+    }
+
+    /**
+     * @brief 可调用对象是否能放进内联存储
+     */
+    template <class D>
+    static constexpr bool IsInline() {
+        return sizeof(D) <= kInlineSize && alignof(D) <= kInlineAlign &&
+               std::is_nothrow_move_constructible<D>::value;
+    }
+
+   private:
+    /**
+     * @brief 类型擦除后的操作表
+     */
+    struct Ops {
+        void (*invoke)(void *storage);                 ///< 调用
+        void (*move)(void *dst, void *src) noexcept;  ///< 移动到 dst 并销毁 src
+        void (*destroy)(void *storage) noexcept;      ///< 销毁
+    };
+
+    template <class D>
+    struct InlineOps {
+        static void Invoke(void *s) { (*static_cast<D *>(s))(); }
+        static void Move(void *dst, void *src) noexcept {
+            new (dst) D(std::move(*static_cast<D *>(src)));
+            static_cast<D *>(src)->~D();
+        }
+        static void Destroy(void *s) noexcept { static_cast<D *>(s)->~D(); }
+        static constexpr Ops ops = {&Invoke, &Move, &Destroy};
+    };
+
+    template <class D>
+    struct HeapOps {
+        static void Invoke(void *s) { (**static_cast<D **>(s))(); }
+        static void Move(void *dst, void *src) noexcept { *static_cast<D **>(dst) = *static_cast<D **>(src); }
+        static void Destroy(void *s) noexcept { delete *static_cast<D **>(s); }
+        static constexpr Ops ops = {&Invoke, &Move, &Destroy};
+    };
+
+    template <class F>
+    static bool IsNull(const F &) {
+        return false;
+    }
+
+    template <class R, class... Args>
+    static bool IsNull(const std::function<R(Args...)> &f) {
+        return !f;
+    }
+
+    template <class R, class... Args>
+    static bool IsNull(R (*f)(Args...)) {
+        return f == nullptr;
+    }
+
+    void moveFrom(TaskFunc &other) noexcept {
+        if (other.m_ops) {
+            other.m_ops->move(&m_storage, &other.m_storage);
+            m_ops = other.m_ops;
+            other.m_ops = nullptr;
+        }
+    }
+
+   private:
+    typename std::aligned_storage<kInlineSize, kInlineAlign>::type m_storage;  ///< 内联存储或堆对象指针
+    const Ops *m_ops = nullptr;                                                ///< 操作表，空回调时为nullptr
+};
+}  // namespace IM
+
+#endif  // __IM_IO_TASK_FUNC_HPP__
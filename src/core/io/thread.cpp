@@ -10,7 +10,8 @@ static thread_local std::string t_thread_name = "unknown";
 
 static auto g_logger = IM_LOG_NAME("system");
 
-Thread::Thread(std::function<void()> cb, const std::string &name) : m_id(-1), m_thread(-1), m_cb(cb), m_name(name) {
+Thread::Thread(std::function<void()> cb, const std::string &name, const ThreadAffinity &affinity)
+    : m_id(-1), m_thread(-1), m_cb(cb), m_name(name), m_affinity(affinity) {
     /**
      * 这里将 this 传入线程函数的原因：
      *      1、线程函数Thread::run是静态函数，无法直接访问类的成员变量
@@ -64,6 +65,10 @@ void *Thread::run(void *arg) {
     thread->m_id = IM::GetThreadId();
     // 设置线程的名称，限制在15个字符以内
     pthread_setname_np(pthread_self(), thread->m_name.substr(0, 15).c_str());
+    // 在执行回调前设置亲和性，线程此后的内存分配都受NUMA策略约束
+    if (!thread->m_affinity.empty()) {
+        thread->m_affinity.apply();
+    }
 
     std::function<void()> cb;
     // 使用swap而不是直接赋值是为了避免增加智能指针的引用计数，swap的作用类似移交所属权
@@ -18,6 +18,7 @@
 
 #include "core/base/noncopyable.hpp"
 
+#include "cpu_affinity.hpp"
 #include "semaphore.hpp"
 
 namespace IM {
@@ -36,10 +37,12 @@ class Thread : public Noncopyable {
      * @brief 构造函数
      * @param[in] cb 线程执行的回调函数
      * @param[in] name 线程名称
+     * @param[in] affinity CPU亲和性与NUMA内存策略，线程启动后执行回调前由线程自己设置
      *
      * 创建并启动线程，线程函数为run，参数为this
      */
-    Thread(std::function<void()> cb, const std::string &name = "UNKNOWN");
+    Thread(std::function<void()> cb, const std::string &name = "UNKNOWN",
+           const ThreadAffinity &affinity = ThreadAffinity());
 
     /**
      * @brief 析构函数
@@ -101,6 +104,7 @@ class Thread : public Noncopyable {
     std::function<void()> m_cb;  // 线程回调函数
     std::string m_name;          // 线程名称
     Semaphore m_semaphore;       // 信号量，用于线程启动同步
+    ThreadAffinity m_affinity;   // CPU亲和性与NUMA内存策略
 };
 }  // namespace IM
 
@@ -1,9 +1,15 @@
 #include "core/io/timer.hpp"
 
 #include "core/base/macro.hpp"
+#include "core/config/config.hpp"
+#include "core/io/timing_wheel.hpp"
 #include "core/util/time_util.hpp"
 
 namespace IM {
+// 定义配置项--定时器管理器后端--wheel(分层时间轮)或set(有序集合)
+static auto g_timer_backend =
+    Config::Lookup<std::string>("timer.backend", std::string("wheel"), "timer manager backend: wheel or set");
+
 Timer::Timer(uint64_t ms, std::function<void()> cb, bool recurring, TimerManager *manager)
     : m_recurring(recurring), m_ms(ms), m_next(TimeUtil::NowToMS() + m_ms), m_cb(cb), m_manager(manager) {}
 
@@ -15,11 +21,7 @@ bool Timer::cancel() {
         // 取消回调函数
         m_cb = nullptr;
         // 将定时器从定时器队列中删除
-        auto it = m_manager->m_timers.find(shared_from_this());
-        if (it != m_manager->m_timers.end()) {
-            m_manager->m_timers.erase(it);
-            return true;
-        }
+        return m_manager->eraseTimer(shared_from_this());
     }
     return false;
 }
@@ -27,11 +29,10 @@ bool Timer::cancel() {
 bool Timer::refresh() {
     TimerManager::RWMutexType::WriteLock lock(m_manager->m_mutex);
     if (m_cb) {
-        auto it = m_manager->m_timers.find(shared_from_this());
-        if (it != m_manager->m_timers.end()) {
-            m_manager->m_timers.erase(it);
+        Timer::ptr self = shared_from_this();
+        if (m_manager->eraseTimer(self)) {
             m_next = TimeUtil::NowToMS() + m_ms;
-            m_manager->m_timers.insert(shared_from_this());
+            m_manager->insertTimer(self);
             return true;
         }
     }
@@ -48,13 +49,10 @@ bool Timer::reset(uint64_t ms, bool from_now) {
     if (!m_cb) {
         return false;
     }
-    auto it = m_manager->m_timers.find(shared_from_this());
-    // 查找定时器是否在管理器中存在
-    if (it == m_manager->m_timers.end()) {
+    // 从定时器管理器中移除该定时器，不存在则失败
+    if (!m_manager->eraseTimer(shared_from_this())) {
         return false;
     }
-    // 从定时器管理器中移除该定时器
-    m_manager->m_timers.erase(it);
     uint64_t start = 0;
     if (from_now) {
         // 从当前时间开始计算
@@ -96,13 +94,19 @@ bool Timer::Comparator::operator()(const Timer::ptr &lhs, const Timer::ptr &rhs)
 
 TimerManager::TimerManager() {
     m_previouseTime = TimeUtil::NowToMS();
+    if (g_timer_backend->getValue() != "set") {
+        m_wheel.reset(new TimingWheel(m_previouseTime));
+    }
 }
 
+TimerManager::~TimerManager() = default;
+
 Timer::ptr TimerManager::addTimer(uint64_t ms, std::function<void()> cb, bool recurring) {
     // IM_ASSERT(ms && cb);
-    Timer::ptr timer(new Timer(ms, cb, recurring, this));
-    RWMutex::WriteLock lock(m_mutex);
-    addTimer(timer, lock);
+    TimerManager *manager = selectTimerManager();
+    Timer::ptr timer(new Timer(ms, cb, recurring, manager));
+    RWMutex::WriteLock lock(manager->m_mutex);
+    manager->addTimer(timer, lock);
     return timer;
 }
 
@@ -122,18 +126,23 @@ Timer::ptr TimerManager::addConditionTimer(uint64_t ms, std::function<void()> cb
 uint64_t TimerManager::getNextTimer() {
     RWMutex::ReadLock lock(m_mutex);
     m_tickled = false;
-    if (m_timers.empty()) {
+    // 获取最早执行的定时器
+    uint64_t next = nextExpireNolock();
+    if (next == ~0ull) {
         return ~0ull;
     }
-    // 获取最早执行的定时器
-    const Timer::ptr &next = *m_timers.begin();
     uint64_t now = TimeUtil::NowToMS();
 
-    if (now >= next->m_next) {
+    // 时钟回退后时间轮的刻度超前，返回的时间点不可信，立即处理以便 listExpiredCb 重新同步
+    if (m_wheel && now < m_wheel->current()) {
+        return 0;
+    }
+
+    if (now >= next) {
         // 立即处理
         return 0;
     } else {
-        return next->m_next - now;
+        return next - now;
     }
 }
 
@@ -144,35 +153,50 @@ void TimerManager::listExpiredCb(std::vector<std::function<void()>> &cbs) {
     // 双重检查，减少获取写锁的次数，提高并发性能
     {
         RWMutex::ReadLock lock(m_mutex);
-        if (m_timers.empty()) {
+        if (nextExpireNolock() == ~0ull) {
             return;
         }
     }
 
     // 获取写锁以修改定时器集合
     RWMutex::WriteLock lock(m_mutex);
-    if (m_timers.empty()) {
+    if (nextExpireNolock() == ~0ull) {
         return;
     }
 
     // 检查是否有系统时钟回退或是否有到期的定时器
     bool rollover = detectClockRollover(now_ms);
-    if (!rollover && ((*m_timers.begin())->m_next > now_ms)) {
+    // 小幅回退(未达到rollover阈值)时同步时间轮刻度，否则回退后插入的定时器要等时钟追上才会到期
+    if (m_wheel && !rollover && now_ms < m_wheel->current()) {
+        m_wheel->resync(now_ms);
+    }
+    if (!rollover && nextExpireNolock() > now_ms) {
         return;
     }
 
-    // 查找所有已到期的定时器
-    Timer::ptr now_timer(new Timer(now_ms));
-    // 查找第一个未到期（或刚好到期）的定时器
-    auto it = rollover ? m_timers.end() : m_timers.lower_bound(now_timer);
-    // 处理多个执行时间相同的定时器
-    while (it != m_timers.end() && (*it)->m_next == now_ms) {
-        ++it;
-    }
+    if (m_wheel) {
+        // 时钟回退时全部视为到期，否则推进时间轮取出到期定时器
+        if (rollover) {
+            m_wheel->takeAll(expired);
+            // 重复定时器按新时间重新插入，刻度必须一并回退
+            m_wheel->resync(now_ms);
+        } else {
+            m_wheel->expire(now_ms, expired);
+        }
+    } else {
+        // 查找所有已到期的定时器
+        Timer::ptr now_timer(new Timer(now_ms));
+        // 查找第一个未到期（或刚好到期）的定时器
+        auto it = rollover ? m_timers.end() : m_timers.lower_bound(now_timer);
+        // 处理多个执行时间相同的定时器
+        while (it != m_timers.end() && (*it)->m_next == now_ms) {
+            ++it;
+        }
 
-    // 将已到期的定时器移到expired向量中
-    expired.insert(expired.begin(), m_timers.begin(), it);
-    m_timers.erase(m_timers.begin(), it);
+        // 将已到期的定时器移到expired向量中
+        expired.insert(expired.begin(), m_timers.begin(), it);
+        m_timers.erase(m_timers.begin(), it);
+    }
 
     cbs.reserve(expired.size());
 
@@ -182,7 +206,7 @@ void TimerManager::listExpiredCb(std::vector<std::function<void()>> &cbs) {
         if (timer->m_recurring) {
             // 对于重复执行的定时器，设置下次执行时间并重新插入队列
             timer->m_next = now_ms + timer->m_ms;
-            m_timers.insert(timer);
+            insertTimer(timer);
         } else {
             // 对于一次性定时器，清空回调函数
             timer->m_cb = nullptr;
@@ -192,15 +216,23 @@ void TimerManager::listExpiredCb(std::vector<std::function<void()>> &cbs) {
 
 bool TimerManager::hasTimer() {
     RWMutex::ReadLock lock(m_mutex);
-    return !m_timers.empty();
+    return nextExpireNolock() != ~0ull;
 }
 
 /*
         将锁作为参数的目的：减小锁颗粒度
     */
 void TimerManager::addTimer(Timer::ptr val, RWMutexType::WriteLock &lock) {
-    auto it = m_timers.insert(val).first;
-    bool at_front = (it == m_timers.begin() && !m_tickled);
+    bool at_front = false;
+    if (m_wheel) {
+        // 早于原先最近执行时间(下界)的定时器才需要提前唤醒
+        uint64_t prev = m_wheel->nextExpire();
+        m_wheel->add(val);
+        at_front = val->m_next < prev && !m_tickled;
+    } else {
+        auto it = m_timers.insert(val).first;
+        at_front = (it == m_timers.begin() && !m_tickled);
+    }
     if (at_front) {
         // 标记已通知上层
         m_tickled = true;
@@ -221,4 +253,31 @@ bool TimerManager::detectClockRollover(uint64_t now_ms) {
     m_previouseTime = now_ms;
     return rollover;
 }
+
+void TimerManager::insertTimer(const Timer::ptr &timer) {
+    if (m_wheel) {
+        m_wheel->add(timer);
+    } else {
+        m_timers.insert(timer);
+    }
+}
+
+bool TimerManager::eraseTimer(const Timer::ptr &timer) {
+    if (m_wheel) {
+        return m_wheel->remove(timer.get()) != nullptr;
+    }
+    auto it = m_timers.find(timer);
+    if (it == m_timers.end()) {
+        return false;
+    }
+    m_timers.erase(it);
+    return true;
+}
+
+uint64_t TimerManager::nextExpireNolock() const {
+    if (m_wheel) {
+        return m_wheel->nextExpire();
+    }
+    return m_timers.empty() ? ~0ull : (*m_timers.begin())->m_next;
+}
 }  // namespace IM
\ No newline at end of file
@@ -5,7 +5,8 @@
  * @date 2026-01-10
  *
  * 该模块实现了基于时间事件的定时器功能，支持一次性定时器和周期性定时器。
- * 定时器使用最小堆(std::set)进行管理，通过回调函数的方式处理超时事件。
+ * 定时器默认由分层时间轮(TimingWheel)管理，插入与取消均为O(1)；也可通过 timer.backend=set
+ * 退回按执行时间排序的std::set。两种后端对外语义一致，通过回调函数的方式处理超时事件。
  * Timer类表示单个定时器实例，TimerManager类负责管理多个定时器。
  */
 
@@ -21,6 +22,7 @@
 
 namespace IM {
 class TimerManager;
+class TimingWheel;
 
 /**
  * @brief 定时器类
@@ -30,6 +32,7 @@ class TimerManager;
  */
 class Timer : public std::enable_shared_from_this<Timer>, public Noncopyable {
     friend class TimerManager;
+    friend class TimingWheel;
 
    public:
     /// 智能指针类型定义
@@ -103,6 +106,18 @@ class Timer : public std::enable_shared_from_this<Timer>, public Noncopyable {
     /// 定时器管理器指针
     TimerManager *m_manager = nullptr;
 
+    /// 时间轮槽位链表前驱(仅时间轮后端使用)
+    Timer *m_wheelPrev = nullptr;
+
+    /// 时间轮槽位链表后继(仅时间轮后端使用)
+    Timer *m_wheelNext = nullptr;
+
+    /// 所在时间轮槽位，-1表示不在时间轮中
+    int m_wheelSlot = -1;
+
+    /// 挂在时间轮上期间由时间轮持有的自身引用
+    std::shared_ptr<Timer> m_wheelRef;
+
    private:
     /**
      * @brief 定时器比较仿函数
@@ -126,7 +141,7 @@ class Timer : public std::enable_shared_from_this<Timer>, public Noncopyable {
 /**
  * @brief 定时器管理器
  *
- * 管理多个定时器，使用std::set作为容器维护定时器的有序性。
+ * 管理多个定时器，后端为分层时间轮或按执行时间排序的std::set(由 timer.backend 配置)。
  * 提供添加定时器、获取超时定时器回调等接口。
  */
 class TimerManager : public Noncopyable {
@@ -144,7 +159,7 @@ class TimerManager : public Noncopyable {
     /**
      * @brief 析构函数
      */
-    virtual ~TimerManager() = default;
+    virtual ~TimerManager();
 
     /**
      * @brief 添加定时器
@@ -205,6 +220,15 @@ class TimerManager : public Noncopyable {
      */
     virtual void onTimerInsertedAtFront() = 0;
 
+    /**
+     * @brief 选择新定时器的归属管理器
+     *
+     * 默认归属自身；子类可以把定时器分派到更细粒度的管理器(例如工作线程私有的管理器)。
+     *
+     * @return TimerManager* 新定时器的归属管理器
+     */
+    virtual TimerManager *selectTimerManager() { return this; }
+
     /**
      * @brief 添加定时器到管理器
      *
@@ -224,13 +248,35 @@ class TimerManager : public Noncopyable {
      */
     bool detectClockRollover(uint64_t now_ms);
 
+    /**
+     * @brief 把定时器放入后端容器(需持有写锁)
+     * @param[in] timer 定时器
+     */
+    void insertTimer(const Timer::ptr &timer);
+
+    /**
+     * @brief 把定时器从后端容器移除(需持有写锁)
+     * @param[in] timer 定时器
+     * @return bool 定时器在容器中并被移除时返回true
+     */
+    bool eraseTimer(const Timer::ptr &timer);
+
+    /**
+     * @brief 最近一个定时器的执行时间点(需持有锁)
+     * @return uint64_t 时间点(毫秒)，时间轮后端返回其下界；无定时器时返回~0ull
+     */
+    uint64_t nextExpireNolock() const;
+
    private:
     /// 读写互斥锁
     RWMutexType m_mutex;
 
-    /// 定时器集合，按执行时间排序
+    /// 定时器集合，按执行时间排序(set后端)
     std::set<Timer::ptr, Timer::Comparator> m_timers;
 
+    /// 分层时间轮(时间轮后端)，为空表示使用set后端
+    std::unique_ptr<TimingWheel> m_wheel;
+
     /// 是否被"踢"过，用于避免频繁触发onTimerInsertedAtFront
     bool m_tickled = false;
 
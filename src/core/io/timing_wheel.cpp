@@ -0,0 +1,223 @@
+#include "core/io/timing_wheel.hpp"
+
+#include "core/base/macro.hpp"
+
+namespace IM {
+/**
+ * @brief 在循环位图区间内，从start开始查找第一个置位的位
+ * @param[in] words 位图区间起始字(区间长度为64的整数倍)
+ * @param[in] nbits 区间位数
+ * @param[in] start 起始位置
+ * @return int 与start的距离，没有置位时返回-1
+ */
+static int FindNextBit(const uint64_t *words, int nbits, int start) {
+    for (int d = 0; d < nbits;) {
+        int pos = (start + d) % nbits;
+        int bit = pos & 63;
+        uint64_t word = words[pos >> 6] >> bit;
+        if (word) {
+            int dist = d + __builtin_ctzll(word);
+            return dist < nbits ? dist : -1;
+        }
+        d += 64 - bit;
+    }
+    return -1;
+}
+
+TimingWheel::TimingWheel(uint64_t now_ms) : m_current(now_ms) {}
+
+TimingWheel::~TimingWheel() {
+    std::vector<Timer::ptr> all;
+    takeAll(all);
+}
+
+void TimingWheel::link(Timer *timer, int slot) {
+    Timer *&head = m_slots[slot];
+    timer->m_wheelPrev = nullptr;
+    timer->m_wheelNext = head;
+    if (head) {
+        head->m_wheelPrev = timer;
+    } else {
+        m_bitmap[slot >> 6] |= 1ull << (slot & 63);
+    }
+    head = timer;
+    timer->m_wheelSlot = slot;
+}
+
+void TimingWheel::unlink(Timer *timer) {
+    int slot = timer->m_wheelSlot;
+    if (timer->m_wheelPrev) {
+        timer->m_wheelPrev->m_wheelNext = timer->m_wheelNext;
+    } else {
+        m_slots[slot] = timer->m_wheelNext;
+        if (!m_slots[slot]) {
+            m_bitmap[slot >> 6] &= ~(1ull << (slot & 63));
+        }
+    }
+    if (timer->m_wheelNext) {
+        timer->m_wheelNext->m_wheelPrev = timer->m_wheelPrev;
+    }
+    timer->m_wheelPrev = timer->m_wheelNext = nullptr;
+    timer->m_wheelSlot = -1;
+}
+
+void TimingWheel::place(Timer *timer) {
+    // 已过期的定时器放到当前刻度，下次推进时立即取出
+    uint64_t expire = timer->m_next > m_current ? timer->m_next : m_current;
+    uint64_t delta = expire - m_current;
+    // 第level层覆盖 [2^Shift(level), 2^Shift(level+1)) 范围内的剩余时间
+    int level = 0;
+    while (level < kLevels - 1 && delta >= (1ull << Shift(level + 1))) {
+        ++level;
+    }
+    if (level == 0) {
+        link(timer, expire & (kRootSlots - 1));
+        return;
+    }
+    // 超出最高层覆盖范围时先放在最远的槽，级联时再按真实时间放置
+    uint64_t span = 1ull << Shift(level + 1);
+    if (delta >= span) {
+        expire = m_current + span - 1;
+    }
+    link(timer, Base(level) + ((expire >> Shift(level)) & (kLevelSlots - 1)));
+}
+
+void TimingWheel::add(const Timer::ptr &timer) {
+    IM_ASSERT(timer->m_wheelSlot == -1);
+    timer->m_wheelRef = timer;
+    place(timer.get());
+    ++m_size;
+}
+
+Timer::ptr TimingWheel::remove(Timer *timer) {
+    if (timer->m_wheelSlot == -1) {
+        return nullptr;
+    }
+    unlink(timer);
+    --m_size;
+    return std::move(timer->m_wheelRef);
+}
+
+int TimingWheel::cascade(int level) {
+    int index = (m_current >> Shift(level)) & (kLevelSlots - 1);
+    int slot = Base(level) + index;
+    Timer *timer = m_slots[slot];
+    m_slots[slot] = nullptr;
+    m_bitmap[slot >> 6] &= ~(1ull << (slot & 63));
+    while (timer) {
+        Timer *next = timer->m_wheelNext;
+        place(timer);
+        timer = next;
+    }
+    return index;
+}
+
+void TimingWheel::expire(uint64_t now_ms, std::vector<Timer::ptr> &expired) {
+    // 时钟回退时按新时间重新放置，不等待时钟追上
+    if (now_ms < m_current) {
+        resync(now_ms);
+    }
+    // m_current 停留在最后处理的刻度上，之后插入的已过期定时器落在该槽，下次推进时立即取出
+    while (true) {
+        if (m_size == 0) {
+            m_current = now_ms;
+            break;
+        }
+
+        int index = m_current & (kRootSlots - 1);
+        // 第0层转完一圈，依次从高层级联
+        if (index == 0) {
+            for (int level = 1; level < kLevels && cascade(level) == 0; ++level) {
+            }
+        }
+
+        Timer *timer = m_slots[index];
+        if (timer) {
+            m_slots[index] = nullptr;
+            m_bitmap[index >> 6] &= ~(1ull << (index & 63));
+            while (timer) {
+                Timer *next = timer->m_wheelNext;
+                timer->m_wheelPrev = timer->m_wheelNext = nullptr;
+                timer->m_wheelSlot = -1;
+                --m_size;
+                expired.push_back(std::move(timer->m_wheelRef));
+                timer = next;
+            }
+        }
+
+        if (m_current >= now_ms) {
+            break;
+        }
+
+        // 第0层没有定时器时直接跳到下一个级联刻度
+        bool root_empty = true;
+        for (int i = 0; i < kRootSlots / 64; ++i) {
+            if (m_bitmap[i]) {
+                root_empty = false;
+                break;
+            }
+        }
+        if (root_empty) {
+            uint64_t next_round = (m_current | (kRootSlots - 1)) + 1;
+            m_current = next_round < now_ms ? next_round : now_ms;
+        } else {
+            ++m_current;
+        }
+    }
+}
+
+void TimingWheel::takeAll(std::vector<Timer::ptr> &out) {
+    for (int slot = 0; slot < kSlots; ++slot) {
+        Timer *timer = m_slots[slot];
+        m_slots[slot] = nullptr;
+        while (timer) {
+            Timer *next = timer->m_wheelNext;
+            timer->m_wheelPrev = timer->m_wheelNext = nullptr;
+            timer->m_wheelSlot = -1;
+            out.push_back(std::move(timer->m_wheelRef));
+            timer = next;
+        }
+    }
+    for (auto &word : m_bitmap) {
+        word = 0;
+    }
+    m_size = 0;
+}
+
+void TimingWheel::resync(uint64_t now_ms) {
+    std::vector<Timer::ptr> all;
+    takeAll(all);
+    m_current = now_ms;
+    // 定时器保留原下次执行时间，与 set 后端一致：回退前插入的定时器推迟到时钟追上，之后插入的按时到期
+    for (auto &timer : all) {
+        add(timer);
+    }
+}
+
+uint64_t TimingWheel::nextExpire() const {
+    if (m_size == 0) {
+        return ~0ull;
+    }
+    // 第0层：槽位即精确的超时时间
+    uint64_t next = ~0ull;
+    int dist = FindNextBit(m_bitmap, kRootSlots, m_current & (kRootSlots - 1));
+    if (dist >= 0) {
+        next = m_current + dist;
+    }
+    // 高层：各层最近一个非空槽的级联时间点可能早于第0层的定时器，取最小值
+    for (int level = 1; level < kLevels; ++level) {
+        int shift = Shift(level);
+        uint64_t word = m_bitmap[Base(level) >> 6];
+        if (!word) {
+            continue;
+        }
+        uint64_t tick = m_current >> shift;
+        int d = FindNextBit(&word, kLevelSlots, (tick + 1) & (kLevelSlots - 1));
+        uint64_t at = (tick + d + 1) << shift;
+        if (at < next) {
+            next = at;
+        }
+    }
+    return next;
+}
+}  // namespace IM
@@ -0,0 +1,145 @@
+/**
+ * @file timing_wheel.hpp
+ * @brief 分层时间轮
+ * @author DreamTraveler233
+ * @date 2026-01-10
+ *
+ * TimerManager 的时间轮后端，毫秒精度，插入与取消均为 O(1)：
+ * - 第0层 256 个槽，每槽 1ms，覆盖 256ms
+ * - 第1~4层各 64 个槽，每层槽宽依次为 2^8、2^14、2^20、2^26 毫秒，整体覆盖约 49 天
+ * - 超出范围的定时器先放在最高层，级联时按真实超时时间重新放置
+ * 定时器通过侵入式双向链表挂在槽上，每个槽是否非空记录在位图中，查找最近超时只需扫描位图。
+ * 时间轮本身不加锁，由 TimerManager 负责同步。
+ */
+
+#ifndef __IM_IO_TIMING_WHEEL_HPP__
+#define __IM_IO_TIMING_WHEEL_HPP__
+
+#include <vector>
+
+#include "core/base/noncopyable.hpp"
+
+#include "timer.hpp"
+
+namespace IM {
+/**
+ * @brief 分层时间轮
+ */
+class TimingWheel : public Noncopyable {
+   public:
+    /**
+     * @brief 构造函数
+     * @param[in] now_ms 当前时间(毫秒)，作为时间轮的起始刻度
+     */
+    explicit TimingWheel(uint64_t now_ms);
+
+    /**
+     * @brief 析构函数，释放时间轮持有的全部定时器引用
+     */
+    ~TimingWheel();
+
+    /**
+     * @brief 按定时器的下次执行时间放入对应槽位，O(1)
+     * @param[in] timer 定时器，放入后时间轮持有一份引用
+     */
+    void add(const Timer::ptr &timer);
+
+    /**
+     * @brief 从时间轮中摘除定时器，O(1)
+     * @param[in] timer 定时器
+     * @return Timer::ptr 时间轮持有的引用，定时器不在时间轮中时返回nullptr
+     */
+    Timer::ptr remove(Timer *timer);
+
+    /**
+     * @brief 推进时间轮到 now_ms，取出所有已到期的定时器
+     * @details now_ms 早于当前刻度(时钟回退)时先 resync
+     * @param[in] now_ms 当前时间(毫秒)
+     * @param[out] expired 已到期的定时器
+     */
+    void expire(uint64_t now_ms, std::vector<Timer::ptr> &expired);
+
+    /**
+     * @brief 取出全部定时器(时钟回退时使用)
+     * @param[out] out 全部定时器
+     */
+    void takeAll(std::vector<Timer::ptr> &out);
+
+    /**
+     * @brief 把当前刻度重置为 now_ms 并重新放置全部定时器(时钟回退时使用)
+     * @details 回退后插入的定时器早于原刻度，只有重新放置才能按时到期
+     * @param[in] now_ms 当前时间(毫秒)
+     */
+    void resync(uint64_t now_ms);
+
+    /**
+     * @brief 当前刻度(毫秒)
+     */
+    uint64_t current() const { return m_current; }
+
+    /**
+     * @brief 最近一次需要处理时间轮的时间点(毫秒)
+     * @details 第0层槽位给出精确的超时时间，高层槽位给出该槽级联的时间点(不晚于槽内最早的定时器)，
+     *          因此返回值是最近超时时间的下界，调用方据此唤醒不会错过定时器
+     * @return uint64_t 时间点，时间轮为空时返回~0ull
+     */
+    uint64_t nextExpire() const;
+
+    /**
+     * @brief 定时器数量
+     */
+    size_t size() const { return m_size; }
+
+    /**
+     * @brief 是否为空
+     */
+    bool empty() const { return m_size == 0; }
+
+   private:
+    static constexpr int kLevels = 5;           ///< 层数
+    static constexpr int kRootBits = 8;         ///< 第0层槽位数的位数
+    static constexpr int kLevelBits = 6;        ///< 第1~4层槽位数的位数
+    static constexpr int kRootSlots = 1 << kRootBits;
+    static constexpr int kLevelSlots = 1 << kLevelBits;
+    static constexpr int kSlots = kRootSlots + (kLevels - 1) * kLevelSlots;
+
+    /**
+     * @brief 第level层的槽宽位移
+     */
+    static int Shift(int level) { return level == 0 ? 0 : kRootBits + (level - 1) * kLevelBits; }
+
+    /**
+     * @brief 第level层第0个槽的全局下标
+     */
+    static int Base(int level) { return level == 0 ? 0 : kRootSlots + (level - 1) * kLevelSlots; }
+
+    /**
+     * @brief 把定时器挂到指定槽位
+     */
+    void link(Timer *timer, int slot);
+
+    /**
+     * @brief 把定时器从所在槽位摘下
+     */
+    void unlink(Timer *timer);
+
+    /**
+     * @brief 放置定时器(不增加引用计数)
+     */
+    void place(Timer *timer);
+
+    /**
+     * @brief 把第level层当前刻度对应的槽内定时器重新放置到更低层
+     * @return int 该槽在本层的下标，为0时需要继续级联上一层
+     */
+    int cascade(int level);
+
+   private:
+    uint64_t m_current;                    ///< 当前刻度(毫秒)，早于它的槽均已处理
+    size_t m_size = 0;                     ///< 定时器数量
+    Timer *m_slots[kSlots] = {};           ///< 各槽位链表头
+    uint64_t m_bitmap[kSlots / 64] = {};   ///< 槽位非空位图
+};
+}  // namespace IM
+
+#endif  // __IM_IO_TIMING_WHEEL_HPP__
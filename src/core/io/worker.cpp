@@ -4,6 +4,8 @@
 #include "core/util/util.hpp"
 
 namespace IM {
+static auto g_logger = IM_LOG_NAME("system");
+
 static auto g_worker_config =
     Config::Lookup("workers", std::map<std::string, std::map<std::string, std::string>>(), "worker config");
 
@@ -59,13 +61,26 @@ bool WorkerManager::init(const std::map<std::string, std::map<std::string, std::
         std::string name = i.first;
         int32_t thread_num = GetParamValue(i.second, "thread_num", 1);
         int32_t worker_num = GetParamValue(i.second, "worker_num", 1);
+        // 空闲线程睡眠前自旋轮询的时间上限(微秒)，未配置时使用 iomanager.spin_us
+        int32_t spin_us = GetParamValue(i.second, "spin_us", -1);
+        // CPU集合(如 "0-3,8")、NUMA节点与是否逐线程绑核，见 cpu_affinity.hpp
+        std::string cpu_pin = GetParamValue<std::string>(i.second, "cpu_pin", "false");
+        ThreadAffinity affinity = ThreadAffinity::Create(GetParamValue<std::string>(i.second, "cpus", ""),
+                                                         GetParamValue(i.second, "numa_node", -1),
+                                                         cpu_pin == "true" || cpu_pin == "1");
+        if (!affinity.empty()) {
+            IM_LOG_INFO(g_logger) << "worker " << name << " affinity " << affinity.toString();
+        }
 
         for (int32_t x = 0; x < worker_num; ++x) {
-            Scheduler::ptr s;
+            IOManager::ptr s;
             if (!x) {
-                s = std::make_shared<IOManager>(thread_num, false, name);
+                s = std::make_shared<IOManager>(thread_num, false, name, affinity);
             } else {
-                s = std::make_shared<IOManager>(thread_num, false, name + "-" + std::to_string(x));
+                s = std::make_shared<IOManager>(thread_num, false, name + "-" + std::to_string(x), affinity);
+            }
+            if (spin_us >= 0) {
+                s->setSpinUs(spin_us);
             }
             add(s);
         }
@@ -13,6 +13,7 @@ FdCtx::FdCtx(int fd)
       m_sysNonBlock(false),
       m_userNonBlock(false),
       m_isClosed(false),
+      m_ignoreDeadline(false),
       m_fd(fd),
       m_recvTimeout(-1),
       m_sendTimeout(-1) {
@@ -64,6 +65,7 @@ bool FdCtx::init() {
 
     m_userNonBlock = false;
     m_isClosed = false;
+    m_ignoreDeadline = false;
     return m_isInit;
 }
 
@@ -116,6 +118,14 @@ uint64_t FdCtx::getTimeout(int type) const {
     return -1;
 }
 
+void FdCtx::setIgnoreDeadline(bool v) {
+    m_ignoreDeadline = v;
+}
+
+bool FdCtx::getIgnoreDeadline() const {
+    return m_ignoreDeadline;
+}
+
 FdManager::FdManager() {
     m_fdCtxs.resize(64);
 }
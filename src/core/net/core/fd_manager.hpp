@@ -115,15 +115,29 @@ class FdCtx : public std::enable_shared_from_this<FdCtx> {
      */
     uint64_t getTimeout(int type) const;
 
+    /**
+     * @brief 设置阻塞等待是否不受请求截止时间限制
+     * @details 用于 MySQL/Redis 等同步协议连接：回复读到一半被截止时间打断后连接状态错乱，
+     *          连接池会继续复用这条坏连接。这类连接只按自身的超时设置等待，命令在发出前检查截止时间
+     * @param[in] v true表示忽略截止时间
+     */
+    void setIgnoreDeadline(bool v);
+
+    /**
+     * @brief 阻塞等待是否不受请求截止时间限制
+     */
+    bool getIgnoreDeadline() const;
+
    private:
-    bool m_isInit : 1;        // 占用1个bit，表示对象是否已初始化
-    bool m_isSocket : 1;      // 占用1个bit，表示是否为socket文件描述符
-    bool m_sysNonBlock : 1;   // 占用1个bit，表示系统层面是否设置了非阻塞模式
-    bool m_userNonBlock : 1;  // 占用1个bit，表示用户是否设置了非阻塞模式
-    bool m_isClosed : 1;      // 占用1个bit，表示文件描述符是否已关闭
-    int m_fd;                 // 文件描述符
-    uint64_t m_recvTimeout;   // 接收超时时间
-    uint64_t m_sendTimeout;   // 发送超时时间
+    bool m_isInit : 1;          // 占用1个bit，表示对象是否已初始化
+    bool m_isSocket : 1;        // 占用1个bit，表示是否为socket文件描述符
+    bool m_sysNonBlock : 1;     // 占用1个bit，表示系统层面是否设置了非阻塞模式
+    bool m_userNonBlock : 1;    // 占用1个bit，表示用户是否设置了非阻塞模式
+    bool m_isClosed : 1;        // 占用1个bit，表示文件描述符是否已关闭
+    bool m_ignoreDeadline : 1;  // 占用1个bit，表示阻塞等待不受请求截止时间限制
+    int m_fd;                   // 文件描述符
+    uint64_t m_recvTimeout;     // 接收超时时间
+    uint64_t m_sendTimeout;     // 发送超时时间
 };
 
 /**
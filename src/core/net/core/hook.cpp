@@ -4,6 +4,7 @@
 #include <fcntl.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
+#include <type_traits>
 
 #include "core/base/macro.hpp"
 #include "core/config/config.hpp"
@@ -11,6 +12,7 @@
 #include "core/io/iomanager.hpp"
 #include "core/io/scheduler.hpp"
 #include "core/net/core/fd_manager.hpp"
+#include "core/util/deadline_context.hpp"
 
 namespace IM {
 Logger::ptr g_logger = IM_LOG_NAME("system");
@@ -96,12 +98,45 @@ void set_hook_enable(bool flag) {
     t_hook_enable = flag;
 }
 
+/**
+ * @brief 填写io_uring读写类提交项的公共字段
+ * @param[out] sqe 提交项
+ * @param[in] op 操作码
+ * @param[in] fd 文件描述符
+ * @param[in] addr 缓冲区/iovec/msghdr/sockaddr地址
+ * @param[in] len 长度或iovec个数
+ * @param[in] off 偏移，-1表示使用文件当前位置(accept时为addrlen地址)
+ */
+static void PrepRw(io_uring_sqe *sqe, int op, int fd, const void *addr, unsigned len, uint64_t off) {
+    sqe->opcode = op;
+    sqe->fd = fd;
+    sqe->addr = (uint64_t)addr;
+    sqe->len = len;
+    sqe->off = off;
+}
+
 // 用于跟踪定时器的状态
 // cancelled值为0表示未取消，ETIMEDOUT表示超时取消
 struct timer_info {
     int cancelled = 0;
 };
 
+/**
+ * @brief 当前线程的 errno
+ * @details 协程挂起后可能在其他线程恢复，而 __errno_location 被声明为 const 函数，编译器会把挂起前
+ *          取得的 errno 地址沿用到挂起之后，读写的仍是原线程的 errno。挂起点之后统一经由这个不参与
+ *          过程间优化的函数重新取地址
+ */
+#if defined(__GNUC__) && !defined(__clang__)
+#define IM_HOOK_NOIPA __attribute__((noipa))
+#else
+#define IM_HOOK_NOIPA __attribute__((noinline))
+#endif
+static IM_HOOK_NOIPA int &CurrentErrno() {
+    return errno;
+}
+#undef IM_HOOK_NOIPA
+
 /**
  * @brief 执行带有协程支持的IO操作
  * @tparam OriginFun 原始函数类型
@@ -111,6 +146,7 @@ struct timer_info {
  * @param hook_fun_name 被hook的函数名称
  * @param event IO事件类型（READ/WRITE）
  * @param timeout_so 超时设置选项（SO_RCVTIMEO/SO_SNDTIMEO）
+ * @param prep 填写io_uring提交项的函数对象，nullptr表示该操作只走epoll
  * @param args 传递给原始函数的参数包
  * @return 返回IO操作结果，成功返回传输字节数，失败返回-1并设置errno
  *
@@ -120,9 +156,11 @@ struct timer_info {
  * 3. 处理非阻塞IO操作
  * 4. 在IO阻塞时将当前协程挂起，并注册相应的事件监听
  * 5. 支持超时控制
+ * 6. IOManager 启用 io_uring 后端时，阻塞的操作整体提交给 io_uring，结果随完成事件返回
  */
-template <typename OriginFun, typename... Args>
-static ssize_t do_io(int fd, OriginFun fun, const char *hook_fun_name, uint32_t event, int timeout_so, Args &&...args) {
+template <typename OriginFun, typename Prep, typename... Args>
+static ssize_t do_io(int fd, OriginFun fun, const char *hook_fun_name, uint32_t event, int timeout_so, const Prep &prep,
+                     Args &&...args) {
     // ==========判断是否启用hook==========
     if (!is_hook_enable()) {
         return fun(fd, std::forward<Args>(args)...);
@@ -154,21 +192,47 @@ retry:
     // 尝试执行原始IO操作
     ssize_t n = fun(fd, std::forward<Args>(args)...);
     // 如果被信号中断，则重试
-    while (n == -1 && errno == EINTR) {
+    while (n == -1 && CurrentErrno() == EINTR) {
         n = fun(fd, std::forward<Args>(args)...);
     }
 
     // 如果是因为缓冲区无数据/无法写入导致的阻塞
-    if (n == -1 && errno == EAGAIN) {
+    if (n == -1 && CurrentErrno() == EAGAIN) {
         IOManager *iom = IOManager::GetThis();
+
+        // 等待时间不超过当前请求的剩余时间，已过期则不再等待(同步协议的数据库连接除外)
+        uint64_t wait_timeout = ctx->getIgnoreDeadline() ? timeout : DeadlineContext::Clamp(timeout);
+        if (wait_timeout == 0) {
+            CurrentErrno() = ETIMEDOUT;
+            return -1;
+        }
+
+        // io_uring 后端：一次提交完成等待与读写，省去 epoll_ctl 挂载与唤醒后的再次调用
+        // 共享栈协程挂起时栈内容被换出，内核不能异步写入栈上的缓冲区，仍走 epoll
+        if constexpr (!std::is_same<Prep, std::nullptr_t>::value) {
+            IoUring *uring = iom->getIoUring();
+            if (uring && !Coroutine::GetThis()->isSharedStack()) {
+                ssize_t rt = uring->await(prep, wait_timeout);
+                if (rt != -EBUSY) {
+                    if (rt >= 0) {
+                        return rt;
+                    }
+                    // 等待期间 fd 被关闭(close 取消了未完成的操作)，与 epoll 路径一样返回 EBADF
+                    CurrentErrno() = rt == -ECANCELED ? EBADF : (int)-rt;
+                    return -1;
+                }
+                // 提交队列已满，本次退回 epoll
+            }
+        }
+
         Timer::ptr timer;
         std::weak_ptr<timer_info> winfo(tinfo);
 
-        if (timeout != (uint64_t)-1)  // 判断是否设置了超时时间
+        if (wait_timeout != (uint64_t)-1)  // 判断是否设置了超时时间
         {
             // 设置一个条件定时器来实现超时控制
             timer = iom->addConditionTimer(
-                timeout,
+                wait_timeout,
                 [winfo, fd, iom, event]() {
                     auto t = winfo.lock();
                     // 如果转换失败或者cancelled已被设置，直接返回
@@ -204,7 +268,7 @@ retry:
 
         // 如果定时器触发（超时），设置错误码并返回
         if (tinfo->cancelled) {
-            errno = tinfo->cancelled;
+            CurrentErrno() = tinfo->cancelled;
             return -1;
         }
         // 重新尝试IO操作
@@ -379,6 +443,13 @@ int connect_with_timeout(int fd, const struct sockaddr *addr, socklen_t addrlen,
         return n;
     }
 
+    // 等待时间不超过当前请求的剩余时间
+    timeout_ms = DeadlineContext::Clamp(timeout_ms);
+    if (timeout_ms == 0) {
+        errno = ETIMEDOUT;
+        return -1;
+    }
+
     // 获取当前IO管理器
     IOManager *iom = IOManager::GetThis();
     Timer::ptr timer;
@@ -421,7 +492,7 @@ int connect_with_timeout(int fd, const struct sockaddr *addr, socklen_t addrlen,
 
         // 检查是否因超时取消
         if (tinfo->cancelled) {
-            errno = tinfo->cancelled;
+            CurrentErrno() = tinfo->cancelled;
             return -1;
         }
     }
@@ -437,7 +508,7 @@ int connect_with_timeout(int fd, const struct sockaddr *addr, socklen_t addrlen,
     if (!error) {
         return 0;
     } else {
-        errno = error;
+        CurrentErrno() = error;
         return -1;
     }
 }
@@ -469,7 +540,9 @@ int connect(int sockfd, const struct sockaddr *addr, socklen_t addrlen) {
  *          3. 支持超时控制，超时时间由SO_RCVTIMEO选项决定
  */
 int accept(int sockfd, struct sockaddr *addr, socklen_t *addrlen) {
-    int fd = do_io(sockfd, accept_f, "accept", IOManager::READ, SO_RCVTIMEO, addr, addrlen);
+    int fd = do_io(
+        sockfd, accept_f, "accept", IOManager::READ, SO_RCVTIMEO,
+        [&](io_uring_sqe *sqe) { PrepRw(sqe, IORING_OP_ACCEPT, sockfd, addr, 0, (uint64_t)addrlen); }, addr, addrlen);
     if (fd >= 0) {
         FdMgr::GetInstance()->get(fd, true);
     }
@@ -487,7 +560,9 @@ int accept(int sockfd, struct sockaddr *addr, socklen_t *addrlen) {
  *          超时时间由文件描述符的SO_RCVTIMEO选项决定。
  */
 ssize_t read(int fd, void *buf, size_t count) {
-    return do_io(fd, read_f, "read", IOManager::READ, SO_RCVTIMEO, buf, count);
+    return do_io(
+        fd, read_f, "read", IOManager::READ, SO_RCVTIMEO,
+        [&](io_uring_sqe *sqe) { PrepRw(sqe, IORING_OP_READ, fd, buf, count, (uint64_t)-1); }, buf, count);
 }
 
 /**
@@ -501,7 +576,9 @@ ssize_t read(int fd, void *buf, size_t count) {
  *          超时时间由文件描述符的SO_RCVTIMEO选项决定。
  */
 ssize_t readv(int fd, const struct iovec *iov, int iovcnt) {
-    return do_io(fd, readv_f, "readv", IOManager::READ, SO_RCVTIMEO, iov, iovcnt);
+    return do_io(
+        fd, readv_f, "readv", IOManager::READ, SO_RCVTIMEO,
+        [&](io_uring_sqe *sqe) { PrepRw(sqe, IORING_OP_READV, fd, iov, iovcnt, (uint64_t)-1); }, iov, iovcnt);
 }
 
 /**
@@ -516,7 +593,13 @@ ssize_t readv(int fd, const struct iovec *iov, int iovcnt) {
  *          超时时间由文件描述符的SO_RCVTIMEO选项决定。
  */
 ssize_t recv(int sockfd, void *buf, size_t len, int flags) {
-    return do_io(sockfd, recv_f, "recv", IOManager::READ, SO_RCVTIMEO, buf, len, flags);
+    return do_io(
+        sockfd, recv_f, "recv", IOManager::READ, SO_RCVTIMEO,
+        [&](io_uring_sqe *sqe) {
+            PrepRw(sqe, IORING_OP_RECV, sockfd, buf, len, 0);
+            sqe->msg_flags = flags;
+        },
+        buf, len, flags);
 }
 
 /**
@@ -533,7 +616,8 @@ ssize_t recv(int sockfd, void *buf, size_t len, int flags) {
  *          在阻塞时能够自动让出协程控制权。超时时间由文件描述符的SO_RCVTIMEO选项决定。
  */
 ssize_t recvfrom(int sockfd, void *buf, size_t len, int flags, struct sockaddr *src_addr, socklen_t *addrlen) {
-    return do_io(sockfd, recvfrom_f, "recvfrom", IOManager::READ, SO_RCVTIMEO, buf, len, flags, src_addr, addrlen);
+    return do_io(sockfd, recvfrom_f, "recvfrom", IOManager::READ, SO_RCVTIMEO, nullptr, buf, len, flags, src_addr,
+                 addrlen);
 }
 
 /**
@@ -547,7 +631,13 @@ ssize_t recvfrom(int sockfd, void *buf, size_t len, int flags, struct sockaddr *
  *          超时时间由文件描述符的SO_RCVTIMEO选项决定。
  */
 ssize_t recvmsg(int sockfd, struct msghdr *msg, int flags) {
-    return do_io(sockfd, recvmsg_f, "recvmsg", IOManager::READ, SO_RCVTIMEO, msg, flags);
+    return do_io(
+        sockfd, recvmsg_f, "recvmsg", IOManager::READ, SO_RCVTIMEO,
+        [&](io_uring_sqe *sqe) {
+            PrepRw(sqe, IORING_OP_RECVMSG, sockfd, msg, 1, 0);
+            sqe->msg_flags = flags;
+        },
+        msg, flags);
 }
 
 /**
@@ -561,7 +651,9 @@ ssize_t recvmsg(int sockfd, struct msghdr *msg, int flags) {
  *          超时时间由文件描述符的SO_SNDTIMEO选项决定。
  */
 ssize_t write(int fd, const void *buf, size_t count) {
-    return do_io(fd, write_f, "write", IOManager::WRITE, SO_SNDTIMEO, buf, count);
+    return do_io(
+        fd, write_f, "write", IOManager::WRITE, SO_SNDTIMEO,
+        [&](io_uring_sqe *sqe) { PrepRw(sqe, IORING_OP_WRITE, fd, buf, count, (uint64_t)-1); }, buf, count);
 }
 
 /**
@@ -575,7 +667,9 @@ ssize_t write(int fd, const void *buf, size_t count) {
  *          超时时间由文件描述符的SO_SNDTIMEO选项决定。
  */
 ssize_t writev(int fd, const struct iovec *iov, int iovcnt) {
-    return do_io(fd, writev_f, "writev", IOManager::WRITE, SO_SNDTIMEO, iov, iovcnt);
+    return do_io(
+        fd, writev_f, "writev", IOManager::WRITE, SO_SNDTIMEO,
+        [&](io_uring_sqe *sqe) { PrepRw(sqe, IORING_OP_WRITEV, fd, iov, iovcnt, (uint64_t)-1); }, iov, iovcnt);
 }
 
 /**
@@ -590,7 +684,13 @@ ssize_t writev(int fd, const struct iovec *iov, int iovcnt) {
  *          超时时间由文件描述符的SO_SNDTIMEO选项决定。
  */
 ssize_t send(int sockfd, const void *buf, size_t len, int flags) {
-    return do_io(sockfd, send_f, "send", IOManager::WRITE, SO_SNDTIMEO, buf, len, flags);
+    return do_io(
+        sockfd, send_f, "send", IOManager::WRITE, SO_SNDTIMEO,
+        [&](io_uring_sqe *sqe) {
+            PrepRw(sqe, IORING_OP_SEND, sockfd, buf, len, 0);
+            sqe->msg_flags = flags;
+        },
+        buf, len, flags);
 }
 
 /**
@@ -608,7 +708,8 @@ ssize_t send(int sockfd, const void *buf, size_t len, int flags) {
  */
 ssize_t sendto(int sockfd, const void *buf, size_t len, int flags, const struct sockaddr *dest_addr,
                socklen_t addrlen) {
-    return do_io(sockfd, sendto_f, "sendto", IOManager::WRITE, SO_SNDTIMEO, buf, len, flags, dest_addr, addrlen);
+    return do_io(sockfd, sendto_f, "sendto", IOManager::WRITE, SO_SNDTIMEO, nullptr, buf, len, flags, dest_addr,
+                 addrlen);
 }
 
 /**
@@ -622,7 +723,13 @@ ssize_t sendto(int sockfd, const void *buf, size_t len, int flags, const struct
  *          超时时间由文件描述符的SO_SNDTIMEO选项决定。
  */
 ssize_t sendmsg(int sockfd, const struct msghdr *msg, int flags) {
-    return do_io(sockfd, sendmsg_f, "sendmsg", IOManager::WRITE, SO_SNDTIMEO, msg, flags);
+    return do_io(
+        sockfd, sendmsg_f, "sendmsg", IOManager::WRITE, SO_SNDTIMEO,
+        [&](io_uring_sqe *sqe) {
+            PrepRw(sqe, IORING_OP_SENDMSG, sockfd, msg, 1, 0);
+            sqe->msg_flags = flags;
+        },
+        msg, flags);
 }
 
 /**
@@ -645,6 +752,10 @@ int close(int fd) {
         if (iom) {
             // 取消该文件描述符上所有IO事件监听
             iom->cancelAll(fd);
+            // 取消提交到io_uring尚未完成的操作，等待的协程以EBADF返回
+            if (iom->getIoUring()) {
+                iom->getIoUring()->cancelFd(fd);
+            }
         }
         // 从管理器中删除该文件描述符的上下文
         FdMgr::GetInstance()->del(fd);
@@ -779,7 +890,6 @@ int ioctl(int fd, unsigned long request, ...) {
     }
     return ioctl_f(fd, request, arg);
 }
-}
 
 /**
  * @brief 重写的getsockopt函数
@@ -818,11 +928,14 @@ int setsockopt(int sockfd, int level, int optname, const void *optval, socklen_t
             FdCtx::ptr ctx = FdMgr::GetInstance()->get(sockfd);
             if (ctx) {
                 // 将传入的timeval结构体转换为毫秒数，并设置到上下文中的超时时间
+                // 0 表示不超时
                 const timeval *tv = (const timeval *)optval;
-                ctx->setTimeout(optname, tv->tv_sec * 1000 + tv->tv_usec / 1000);
+                uint64_t ms = tv->tv_sec * 1000 + tv->tv_usec / 1000;
+                ctx->setTimeout(optname, ms ? ms : (uint64_t)-1);
             }
         }
     }
     return setsockopt_f(sockfd, level, optname, optval, optlen);
 }
+}
 }  // namespace IM
\ No newline at end of file
@@ -130,6 +130,17 @@ Socket::ptr Socket::accept() {
     return nullptr;
 }
 
+bool Socket::setReusePort() {
+    if (!isValid()) {
+        newSock();
+        if (IM_UNLIKELY(!isValid())) {
+            return false;
+        }
+    }
+    int val = 1;
+    return setOption(SOL_SOCKET, SO_REUSEPORT, val);
+}
+
 bool Socket::bind(const Address::ptr addr) {
     if (!isValid()) {
         newSock();
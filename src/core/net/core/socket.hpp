@@ -209,6 +209,13 @@ class Socket : public std::enable_shared_from_this<Socket>, Noncopyable {
      */
     virtual Socket::ptr accept();
 
+    /**
+     * @brief 开启 SO_REUSEPORT，多个 socket 可绑定同一地址，内核在它们之间分发新连接
+     * @pre 在 bind 之前调用，尚未创建句柄时先创建
+     * @return 是否设置成功
+     */
+    bool setReusePort();
+
     /**
      * @brief 绑定地址
      * @param[in] addr 地址
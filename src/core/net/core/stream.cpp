@@ -1,5 +1,7 @@
 #include "core/net/core/stream.hpp"
 
+#include <algorithm>
+
 namespace IM {
 int Stream::readFixSize(void *buffer, size_t length) {
     size_t offset = 0;  // 偏移量
@@ -55,4 +57,43 @@ int Stream::writeFixSize(ByteArray::ptr ba, size_t length) {
     }
     return length;
 }
+
+int Stream::writev(const iovec *iov, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        if (iov[i].iov_len) {
+            return write(iov[i].iov_base, iov[i].iov_len);
+        }
+    }
+    return 0;
+}
+
+int Stream::writevFixSize(iovec *iov, size_t count) {
+    size_t length = 0;
+    for (size_t i = 0; i < count; ++i) {
+        length += iov[i].iov_len;
+    }
+    while (count > 0) {
+        // 跳过已写完(或本身为空)的内存段
+        if (!iov->iov_len) {
+            ++iov;
+            --count;
+            continue;
+        }
+        int64_t len = writev(iov, count);
+        if (len <= 0) {
+            return len;
+        }
+        while (len > 0) {
+            size_t n = std::min((size_t)len, iov->iov_len);
+            iov->iov_base = (char *)iov->iov_base + n;
+            iov->iov_len -= n;
+            len -= n;
+            if (!iov->iov_len) {
+                ++iov;
+                --count;
+            }
+        }
+    }
+    return length;
+}
 }  // namespace IM
\ No newline at end of file
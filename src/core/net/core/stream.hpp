@@ -114,6 +114,26 @@ class Stream {
      */
     virtual int writeFixSize(ByteArray::ptr ba, size_t length);
 
+    /**
+     * @brief 聚集写，一次写出多段内存
+     * @param[in] iov 内存段
+     * @param[in] count 内存段数量
+     * @return 实际写入的字节数，0表示流已关闭，负数表示出错
+     *
+     * @note 默认实现只写出第一段非空内存，支持聚集写的派生类(如SocketStream)应重写为一次 writev
+     */
+    virtual int writev(const iovec *iov, size_t count);
+
+    /**
+     * @brief 聚集写出全部内存段
+     * @param[in,out] iov 内存段，部分写入时会被修改为剩余部分
+     * @param[in] count 内存段数量
+     * @return 写入的总字节数，0表示流已关闭，负数表示出错
+     *
+     * @note 与writev不同，该函数会持续写入直到全部完成或出错
+     */
+    int writevFixSize(iovec *iov, size_t count);
+
     /**
      * @brief 关闭流
      *
@@ -1,12 +1,14 @@
 #include "core/net/core/tcp_server.hpp"
 
+#include <algorithm>
+
 #include "core/base/macro.hpp"
 #include "core/config/config.hpp"
 
 namespace IM {
 static IM::Logger::ptr g_logger = IM_LOG_NAME("system");
 
-// 配置 TCP 读超时事件
+// 配置 TCP 读超时事件：新连接在该时间内读不到数据时 hook 的读操作返回 ETIMEDOUT，连接随之断开
 static auto g_tcp_server_read_timeout =
     IM::Config::Lookup("tcp_server.read_timeout", (uint64_t)(60 * 1000 * 2), "tcp server read timeout");
 
@@ -27,6 +29,8 @@ TcpServer::~TcpServer() {
 
 void TcpServer::setConf(const TcpServerConf &v) {
     m_conf.reset(new TcpServerConf(v));
+    m_sharedStack = v.shared_stack;
+    m_reusePort = v.reuse_port;
 }
 
 bool TcpServer::bind(IM::Address::ptr addr, bool ssl) {
@@ -38,26 +42,42 @@ bool TcpServer::bind(IM::Address::ptr addr, bool ssl) {
 
 bool TcpServer::bind(const std::vector<Address::ptr> &addrs, std::vector<Address::ptr> &fails, bool ssl) {
     m_ssl = ssl;
+
+    // SO_REUSEPORT 模式：每个地址为 IO 调度器的每个工作线程各创建一个监听 socket
+    size_t listeners = m_reusePort ? std::max<size_t>(1, m_ioWorker->getWorkerCount()) : 1;
+
     for (auto &addr : addrs) {
-        // 根据是否启用ssl加密创建 Socket
-        Socket::ptr sock = ssl ? SSLSocket::CreateTCP(addr) : Socket::CreateTCP(addr);
-
-        // 绑定地址
-        if (!sock->bind(addr)) {
-            IM_LOG_ERROR(g_logger) << "bind fail errno=" << errno << " errstr=" << strerror(errno) << " addr=["
-                                   << addr->toString() << "]";
-            fails.push_back(addr);
-            continue;
-        }
+        Address::ptr bind_addr = addr;
+        for (size_t i = 0; i < listeners; ++i) {
+            // 根据是否启用ssl加密创建 Socket
+            Socket::ptr sock = ssl ? SSLSocket::CreateTCP(addr) : Socket::CreateTCP(addr);
+
+            if (m_reusePort && !sock->setReusePort()) {
+                IM_LOG_ERROR(g_logger) << "setReusePort fail errno=" << errno << " errstr=" << strerror(errno)
+                                       << " addr=[" << addr->toString() << "]";
+                fails.push_back(addr);
+                break;
+            }
 
-        // 开启监听
-        if (!sock->listen(4096)) {
-            IM_LOG_ERROR(g_logger) << "listen fail errno=" << errno << " errstr=" << strerror(errno) << " addr=["
-                                   << addr->toString() << "]";
-            fails.push_back(addr);
-            continue;
+            // 绑定地址
+            if (!sock->bind(bind_addr)) {
+                IM_LOG_ERROR(g_logger) << "bind fail errno=" << errno << " errstr=" << strerror(errno) << " addr=["
+                                       << addr->toString() << "]";
+                fails.push_back(addr);
+                break;
+            }
+
+            // 开启监听
+            if (!sock->listen(4096)) {
+                IM_LOG_ERROR(g_logger) << "listen fail errno=" << errno << " errstr=" << strerror(errno) << " addr=["
+                                       << addr->toString() << "]";
+                fails.push_back(addr);
+                break;
+            }
+            // 端口为0时由内核分配，其余监听 socket 绑定第一个 socket 实际得到的端口
+            bind_addr = sock->getLocalAddress();
+            m_socks.push_back(sock);
         }
-        m_socks.push_back(sock);
     }
 
     if (!fails.empty()) {
@@ -67,7 +87,7 @@ bool TcpServer::bind(const std::vector<Address::ptr> &addrs, std::vector<Address
 
     for (auto &i : m_socks) {
         IM_LOG_INFO(g_logger) << "type=" << m_type << " name=" << m_name << " ssl=" << m_ssl
-                              << " server bind success: " << *i;
+                              << " reuse_port=" << m_reusePort << " server bind success: " << *i;
     }
     return true;
 }
@@ -78,8 +98,10 @@ bool TcpServer::start() {
     }
     m_isRun = true;
 
+    // SO_REUSEPORT 模式下 accept 循环直接运行在 IO 调度器上
+    IOManager *accept_worker = m_reusePort ? m_ioWorker : m_acceptWorker;
     for (auto &sock : m_socks) {
-        m_acceptWorker->schedule(std::bind(&TcpServer::startAccept, shared_from_this(), sock));
+        accept_worker->schedule(std::bind(&TcpServer::startAccept, shared_from_this(), sock));
     }
     return true;
 }
@@ -89,9 +111,21 @@ void TcpServer::startAccept(Socket::ptr sock) {
         // 接受新连接
         Socket::ptr client_fd = sock->accept();
         if (client_fd) {
-            // 设置读超时时间
-            client_fd->setRecvTimeout(m_recvTimeout);
-            m_ioWorker->schedule(std::bind(&TcpServer::handleClient, shared_from_this(), client_fd));
+            // 设置读超时时间，~0ull 表示不设置(长连接由上层自行探活)
+            if (m_recvTimeout != (uint64_t)-1) {
+                client_fd->setRecvTimeout(m_recvTimeout);
+            }
+            // SO_REUSEPORT 模式下新连接留在接受它的 IO 线程上处理，投递到本线程信箱无需唤醒其他线程
+            uint64_t tid = m_reusePort ? GetThreadId() : -1;
+            if (m_sharedStack) {
+                // 每个连接一个共享栈协程，空闲时只占用栈快照
+                m_ioWorker->schedule(Coroutine::ptr(new Coroutine(
+                                         std::bind(&TcpServer::handleClient, shared_from_this(), client_fd), 0, false,
+                                         true)),
+                                     tid);
+            } else {
+                m_ioWorker->schedule(std::bind(&TcpServer::handleClient, shared_from_this(), client_fd), tid);
+            }
         } else {
             IM_LOG_ERROR(g_logger) << "accept errno=" << errno << " errstr=" << strerror(errno);
         }
@@ -105,7 +139,9 @@ void TcpServer::handleClient(Socket::ptr client) {
 void TcpServer::stop() {
     m_isRun = false;
     auto self = shared_from_this();
-    m_acceptWorker->schedule([this, self]() {
+    // 监听 socket 注册在运行 accept 循环的调度器上，取消等待需在该调度器内进行
+    IOManager *accept_worker = m_reusePort ? m_ioWorker : m_acceptWorker;
+    accept_worker->schedule([this, self]() {
         for (auto &sock : m_socks) {
             sock->cancelAll();
             sock->close();
@@ -140,6 +176,8 @@ TcpServerConf::ptr TcpServer::getConf() const {
 
 void TcpServer::setConf(TcpServerConf::ptr v) {
     m_conf = v;
+    m_sharedStack = v && v->shared_stack;
+    m_reusePort = v && v->reuse_port;
 }
 
 bool TcpServer::loadCertificates(const std::string &cert_file, const std::string &key_file) {
@@ -158,7 +196,8 @@ std::string TcpServer::toString(const std::string &prefix) {
     std::stringstream ss;
     ss << prefix << "[type=" << m_type << " name=" << m_name << " ssl=" << m_ssl
        << " worker=" << (m_worker ? m_worker->getName() : "")
-       << " accept=" << (m_acceptWorker ? m_acceptWorker->getName() : "") << " recv_timeout=" << m_recvTimeout << "]"
+       << " accept=" << (m_acceptWorker ? m_acceptWorker->getName() : "") << " recv_timeout=" << m_recvTimeout
+       << " reuse_port=" << m_reusePort << "]"
        << std::endl;
     std::string pfx = prefix.empty() ? "    " : prefix;
     for (auto &i : m_socks) {
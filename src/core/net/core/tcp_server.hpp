@@ -14,6 +14,7 @@
  * - SSL/TLS加密连接支持
  * - 可配置的超时时间和keepalive机制
  * - 灵活的工作线程模型
+ * - 可选的 SO_REUSEPORT 多监听模式：每个 IO 线程一个监听 socket 并行 accept
  */
 
 #ifndef __IM_NET_CORE_TCP_SERVER_HPP__
@@ -41,6 +42,8 @@ struct TcpServerConf {
     int keepalive = 0;                        /// keepalive选项
     int timeout = 1000 * 2 * 60;              /// 超时时间(毫秒)，默认4分钟
     int ssl = 0;                              /// 是否启用SSL
+    int shared_stack = 0;                     /// 连接协程是否运行在共享栈上(适合大量空闲长连接)
+    int reuse_port = 0;                       /// 每个IO线程一个SO_REUSEPORT监听socket，连接留在接受线程处理
     std::string id;                           /// 服务器唯一标识
     std::string type = "http";                /// 服务器类型，如"http", "ws", "rock"
     std::string name;                         /// 服务器名称
@@ -66,7 +69,8 @@ struct TcpServerConf {
         return address == oth.address && keepalive == oth.keepalive && timeout == oth.timeout && name == oth.name &&
                ssl == oth.ssl && cert_file == oth.cert_file && key_file == oth.key_file &&
                accept_worker == oth.accept_worker && io_worker == oth.io_worker &&
-               process_worker == oth.process_worker && args == oth.args && id == oth.id && type == oth.type;
+               process_worker == oth.process_worker && args == oth.args && id == oth.id && type == oth.type &&
+               shared_stack == oth.shared_stack && reuse_port == oth.reuse_port;
     }
 };
 
@@ -82,6 +86,8 @@ class LexicalCast<std::string, TcpServerConf> {
         conf.timeout = node["timeout"].as<int>(conf.timeout);
         conf.name = node["name"].as<std::string>(conf.name);
         conf.ssl = node["ssl"].as<int>(conf.ssl);
+        conf.shared_stack = node["shared_stack"].as<int>(conf.shared_stack);
+        conf.reuse_port = node["reuse_port"].as<int>(conf.reuse_port);
         conf.cert_file = node["cert_file"].as<std::string>(conf.cert_file);
         conf.key_file = node["key_file"].as<std::string>(conf.key_file);
         conf.accept_worker = node["accept_worker"].as<std::string>();
@@ -108,6 +114,8 @@ class LexicalCast<TcpServerConf, std::string> {
         node["keepalive"] = conf.keepalive;
         node["timeout"] = conf.timeout;
         node["ssl"] = conf.ssl;
+        node["shared_stack"] = conf.shared_stack;
+        node["reuse_port"] = conf.reuse_port;
         node["cert_file"] = conf.cert_file;
         node["key_file"] = conf.key_file;
         node["accept_worker"] = conf.accept_worker;
@@ -210,7 +218,7 @@ class TcpServer : public std::enable_shared_from_this<TcpServer>, Noncopyable {
 
     /**
      * @brief 设置读取超时时间(毫秒)
-     * @param[in] v 超时时间
+     * @param[in] v 超时时间，~0ull 表示新连接不设置读超时
      */
     void setRecvTimeout(uint64_t v);
 
@@ -244,6 +252,34 @@ class TcpServer : public std::enable_shared_from_this<TcpServer>, Noncopyable {
      */
     void setConf(const TcpServerConf &v);
 
+    /**
+     * @brief 设置连接协程是否运行在共享栈上
+     * @details 开启后每个连接的处理协程不再独占一块栈，挂起时只保存实际使用的栈帧，
+     *          适合 WebSocket 等大量长期空闲的长连接，代价是协程切换时的栈拷贝
+     * @param[in] v 是否启用
+     */
+    void setSharedStack(bool v) { m_sharedStack = v; }
+
+    /**
+     * @brief 连接协程是否运行在共享栈上
+     */
+    bool isSharedStack() const { return m_sharedStack; }
+
+    /**
+     * @brief 设置是否启用 SO_REUSEPORT 多监听模式
+     * @details 开启后 bind 为 IO 调度器的每个工作线程各创建一个绑定同一地址的监听 socket，由内核分摊新连接；
+     *          accept 循环运行在 IO 调度器上，新连接直接交给接受它的线程处理，不经过 accept 调度器中转。
+     *          适合网关重启后大量客户端集中重连的场景
+     * @pre 在 bind 之前调用
+     * @param[in] v 是否启用
+     */
+    void setReusePort(bool v) { m_reusePort = v; }
+
+    /**
+     * @brief 是否启用 SO_REUSEPORT 多监听模式
+     */
+    bool isReusePort() const { return m_reusePort; }
+
     /**
      * @brief 转换为字符串表示
      * @param[in] prefix 前缀字符串
@@ -281,6 +317,8 @@ class TcpServer : public std::enable_shared_from_this<TcpServer>, Noncopyable {
     std::string m_type = "tcp";        /// 服务器类型
     bool m_isRun;                      /// 服务是否运行
     bool m_ssl = false;                /// 是否启用SSL
+    bool m_sharedStack = false;        /// 连接协程是否运行在共享栈上
+    bool m_reusePort = false;          /// 是否启用SO_REUSEPORT多监听模式
     TcpServerConf::ptr m_conf;         /// 服务器配置
 };
 }  // namespace IM
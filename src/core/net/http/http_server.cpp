@@ -1,14 +1,21 @@
 #include "core/net/http/http_server.hpp"
 
 #include "core/base/macro.hpp"
+#include "core/config/config.hpp"
 #include "core/net/http/servlets/config_servlet.hpp"
+#include "core/net/http/servlets/metrics_servlet.hpp"
 #include "core/net/http/servlets/status_servlet.hpp"
+#include "core/util/deadline_context.hpp"
 #include "core/util/trace_context.hpp"
 
 namespace IM::http {
 
 static auto g_logger = IM_LOG_NAME("system");
 
+// 单个请求的处理时限，下游 RPC、数据库与 socket IO 共享这一预算，0表示不限
+static auto g_http_request_timeout =
+    Config::Lookup("http.request.timeout", (uint64_t)30000, "http request handling deadline in ms");
+
 HttpServer::HttpServer(bool keepalive, IOManager *worker, IOManager *io_worker, IOManager *accept_worker)
     : TcpServer(worker, io_worker, accept_worker), m_isKeepalive(keepalive) {
     m_dispatch.reset(new ServletDispatch);
@@ -16,6 +23,7 @@ HttpServer::HttpServer(bool keepalive, IOManager *worker, IOManager *io_worker,
     m_type = "http";
     m_dispatch->addServlet("/_/status", Servlet::ptr(new StatusServlet));
     m_dispatch->addServlet("/_/config", Servlet::ptr(new ConfigServlet));
+    m_dispatch->addServlet("/_/metrics", Servlet::ptr(new MetricsServlet));
     m_dispatch->addServlet("/ping", [](HttpRequest::ptr req, HttpResponse::ptr res, HttpSession::ptr session) {
         res->setBody("pong");
         return 0;
@@ -52,7 +60,10 @@ void HttpServer::handleClient(Socket::ptr client) {
         HttpResponse::ptr rsp(new HttpResponse(req->getVersion(), req->isClose() || !m_isKeepalive));
         rsp->setHeader("Server", getName());
         rsp->setHeader("X-Trace-ID", trace_id);
-        m_dispatch->handle(req, rsp, session);  // 路由分发
+        {
+            DeadlineGuard deadline_guard(g_http_request_timeout->getValue());
+            m_dispatch->handle(req, rsp, session);  // 路由分发
+        }
         session->sendResponse(rsp);             // 发送响应数据
 
         /* 如果不是长连接或者客户端关闭，则关闭会话 */
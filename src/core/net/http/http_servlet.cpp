@@ -2,6 +2,8 @@
 
 #include <fnmatch.h>
 
+#include "core/io/stack_profiler.hpp"
+
 namespace IM::http {
 Servlet::Servlet(const std::string &name) : m_name(name) {}
 Servlet::~Servlet() {}
@@ -18,6 +20,9 @@ ServletDispatch::ServletDispatch() : Servlet("ServletDispatch") {
 int32_t ServletDispatch::handle(HttpRequest::ptr request, http::HttpResponse::ptr response, HttpSession::ptr session) {
     auto slt = getMatchedServlet(request->getPath());
     if (slt) {
+        if (StackProfiler::IsEnabled()) {
+            StackProfiler::SetTag("http:" + request->getPath());
+        }
         slt->handle(request, response, session);
     }
     return 0;
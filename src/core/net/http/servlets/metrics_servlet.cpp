@@ -0,0 +1,68 @@
+#include "core/net/http/servlets/metrics_servlet.hpp"
+
+#include <jsoncpp/json/json.h>
+
+#include "core/io/scheduler.hpp"
+#include "core/util/json_util.hpp"
+
+namespace IM::http {
+MetricsServlet::MetricsServlet() : Servlet("MetricsServlet") {}
+
+static Json::Value LatencyToJson(const LatencySnapshot &v) {
+    Json::Value node;
+    node["count"] = (Json::UInt64)v.count;
+    node["mean"] = (Json::UInt64)v.mean();
+    node["p50"] = (Json::UInt64)v.percentile(50);
+    node["p90"] = (Json::UInt64)v.percentile(90);
+    node["p99"] = (Json::UInt64)v.percentile(99);
+    node["p999"] = (Json::UInt64)v.percentile(99.9);
+    node["max"] = (Json::UInt64)v.max;
+    return node;
+}
+
+static void MetricsToJson(const SchedulerMetricsSnapshot &v, Json::Value &node) {
+    node["enqueued"] = (Json::UInt64)v.enqueued;
+    node["executed"] = (Json::UInt64)v.executed;
+    node["idle_wakeups"] = (Json::UInt64)v.idleWakeups;
+    node["mailbox_tasks"] = (Json::UInt64)v.mailboxTasks;
+    node["steals"] = (Json::UInt64)v.steals;
+    node["queue_wait_ns"] = LatencyToJson(v.queueWait);
+    node["run_time_ns"] = LatencyToJson(v.runTime);
+}
+
+int32_t MetricsServlet::handle(HttpRequest::ptr request, HttpResponse::ptr response, HttpSession::ptr session) {
+    response->setHeader("Content-Type", "text/json charset=utf-8");
+    Json::Value root;
+    root["schedulers"] = Json::Value(Json::arrayValue);
+    Scheduler::Visit([&root](Scheduler *scheduler) {
+        Json::Value node;
+        node["name"] = scheduler->getName();
+        node["workers"] = (Json::UInt64)scheduler->getWorkerCount();
+        node["active"] = (Json::UInt64)scheduler->getActiveThreadCount();
+        node["idle"] = (Json::UInt64)scheduler->getIdleThreadCount();
+        node["queue_depth"] = (Json::UInt64)scheduler->getQueueDepth();
+
+        SchedulerMetrics *metrics = scheduler->getMetrics();
+        node["metrics"] = metrics != nullptr;
+        if (metrics) {
+            SchedulerMetricsSnapshot total;
+            metrics->snapshot(total);
+            MetricsToJson(total, node);
+            node["tickles"] = (Json::UInt64)total.tickles;
+
+            node["per_worker"] = Json::Value(Json::arrayValue);
+            for (size_t i = 0; i < metrics->workerCount(); ++i) {
+                SchedulerMetricsSnapshot worker;
+                metrics->snapshot(worker, i);
+                Json::Value wnode;
+                MetricsToJson(worker, wnode);
+                node["per_worker"].append(wnode);
+            }
+        }
+        root["schedulers"].append(node);
+    });
+    response->setBody(JsonUtil::ToString(root));
+    return 0;
+}
+
+}  // namespace IM::http
@@ -0,0 +1,26 @@
+/**
+ * @file metrics_servlet.hpp
+ * @brief 运行时指标接口
+ * @author DreamTraveler233
+ * @date 2026-01-10
+ *
+ * 以 JSON 输出所有调度器的队列深度、计数器与排队/运行时间分位数，供监控系统采集。
+ * 人工查看请使用 /_/status。
+ */
+
+#ifndef __IM_NET_HTTP_SERVLETS_METRICS_SERVLET_HPP__
+#define __IM_NET_HTTP_SERVLETS_METRICS_SERVLET_HPP__
+
+#include "core/net/http/http_servlet.hpp"
+
+namespace IM::http {
+
+class MetricsServlet : public Servlet {
+   public:
+    MetricsServlet();
+    virtual int32_t handle(HttpRequest::ptr request, HttpResponse::ptr response, HttpSession::ptr session) override;
+};
+
+}  // namespace IM::http
+
+#endif  // __IM_NET_HTTP_SERVLETS_METRICS_SERVLET_HPP__
@@ -3,6 +3,8 @@
 #include <iomanip>
 #include <vector>
 
+#include "core/io/scheduler.hpp"
+#include "core/io/stack_profiler.hpp"
 #include "core/io/worker.hpp"
 #include "core/log/logger_manager.hpp"
 #include "core/net/core/tcp_server.hpp"
@@ -42,6 +44,60 @@ std::string format_used_time(int64_t ts) {
     return ss.str();
 }
 
+// 排队/运行时间分位数，单位微秒
+static std::string format_latency(const LatencySnapshot &v) {
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(1) << "count=" << v.count << " mean=" << v.mean() / 1000.0
+       << " p50=" << v.percentile(50) / 1000.0 << " p90=" << v.percentile(90) / 1000.0
+       << " p99=" << v.percentile(99) / 1000.0 << " p999=" << v.percentile(99.9) / 1000.0
+       << " max=" << v.max / 1000.0;
+    return ss.str();
+}
+
+static void dump_scheduler(std::ostream &ss, Scheduler *scheduler) {
+#define XX3(key) ss << std::setw(30) << std::right << key << ": "
+    XX3(scheduler->getName()) << "workers=" << scheduler->getWorkerCount()
+                              << " active=" << scheduler->getActiveThreadCount()
+                              << " idle=" << scheduler->getIdleThreadCount()
+                              << " queue_depth=" << scheduler->getQueueDepth() << std::endl;
+    SchedulerMetrics *metrics = scheduler->getMetrics();
+    if (!metrics) {
+        return;
+    }
+    SchedulerMetricsSnapshot total;
+    metrics->snapshot(total);
+    XX3("counters") << "enqueued=" << total.enqueued << " executed=" << total.executed
+                    << " tickles=" << total.tickles << " idle_wakeups=" << total.idleWakeups
+                    << " mailbox=" << total.mailboxTasks << " steals=" << total.steals << std::endl;
+    XX3("queue_wait(us)") << format_latency(total.queueWait) << std::endl;
+    XX3("run_time(us)") << format_latency(total.runTime) << std::endl;
+    for (size_t i = 0; i < metrics->workerCount(); ++i) {
+        SchedulerMetricsSnapshot worker;
+        metrics->snapshot(worker, i);
+        XX3("worker[" + std::to_string(i) + "]")
+            << std::fixed << std::setprecision(1) << "executed=" << worker.executed
+            << " idle_wakeups=" << worker.idleWakeups << " steals=" << worker.steals
+            << " wait_p99=" << worker.queueWait.percentile(99) / 1000.0
+            << " run_p99=" << worker.runTime.percentile(99) / 1000.0 << std::endl;
+    }
+#undef XX3
+}
+
+// 各入口的栈使用深度分位数，单位KB
+static void dump_stack_profile(std::ostream &ss) {
+#define XX3(key) ss << std::setw(30) << std::right << key << ": "
+    std::vector<StackProfileSnapshot> entries;
+    StackProfiler::Snapshot(entries);
+    for (auto &i : entries) {
+        const LatencySnapshot &v = i.depth;
+        XX3(i.name) << std::fixed << std::setprecision(1) << "count=" << v.count
+                    << " p50=" << v.percentile(50) / 1024.0 << " p90=" << v.percentile(90) / 1024.0
+                    << " p99=" << v.percentile(99) / 1024.0 << " max=" << v.max / 1024.0
+                    << " stack=" << i.stackSize / 1024.0 << std::endl;
+    }
+#undef XX3
+}
+
 int32_t StatusServlet::handle(HttpRequest::ptr request, HttpResponse::ptr response, HttpSession::ptr session) {
     response->setHeader("Content-Type", "text/text; charset=utf-8");
 #define XX(key) ss << std::setw(30) << std::right << key ": "
@@ -72,12 +128,28 @@ int32_t StatusServlet::handle(HttpRequest::ptr request, HttpResponse::ptr respon
     XX("main_running_time") << format_used_time(time(0) - ProcessInfoMgr::GetInstance()->main_start_time) << std::endl;
     ss << "===================================================" << std::endl;
     XX("fibers") << Coroutine::TotalCoroutines() << std::endl;
+    StackPoolStats stack_stats = PooledStackAllocator::GetStats();
+    XX("stack_pool.hits") << stack_stats.hits << std::endl;
+    XX("stack_pool.misses") << stack_stats.misses << std::endl;
+    XX("stack_pool.in_use") << stack_stats.inUse << std::endl;
+    XX("stack_pool.cached") << stack_stats.cached << std::endl;
+    XX("stack_pool.cached_resident") << stack_stats.cachedResident << std::endl;
+    XX("shared_stack.coroutines") << stack_stats.sharedCoroutines << std::endl;
+    XX("shared_stack.saved_bytes") << stack_stats.sharedSavedBytes << std::endl;
+    XX("shared_stack.copies") << stack_stats.sharedCopies << std::endl;
+    if (StackProfiler::IsEnabled()) {
+        ss << "<StackProfile(KB)>" << std::endl;
+        dump_stack_profile(ss);
+    }
     ss << "===================================================" << std::endl;
     ss << "<Logger>" << std::endl;
     ss << LoggerMgr::GetInstance()->toYamlString() << std::endl;
     ss << "===================================================" << std::endl;
     ss << "<Woker>" << std::endl;
     WorkerMgr::GetInstance()->dump(ss) << std::endl;
+    ss << "===================================================" << std::endl;
+    ss << "<Scheduler>" << std::endl;
+    Scheduler::Visit([&ss](Scheduler *scheduler) { dump_scheduler(ss, scheduler); });
 
     std::map<std::string, std::vector<TcpServer::ptr>> servers;
     Application::GetInstance()->listAllServer(servers);
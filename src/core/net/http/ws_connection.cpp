@@ -3,7 +3,9 @@
 #include "core/util/util.hpp"
 
 namespace IM::http {
-WSConnection::WSConnection(Socket::ptr sock, bool owner) : HttpConnection(sock, owner) {}
+WSConnection::WSConnection(Socket::ptr sock, bool owner) : HttpConnection(sock, owner) {
+    setReadBuffer(g_websocket_recv_buffer_size->getValue());
+}
 
 std::pair<HttpResult::ptr, WSConnection::ptr> WSConnection::Create(const std::string &url, uint64_t timeout_ms,
                                                                    const std::map<std::string, std::string> &headers) {
@@ -0,0 +1,251 @@
+#include "core/net/http/ws_deflate.hpp"
+
+#include <algorithm>
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <vector>
+
+#include "core/base/macro.hpp"
+#include "core/config/config.hpp"
+
+namespace IM::http {
+static IM::Logger::ptr g_logger = IM_LOG_NAME("system");
+
+static IM::ConfigVar<bool>::ptr g_deflate_enable = IM::Config::Lookup<bool>(
+    "websocket.permessage_deflate.enable", false, "accept websocket permessage-deflate negotiation");
+static IM::ConfigVar<uint32_t>::ptr g_deflate_level =
+    IM::Config::Lookup("websocket.permessage_deflate.level", (uint32_t)1, "websocket deflate level 1~9");
+static IM::ConfigVar<uint32_t>::ptr g_deflate_min_size = IM::Config::Lookup(
+    "websocket.permessage_deflate.min_size", (uint32_t)64, "websocket messages shorter than this are not compressed");
+static IM::ConfigVar<uint32_t>::ptr g_deflate_max_memory =
+    IM::Config::Lookup("websocket.permessage_deflate.max_memory", (uint32_t)256 * 1024,
+                       "websocket deflate+inflate context memory cap per session");
+static IM::ConfigVar<bool>::ptr g_deflate_server_no_context_takeover =
+    IM::Config::Lookup<bool>("websocket.permessage_deflate.server_no_context_takeover", false,
+                             "reset server compression context after each message");
+static IM::ConfigVar<bool>::ptr g_deflate_client_no_context_takeover =
+    IM::Config::Lookup<bool>("websocket.permessage_deflate.client_no_context_takeover", false,
+                             "ask client to reset compression context after each message");
+static IM::ConfigVar<uint32_t>::ptr g_deflate_server_max_window_bits = IM::Config::Lookup(
+    "websocket.permessage_deflate.server_max_window_bits", (uint32_t)15, "server deflate window bits 9~15");
+static IM::ConfigVar<uint32_t>::ptr g_deflate_client_max_window_bits = IM::Config::Lookup(
+    "websocket.permessage_deflate.client_max_window_bits", (uint32_t)15, "client deflate window bits 9~15");
+
+// zlib 的 raw deflate 不支持 8 位窗口
+static const int kMinWindowBits = 9;
+static const int kMaxWindowBits = 15;
+static const uint32_t kZlibBufferSize = 4096;
+// 同步刷新输出末尾的空存储块，发送时去掉，接收时补回
+static const char kDeflateTail[4] = {0x00, 0x00, (char)0xFF, (char)0xFF};
+
+static std::string Trim(const std::string &str) {
+    size_t begin = str.find_first_not_of(" \t");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    size_t end = str.find_last_not_of(" \t");
+    return str.substr(begin, end - begin + 1);
+}
+
+static std::vector<std::string> Split(const std::string &str, char sep) {
+    std::vector<std::string> rt;
+    size_t begin = 0;
+    while (true) {
+        size_t pos = str.find(sep, begin);
+        rt.push_back(Trim(str.substr(begin, pos == std::string::npos ? std::string::npos : pos - begin)));
+        if (pos == std::string::npos) {
+            return rt;
+        }
+        begin = pos + 1;
+    }
+}
+
+/**
+ * @brief 解析窗口位数参数，值可以带引号
+ * @return 8~15，格式错误返回 -1
+ */
+static int ParseWindowBits(std::string value) {
+    if (value.size() >= 2 && value.front() == '"' && value.back() == '"') {
+        value = value.substr(1, value.size() - 2);
+    }
+    if (value.size() < 1 || value.size() > 2 || !isdigit(value[0]) || value[0] == '0' ||
+        (value.size() == 2 && !isdigit(value[1]))) {
+        return -1;
+    }
+    int bits = atoi(value.c_str());
+    return bits >= 8 && bits <= kMaxWindowBits ? bits : -1;
+}
+
+std::string WSDeflate::Params::toString(bool server_bits_offered, bool client_bits_offered) const {
+    std::string rt = "permessage-deflate";
+    if (serverNoContextTakeover) {
+        rt += "; server_no_context_takeover";
+    }
+    if (clientNoContextTakeover) {
+        rt += "; client_no_context_takeover";
+    }
+    // 窗口参数只在客户端提出时回应；服务端压缩时使用更小的窗口不需要告知对方
+    if (server_bits_offered) {
+        rt += "; server_max_window_bits=" + std::to_string(serverMaxWindowBits);
+    }
+    if (client_bits_offered) {
+        rt += "; client_max_window_bits=" + std::to_string(clientMaxWindowBits);
+    }
+    return rt;
+}
+
+WSDeflate::ptr WSDeflate::Negotiate(const std::string &offers, std::string &response) {
+    if (!g_deflate_enable->getValue() || offers.empty()) {
+        return nullptr;
+    }
+    int level = std::min(std::max((int)g_deflate_level->getValue(), 1), 9);
+    int server_bits_limit = std::min(std::max((int)g_deflate_server_max_window_bits->getValue(), kMinWindowBits),
+                                     kMaxWindowBits);
+    int client_bits_limit = std::min(std::max((int)g_deflate_client_max_window_bits->getValue(), kMinWindowBits),
+                                     kMaxWindowBits);
+    size_t max_memory = g_deflate_max_memory->getValue();
+
+    // 客户端可以按优先级给出多个候选，取第一个可以接受的
+    for (auto &offer : Split(offers, ',')) {
+        auto items = Split(offer, ';');
+        if (strcasecmp(items[0].c_str(), "permessage-deflate")) {
+            continue;
+        }
+        Params params;
+        bool server_bits_offered = false;
+        bool client_bits_offered = false;
+        int server_bits = kMaxWindowBits;
+        int client_bits = kMaxWindowBits;
+        bool valid = true;
+        bool seen[4] = {false, false, false, false};
+        for (size_t i = 1; i < items.size() && valid; ++i) {
+            size_t eq = items[i].find('=');
+            std::string name = Trim(items[i].substr(0, eq));
+            std::string value = eq == std::string::npos ? "" : Trim(items[i].substr(eq + 1));
+            int index = -1;
+            if (name == "server_no_context_takeover") {
+                index = 0;
+                valid = eq == std::string::npos;
+                params.serverNoContextTakeover = true;
+            } else if (name == "client_no_context_takeover") {
+                index = 1;
+                valid = eq == std::string::npos;
+                params.clientNoContextTakeover = true;
+            } else if (name == "server_max_window_bits") {
+                index = 2;
+                server_bits = ParseWindowBits(value);
+                valid = server_bits > 0;
+                server_bits_offered = true;
+            } else if (name == "client_max_window_bits") {
+                // 客户端声明支持限制自己的窗口，值可以省略
+                index = 3;
+                client_bits = eq == std::string::npos ? kMaxWindowBits : ParseWindowBits(value);
+                valid = client_bits > 0;
+                client_bits_offered = true;
+            } else {
+                valid = false;
+            }
+            // 未知参数、重复参数或非法值：拒绝该候选
+            if (index >= 0) {
+                valid = valid && !seen[index];
+                seen[index] = true;
+            }
+        }
+        // 客户端要求的服务端窗口小于 zlib 支持的最小窗口
+        if (!valid || server_bits < kMinWindowBits) {
+            continue;
+        }
+
+        params.serverNoContextTakeover |= g_deflate_server_no_context_takeover->getValue();
+        params.clientNoContextTakeover |= g_deflate_client_no_context_takeover->getValue();
+        params.serverMaxWindowBits = std::min(server_bits, server_bits_limit);
+        params.clientMaxWindowBits = client_bits_offered ? std::min(client_bits, client_bits_limit) : kMaxWindowBits;
+        params.memLevel = std::min(8, params.serverMaxWindowBits - 7);
+
+        // 超过内存上限时先缩小服务端窗口与 memLevel，再缩小客户端窗口(仅客户端支持时)
+        while (max_memory && EstimateMemory(params) > max_memory) {
+            if (params.serverMaxWindowBits > kMinWindowBits) {
+                --params.serverMaxWindowBits;
+                params.memLevel = std::min(params.memLevel, params.serverMaxWindowBits - 7);
+            } else if (client_bits_offered && params.clientMaxWindowBits > kMinWindowBits) {
+                --params.clientMaxWindowBits;
+            } else {
+                break;
+            }
+        }
+        if (max_memory && EstimateMemory(params) > max_memory) {
+            IM_LOG_DEBUG(g_logger) << "permessage-deflate declined, memory " << EstimateMemory(params) << " > "
+                                   << max_memory << " offer=" << offer;
+            continue;
+        }
+
+        auto rt = Create(params, level);
+        if (rt) {
+            response = params.toString(server_bits_offered, client_bits_offered);
+        }
+        return rt;
+    }
+    return nullptr;
+}
+
+size_t WSDeflate::EstimateMemory(const Params &params) {
+    // deflate: (1 << (windowBits + 2)) + (1 << (memLevel + 9)) 加约 6KB 状态
+    // inflate: (1 << windowBits) 加约 7KB 状态
+    size_t deflate = (1u << (params.serverMaxWindowBits + 2)) + (1u << (params.memLevel + 9)) + 6 * 1024;
+    size_t inflate = (1u << params.clientMaxWindowBits) + 7 * 1024;
+    return deflate + inflate;
+}
+
+WSDeflate::ptr WSDeflate::Create(const Params &params, int level) {
+    ptr rt(new WSDeflate(params));
+    rt->m_deflate = ZlibStream::Create(true, kZlibBufferSize, ZlibStream::DEFLATE, level, params.serverMaxWindowBits,
+                                       params.memLevel);
+    rt->m_inflate = ZlibStream::Create(false, kZlibBufferSize, ZlibStream::DEFLATE, ZlibStream::DEFAULT_COMPRESSION,
+                                       params.clientMaxWindowBits);
+    if (!rt->m_deflate || !rt->m_inflate) {
+        IM_LOG_ERROR(g_logger) << "permessage-deflate zlib init fail";
+        return nullptr;
+    }
+    return rt;
+}
+
+bool WSDeflate::shouldCompress(size_t size) const {
+    return size >= g_deflate_min_size->getValue();
+}
+
+bool WSDeflate::compress(const void *data, size_t size, std::string &out) {
+    if (m_deflate->sync(data, size) != Z_OK) {
+        return false;
+    }
+    out = m_deflate->getResult();
+    m_deflate->clearResult();
+    if (out.size() < sizeof(kDeflateTail) ||
+        memcmp(out.data() + out.size() - sizeof(kDeflateTail), kDeflateTail, sizeof(kDeflateTail))) {
+        return false;
+    }
+    out.resize(out.size() - sizeof(kDeflateTail));
+    if (m_params.serverNoContextTakeover) {
+        m_deflate->reset();
+    }
+    return true;
+}
+
+int WSDeflate::decompress(const std::string &data, size_t max_size, std::string &out) {
+    m_inflate->setMaxResultSize(max_size);
+    int rt = m_inflate->write(data.data(), data.size());
+    if (rt == Z_OK) {
+        rt = m_inflate->sync(kDeflateTail, sizeof(kDeflateTail));
+    }
+    if (rt != Z_OK) {
+        return rt == Z_MEM_ERROR ? -2 : -1;
+    }
+    out = m_inflate->getResult();
+    m_inflate->clearResult();
+    if (m_params.clientNoContextTakeover) {
+        m_inflate->reset();
+    }
+    return 0;
+}
+}  // namespace IM::http
@@ -0,0 +1,111 @@
+/**
+ * @file    ws_deflate.hpp
+ * @brief   WebSocket permessage-deflate 扩展(RFC 7692)
+ * @author DreamTraveler233
+ * @date 2026-01-10
+ *
+ * 握手时按客户端的 Sec-WebSocket-Extensions 协商参数，之后每条数据消息整体压缩：
+ * 压缩输出以 Z_SYNC_FLUSH 结束并去掉末尾的 00 00 FF FF，首帧置 RSV1；解压时补回这 4 字节。
+ * 开启上下文接管(context takeover)时多条消息共享滑动窗口，重复的 JSON 键名可以引用前面消息中的内容。
+ *
+ * 配置(websocket.permessage_deflate.*)：
+ *     enable                      是否接受客户端的压缩协商，默认关闭
+ *     level                       压缩级别 1~9，默认 1
+ *     min_size                    小于该长度的消息不压缩，默认 64 字节
+ *     max_memory                  每个会话压缩+解压上下文的内存上限，默认 256KB，放不下时缩小窗口，
+ *                                 仍放不下则拒绝协商
+ *     server_no_context_takeover  服务端每条消息后重置压缩上下文
+ *     client_no_context_takeover  要求客户端每条消息后重置压缩上下文
+ *     server_max_window_bits      服务端压缩窗口(9~15)
+ *     client_max_window_bits      客户端压缩窗口(9~15)，仅客户端声明支持该参数时生效
+ *
+ * 压缩上下文只在发送协程中使用，解压上下文只在接收协程中使用，两者都不需要加锁。
+ */
+
+#ifndef __IM_NET_HTTP_WS_DEFLATE_HPP__
+#define __IM_NET_HTTP_WS_DEFLATE_HPP__
+
+#include <memory>
+#include <stddef.h>
+#include <string>
+
+#include "core/net/streams/zlib_stream.hpp"
+
+namespace IM::http {
+class WSDeflate {
+   public:
+    using ptr = std::shared_ptr<WSDeflate>;  ///< 智能指针类型
+
+    /**
+     * @brief   协商结果
+     */
+    struct Params {
+        bool serverNoContextTakeover = false;  ///< 服务端每条消息后重置压缩上下文
+        bool clientNoContextTakeover = false;  ///< 客户端每条消息后重置压缩上下文
+        int serverMaxWindowBits = 15;          ///< 服务端压缩窗口
+        int clientMaxWindowBits = 15;          ///< 客户端压缩窗口，即服务端解压窗口
+        int memLevel = 8;                      ///< 服务端压缩的 memLevel
+
+        /**
+         * @brief   生成 Sec-WebSocket-Extensions 响应头
+         * @param   server_bits_offered  客户端是否带了 server_max_window_bits
+         * @param   client_bits_offered  客户端是否带了 client_max_window_bits
+         */
+        std::string toString(bool server_bits_offered, bool client_bits_offered) const;
+    };
+
+    /**
+     * @brief   按客户端请求头协商
+     * @param   offers    Sec-WebSocket-Extensions 请求头
+     * @param   response  输出，接受时为响应头的值
+     * @return  接受时返回压缩上下文，未开启、客户端未请求或参数无法接受时返回 nullptr
+     */
+    static ptr Negotiate(const std::string &offers, std::string &response);
+
+    /**
+     * @brief   按参数估算压缩与解压上下文占用的内存(zlib 文档给出的公式)
+     */
+    static size_t EstimateMemory(const Params &params);
+
+    /**
+     * @brief   创建压缩上下文
+     * @return  zlib 初始化失败时返回 nullptr
+     */
+    static ptr Create(const Params &params, int level);
+
+    const Params &getParams() const { return m_params; }
+
+    /**
+     * @brief   是否应当压缩该长度的消息
+     */
+    bool shouldCompress(size_t size) const;
+
+    /**
+     * @brief   压缩一条消息
+     * @param   data  消息内容
+     * @param   size  消息长度
+     * @param   out   输出，已去掉末尾的 00 00 FF FF
+     * @return  是否成功；失败后压缩上下文不可再用
+     */
+    bool compress(const void *data, size_t size, std::string &out);
+
+    /**
+     * @brief   解压一条消息
+     * @param   data      压缩数据(首帧置 RSV1 的整条消息)
+     * @param   max_size  解压后的最大长度
+     * @param   out       输出
+     * @return  0 成功，-1 数据损坏，-2 超过 max_size
+     */
+    int decompress(const std::string &data, size_t max_size, std::string &out);
+
+   private:
+    WSDeflate(const Params &params) : m_params(params) {}
+
+   private:
+    Params m_params;            ///< 协商结果
+    ZlibStream::ptr m_deflate;  ///< 压缩上下文
+    ZlibStream::ptr m_inflate;  ///< 解压上下文
+};
+}  // namespace IM::http
+
+#endif  // __IM_NET_HTTP_WS_DEFLATE_HPP__
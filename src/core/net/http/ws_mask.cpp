@@ -0,0 +1,134 @@
+#include "core/net/http/ws_mask.hpp"
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__))
+#define IM_WS_MASK_X86 1
+#include <immintrin.h>
+#endif
+
+namespace IM::http {
+/**
+ * @brief 把4字节掩码重复填满 len 字节
+ */
+static void RepeatMask(uint8_t *out, size_t len, const char *mask) {
+    for (size_t i = 0; i < len; i += 4) {
+        memcpy(out + i, mask, 4);
+    }
+}
+
+/**
+ * @brief 逐字节处理 [i, size)，i 为掩码相位起点之后的偏移
+ */
+static void MaskTail(uint8_t *dst, const uint8_t *src, size_t i, size_t size, const char *mask) {
+    for (; i < size; ++i) {
+        dst[i] = src[i] ^ (uint8_t)mask[i & 3];
+    }
+}
+
+static void MaskScalar(uint8_t *dst, const uint8_t *src, size_t size, const char *mask) {
+    uint64_t key;
+    RepeatMask((uint8_t *)&key, sizeof(key), mask);
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t v;
+        memcpy(&v, src + i, 8);
+        v ^= key;
+        memcpy(dst + i, &v, 8);
+    }
+    MaskTail(dst, src, i, size, mask);
+}
+
+#ifdef IM_WS_MASK_X86
+static void MaskSSE2(uint8_t *dst, const uint8_t *src, size_t size, const char *mask) {
+    alignas(16) uint8_t buf[16];
+    RepeatMask(buf, sizeof(buf), mask);
+    const __m128i key = _mm_load_si128((const __m128i *)buf);
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_xor_si128(v, key));
+    }
+    MaskTail(dst, src, i, size, mask);
+}
+
+__attribute__((target("avx2"))) static void MaskAVX2(uint8_t *dst, const uint8_t *src, size_t size,
+                                                     const char *mask) {
+    alignas(32) uint8_t buf[32];
+    RepeatMask(buf, sizeof(buf), mask);
+    const __m256i key = _mm256_load_si256((const __m256i *)buf);
+    size_t i = 0;
+    // 每轮两个向量，减少循环开销
+    for (; i + 64 <= size; i += 64) {
+        __m256i v0 = _mm256_loadu_si256((const __m256i *)(src + i));
+        __m256i v1 = _mm256_loadu_si256((const __m256i *)(src + i + 32));
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_xor_si256(v0, key));
+        _mm256_storeu_si256((__m256i *)(dst + i + 32), _mm256_xor_si256(v1, key));
+    }
+    for (; i + 32 <= size; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(src + i));
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_xor_si256(v, key));
+    }
+    MaskTail(dst, src, i, size, mask);
+}
+#endif
+
+bool WSMaskKernelSupported(WSMaskKernel kernel) {
+    switch (kernel) {
+        case WSMaskKernel::AUTO:
+        case WSMaskKernel::SCALAR:
+            return true;
+#ifdef IM_WS_MASK_X86
+        case WSMaskKernel::SSE2:
+            return true;
+        case WSMaskKernel::AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+WSMaskKernel WSMaskDefaultKernel() {
+    static const WSMaskKernel s_kernel = WSMaskKernelSupported(WSMaskKernel::AVX2)   ? WSMaskKernel::AVX2
+                                         : WSMaskKernelSupported(WSMaskKernel::SSE2) ? WSMaskKernel::SSE2
+                                                                                     : WSMaskKernel::SCALAR;
+    return s_kernel;
+}
+
+const char *WSMaskKernelName(WSMaskKernel kernel) {
+    switch (kernel) {
+        case WSMaskKernel::AUTO:
+            return "auto";
+        case WSMaskKernel::SCALAR:
+            return "scalar64";
+        case WSMaskKernel::SSE2:
+            return "sse2";
+        case WSMaskKernel::AVX2:
+            return "avx2";
+    }
+    return "unknown";
+}
+
+void WSMask(char *dst, const char *src, size_t size, const char *mask, WSMaskKernel kernel) {
+    if (kernel == WSMaskKernel::AUTO || !WSMaskKernelSupported(kernel)) {
+        kernel = WSMaskDefaultKernel();
+    }
+    uint8_t *d = (uint8_t *)dst;
+    const uint8_t *s = (const uint8_t *)src;
+    switch (kernel) {
+#ifdef IM_WS_MASK_X86
+        case WSMaskKernel::AVX2:
+            MaskAVX2(d, s, size, mask);
+            return;
+        case WSMaskKernel::SSE2:
+            MaskSSE2(d, s, size, mask);
+            return;
+#endif
+        default:
+            MaskScalar(d, s, size, mask);
+            return;
+    }
+}
+}  // namespace IM::http
@@ -0,0 +1,54 @@
+/**
+ * @file    ws_mask.hpp
+ * @brief   WebSocket 载荷掩码/去掩码
+ * @author DreamTraveler233
+ * @date 2026-01-10
+ *
+ * 掩码是载荷逐字节与4字节掩码循环异或。每次处理 4 的整数倍字节时掩码相位不变，因此可以把掩码
+ * 扩展成 8/16/32 字节后整块异或：AVX2 每次 32 字节，SSE2 每次 16 字节，其余平台按 64 位整数
+ * 每次 8 字节，尾部不足一块的字节逐个处理。首次调用时按 CPU 支持的指令集选定实现。
+ */
+
+#ifndef __IM_NET_HTTP_WS_MASK_HPP__
+#define __IM_NET_HTTP_WS_MASK_HPP__
+
+#include <stddef.h>
+
+namespace IM::http {
+/**
+ * @brief   掩码实现
+ */
+enum class WSMaskKernel {
+    AUTO = 0,    ///< 按 CPU 自动选择
+    SCALAR = 1,  ///< 64位整数
+    SSE2 = 2,    ///< SSE2，16字节
+    AVX2 = 3,    ///< AVX2，32字节
+};
+
+/**
+ * @brief   掩码/去掩码，两者是同一运算
+ * @param   dst     输出，可以与 src 相同(原地处理)
+ * @param   src     输入
+ * @param   size    字节数
+ * @param   mask    4字节掩码，从 src[0] 对应 mask[0] 开始
+ * @param   kernel  指定实现，CPU 不支持时退回自动选择
+ */
+void WSMask(char *dst, const char *src, size_t size, const char *mask, WSMaskKernel kernel = WSMaskKernel::AUTO);
+
+/**
+ * @brief   当前 CPU 是否支持指定实现
+ */
+bool WSMaskKernelSupported(WSMaskKernel kernel);
+
+/**
+ * @brief   自动选择时使用的实现
+ */
+WSMaskKernel WSMaskDefaultKernel();
+
+/**
+ * @brief   实现名称
+ */
+const char *WSMaskKernelName(WSMaskKernel kernel);
+}  // namespace IM::http
+
+#endif  // __IM_NET_HTTP_WS_MASK_HPP__
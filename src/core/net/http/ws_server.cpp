@@ -1,10 +1,17 @@
 #include "core/net/http/ws_server.hpp"
 
 #include "core/base/macro.hpp"
+#include "core/config/config.hpp"
+#include "core/io/stack_profiler.hpp"
+#include "core/util/deadline_context.hpp"
 
 namespace IM::http {
 static auto g_logger = IM_LOG_NAME("system");
 
+// 单条消息(及连接建立回调)的处理时限，0表示不限
+static auto g_ws_message_timeout =
+    Config::Lookup("ws.message.timeout", (uint64_t)10000, "websocket message handling deadline in ms");
+
 WSServer::WSServer(IM::IOManager *worker, IM::IOManager *io_worker, IM::IOManager *accept_worker)
     : TcpServer(worker, io_worker, accept_worker) {
     m_dispatch.reset(new WSServletDispatch);
@@ -30,8 +37,15 @@ void WSServer::handleClient(Socket::ptr client) {
             IM_LOG_DEBUG(g_logger) << "no match WSServlet";
             break;
         }
+        if (StackProfiler::IsEnabled()) {
+            StackProfiler::SetTag("ws:" + header->getPath());
+        }
         // 3. 连接建立事件回调（如鉴权、会话登记等）
-        int rt = servlet->onConnect(header, session);
+        int rt = 0;
+        {
+            DeadlineGuard deadline_guard(g_ws_message_timeout->getValue());
+            rt = servlet->onConnect(header, session);
+        }
         if (rt) {
             // 回调返回非0，拒绝连接
             IM_LOG_DEBUG(g_logger) << "onConnect return " << rt;
@@ -39,13 +53,17 @@ void WSServer::handleClient(Socket::ptr client) {
         }
         // 4. 消息主循环，持续接收并分发消息
         while (true) {
+            // 数据帧按普通优先级接收；控制帧(PING/CLOSE)在 recvMessage 内部以高优先级回复
             auto msg = session->recvMessage();
             if (!msg) {
                 // 连接断开或异常，跳出循环
                 break;
             }
             // 业务消息处理回调
-            rt = servlet->handle(header, msg, session);
+            {
+                DeadlineGuard deadline_guard(g_ws_message_timeout->getValue());
+                rt = servlet->handle(header, msg, session);
+            }
             if (rt) {
                 // 回调返回非0，关闭连接
                 IM_LOG_DEBUG(g_logger) << "handle return " << rt;
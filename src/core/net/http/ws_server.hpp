@@ -22,6 +22,8 @@ namespace IM::http {
  *
  * 负责WebSocket协议的监听、连接接入、事件分发。
  * 支持多线程高并发，业务事件通过WSServletDispatch分发。
+ * 连接沿用 tcp_server.read_timeout(默认120秒)作为读超时：超过该时间没有收到任何帧
+ * (数据、PING 或应用层心跳)的连接会被断开，因此客户端必须以更短的间隔发送心跳。
  * @note    线程安全，适合生产环境。
  */
 class WSServer : public TcpServer {
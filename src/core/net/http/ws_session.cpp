@@ -1,9 +1,13 @@
 #include "core/net/http/ws_session.hpp"
 
+#include <atomic>
 #include <string.h>
 
 #include "core/base/endian.hpp"
 #include "core/base/macro.hpp"
+#include "core/io/iomanager.hpp"
+#include "core/net/http/ws_deflate.hpp"
+#include "core/net/http/ws_mask.hpp"
 #include "core/util/hash_util.hpp"
 
 namespace IM::http {
@@ -19,7 +23,45 @@ static IM::ConfigVar<uint32_t>::ptr g_ws_allow_unmasked_client_frames = IM::Conf
 IM::ConfigVar<uint32_t>::ptr g_websocket_message_max_size =
     IM::Config::Lookup("websocket.message.max_size", (uint32_t)1024 * 1024 * 32, "websocket message max size");
 
-WSSession::WSSession(Socket::ptr sock, bool owner) : HttpSession(sock, owner) {}
+// 连接数多，默认只缓冲一个典型的小帧批次；大帧载荷绕过缓冲区直接读入
+IM::ConfigVar<uint32_t>::ptr g_websocket_recv_buffer_size =
+    IM::Config::Lookup("websocket.recv_buffer_size", (uint32_t)4096, "websocket per-connection receive buffer size");
+
+// 发送队列上限：帧数与字节数任一超出即视为客户端跟不上
+static IM::ConfigVar<uint32_t>::ptr g_ws_send_queue_max_frames = IM::Config::Lookup(
+    "websocket.send_queue.max_frames", (uint32_t)1024, "websocket per-connection send queue max frames");
+static IM::ConfigVar<uint32_t>::ptr g_ws_send_queue_max_bytes = IM::Config::Lookup(
+    "websocket.send_queue.max_bytes", (uint32_t)(4 * 1024 * 1024), "websocket per-connection send queue max bytes");
+// 队列满时的策略：disconnect 断开慢客户端(重连后由客户端补拉)，drop_oldest 丢弃最早的数据帧
+static IM::ConfigVar<std::string>::ptr g_ws_send_queue_overflow_policy =
+    IM::Config::Lookup("websocket.send_queue.overflow_policy", std::string("disconnect"),
+                       "websocket send queue overflow policy: disconnect | drop_oldest");
+
+// 发送协程一次 writev 最多合并的帧数
+static const size_t kMaxBatchFrames = 64;
+
+static std::atomic<int> s_ws_send_queue_overflow_policy = {WSSession::DISCONNECT};
+
+static WSSession::OverflowPolicy ParseOverflowPolicy(const std::string &v) {
+    return v == "drop_oldest" ? WSSession::DROP_OLDEST : WSSession::DISCONNECT;
+}
+
+namespace {
+// 初始化配置：入队时不再逐次比较策略字符串
+struct _WSSendQueueIniter {
+    _WSSendQueueIniter() {
+        s_ws_send_queue_overflow_policy = ParseOverflowPolicy(g_ws_send_queue_overflow_policy->getValue());
+        g_ws_send_queue_overflow_policy->addListener([](const std::string &old_val, const std::string &new_val) {
+            s_ws_send_queue_overflow_policy = ParseOverflowPolicy(new_val);
+        });
+    }
+};
+static _WSSendQueueIniter _init;
+}  // namespace
+
+WSSession::WSSession(Socket::ptr sock, bool owner) : HttpSession(sock, owner) {
+    setReadBuffer(g_websocket_recv_buffer_size->getValue());
+}
 
 HttpRequest::ptr WSSession::handleShake() {
     HttpRequest::ptr req;
@@ -65,6 +107,11 @@ HttpRequest::ptr WSSession::handleShake() {
         rsp->setHeader("Upgrade", "websocket");
         rsp->setHeader("Connection", "Upgrade");
         rsp->setHeader("Sec-WebSocket-Accept", v);
+        std::string extensions;
+        m_deflate = WSDeflate::Negotiate(req->getHeader("Sec-WebSocket-Extensions"), extensions);
+        if (m_deflate) {
+            rsp->setHeader("Sec-WebSocket-Extensions", extensions);
+        }
 
         sendResponse(rsp);
         IM_LOG_DEBUG(g_logger) << *req;
@@ -97,26 +144,314 @@ WSFrameMessage::ptr WSSession::recvMessage() {
 }
 
 int32_t WSSession::sendMessage(WSFrameMessage::ptr msg, bool fin) {
-    return WSSendMessage(this, msg, false, fin);
+    return enqueueFrame(msg->getOpcode(), fin, msg->getData());
 }
 
 int32_t WSSession::sendMessage(const std::string &msg, int32_t opcode, bool fin) {
-    return WSSendMessage(this, std::make_shared<WSFrameMessage>(opcode, msg), false, fin);
+    return enqueueFrame(opcode, fin, msg);
 }
 
 int32_t WSSession::ping() {
-    return WSPing(this);
+    return enqueueFrame(WSFrameHead::PING, true, "");
+}
+
+int32_t WSSession::sendClose(uint16_t code, const std::string &reason) {
+    // CLOSE 帧载荷：状态码(网络字节序) + 原因
+    std::string payload;
+    payload.resize(2);
+    uint16_t ncode = htons(code);
+    memcpy(&payload[0], &ncode, 2);
+    payload.append(reason);
+    return enqueueFrame(WSFrameHead::CLOSE, true, std::move(payload));
+}
+
+size_t WSSession::getSendQueueSize() const {
+    SpinLock::Lock lock(m_sendMutex);
+    return m_sendQueue.size();
+}
+
+uint64_t WSSession::getDroppedFrames() const {
+    SpinLock::Lock lock(m_sendMutex);
+    return m_droppedFrames;
+}
+
+/**
+ * @brief 是否为完整的单帧数据消息，只有这类帧可以在队列满时丢弃、可以压缩
+ * @details 分片消息的中间帧丢弃后对端无法拼装，控制帧丢弃会破坏心跳与关闭握手
+ */
+static bool IsSingleDataFrame(int32_t opcode, bool fin) {
+    return fin && opcode != WSFrameHead::CONTINUE && opcode < WSFrameHead::CLOSE;
+}
+
+WSFrameBuffer::ptr WSFrameBuffer::Create(const std::string &payload, int32_t opcode, bool fin) {
+    uint8_t head[kWSMaxFrameHeadSize];
+    size_t head_len = WSEncodeFrameHead(head, opcode, fin, payload.size());
+    std::string data;
+    data.reserve(head_len + payload.size());
+    data.append((const char *)head, head_len);
+    data.append(payload);
+    return ptr(new WSFrameBuffer(std::move(data), head_len, opcode, fin));
+}
+
+int32_t WSSession::sendFrame(const WSFrameBuffer::ptr &frame) {
+    OutFrame out;
+    out.droppable = IsSingleDataFrame(frame->getOpcode(), frame->isFin());
+    out.shared = frame;
+    return enqueue(std::move(out), frame->getOpcode() == WSFrameHead::CLOSE);
+}
+
+size_t WSSession::Broadcast(const std::vector<WSSession::ptr> &sessions, const WSFrameBuffer::ptr &frame) {
+    size_t count = 0;
+    for (auto &i : sessions) {
+        if (i && i->sendFrame(frame) > 0) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+int32_t WSSession::enqueueFrame(int32_t opcode, bool fin, std::string payload) {
+    OutFrame frame;
+    frame.headLen = WSEncodeFrameHead(frame.head, opcode, fin, payload.size());
+    frame.droppable = IsSingleDataFrame(opcode, fin);
+    frame.payload = std::move(payload);
+    return enqueue(std::move(frame), opcode == WSFrameHead::CLOSE);
+}
+
+int32_t WSSession::enqueue(OutFrame frame, bool close) {
+    int32_t size = frame.size();
+    // 控制帧(CLOSE/PING/PONG)的操作码不小于 CLOSE
+    bool control = (frame.shared ? frame.shared->getOpcode() : (frame.head[0] & 0x0F)) >= WSFrameHead::CLOSE;
+
+    bool disconnect = false;
+    bool start = false;
+    bool wait_drain = false;
+    uint64_t dropped = 0;
+    bool log_drop = false;
+    SyncParker parker;
+    {
+        SpinLock::Lock lock(m_sendMutex);
+        if (m_sendClosed || m_closeQueued) {
+            return -1;
+        }
+        size_t max_frames = g_ws_send_queue_max_frames->getValue();
+        size_t max_bytes = g_ws_send_queue_max_bytes->getValue();
+        // 控制帧与分片帧同样计入上限(对端只发 PING 不读时 PONG 也会堆积)；空队列总是接纳，
+        // 否则单条超过 max_bytes 的消息永远发不出去
+        auto full = [&]() {
+            return !m_sendQueue.empty() &&
+                   (m_sendQueue.size() + 1 > max_frames || m_sendQueueBytes + size > max_bytes);
+        };
+        if (full()) {
+            if (s_ws_send_queue_overflow_policy == DROP_OLDEST) {
+                for (auto it = m_sendQueue.begin(); it != m_sendQueue.end() && full();) {
+                    if (!it->droppable) {
+                        ++it;
+                        continue;
+                    }
+                    m_sendQueueBytes -= it->size();
+                    it = m_sendQueue.erase(it);
+                    ++dropped;
+                }
+                // 持续丢帧时每1000帧记录一次日志
+                log_drop = dropped && (m_droppedFrames == 0 ||
+                                       m_droppedFrames / 1000 != (m_droppedFrames + dropped) / 1000);
+                m_droppedFrames += dropped;
+            }
+            // 丢完数据帧仍然放不下(队列被不可丢弃的帧占满)，同样断开
+            if (full()) {
+                m_sendClosed = true;
+                m_sendQueue.clear();
+                m_sendQueueBytes = 0;
+                disconnect = true;
+            }
+        }
+        if (!disconnect) {
+            m_sendQueueBytes += size;
+            m_sendQueue.push_back(std::move(frame));
+            // 关闭帧之后不再接受新帧
+            m_closeQueued = close;
+            if (!m_writing) {
+                m_writing = true;
+                start = true;
+            } else if (close) {
+                // 发送协程正在运行：等它把关闭帧连同之前排队的帧写完，调用方随后才会关闭连接
+                m_drainWaiters.push_back(parker.waiter());
+                wait_drain = true;
+            }
+        }
+    }
+
+    if (log_drop) {
+        IM_LOG_WARN(g_logger) << "WSSession send queue full, dropped oldest frames, total_dropped="
+                              << getDroppedFrames() << " remote=" << getRemoteAddressString();
+    }
+    if (disconnect) {
+        IM_LOG_WARN(g_logger) << "WSSession send queue full, disconnect slow consumer, remote="
+                              << getRemoteAddressString();
+        shutdownSocket();
+        return -1;
+    }
+    if (wait_drain) {
+        parker.park();
+    }
+    if (start) {
+        // 关闭帧之后连接随即关闭，由当前协程直接写出；其余帧交给发送协程，调用方不等待网络
+        IOManager *iom = IOManager::GetThis();
+        ptr self = weak_from_this().lock();
+        if (!close && iom && self) {
+            // 发送协程沿用入队协程的优先级，控制帧总是以高优先级写出，不排在批量任务之后
+            Coroutine::Priority priority = control ? Coroutine::HIGH : Coroutine::GetThis()->getPriority();
+            iom->schedule(std::bind(&WSSession::drainSendQueue, self), -1, priority);
+        } else {
+            drainSendQueue();
+        }
+    }
+    return size;
+}
+
+void WSSession::shutdownSocket() {
+    // 只关闭读写方向，不释放 fd：接收协程随即读到连接关闭并走正常的关闭流程，
+    // 避免其他协程还在使用时 fd 被关闭并被新连接复用
+    if (m_socket) {
+        ::shutdown(m_socket->getSocket(), SHUT_RDWR);
+    }
+}
+
+bool WSSession::compressFrame(OutFrame &frame) {
+    // droppable 即完整的单帧数据消息
+    if (!m_deflate || !frame.droppable) {
+        return true;
+    }
+    const char *data = frame.shared ? frame.shared->getPayload() : frame.payload.data();
+    size_t size = frame.shared ? frame.shared->getPayloadSize() : frame.payload.size();
+    if (!m_deflate->shouldCompress(size)) {
+        return true;
+    }
+    std::string compressed;
+    if (!m_deflate->compress(data, size, compressed)) {
+        IM_LOG_ERROR(g_logger) << "WSSession deflate fail, remote=" << getRemoteAddressString();
+        return false;
+    }
+    int32_t opcode = (frame.shared ? frame.shared->getData()[0] : frame.head[0]) & 0x0F;
+    frame.headLen = WSEncodeFrameHead(frame.head, opcode, true, compressed.size());
+    frame.head[0] |= 0x40;  // RSV1：本消息已压缩
+    frame.payload.swap(compressed);
+    frame.shared.reset();
+    return true;
+}
+
+void WSSession::drainSendQueue() {
+    std::vector<OutFrame> batch;
+    std::vector<iovec> iovs;
+    std::list<SyncWaiter> waiters;
+    batch.reserve(kMaxBatchFrames);
+    iovs.reserve(kMaxBatchFrames * 2);
+    while (true) {
+        batch.clear();
+        {
+            SpinLock::Lock lock(m_sendMutex);
+            if (m_sendQueue.empty() || m_sendClosed) {
+                m_writing = false;
+                waiters.swap(m_drainWaiters);
+                break;
+            }
+            while (!m_sendQueue.empty() && batch.size() < kMaxBatchFrames) {
+                m_sendQueueBytes -= m_sendQueue.front().size();
+                batch.push_back(std::move(m_sendQueue.front()));
+                m_sendQueue.pop_front();
+            }
+        }
+
+        // 排队的帧合并为一次聚集写
+        iovs.clear();
+        bool ok = true;
+        for (auto &i : batch) {
+            if (!compressFrame(i)) {
+                ok = false;
+                break;
+            }
+            if (i.shared) {
+                const std::string &data = i.shared->getData();
+                iovs.push_back({(void *)data.data(), data.size()});
+                continue;
+            }
+            iovs.push_back({i.head, i.headLen});
+            if (!i.payload.empty()) {
+                iovs.push_back({(void *)i.payload.data(), i.payload.size()});
+            }
+        }
+        if (!ok || writevFixSize(&iovs[0], iovs.size()) <= 0) {
+            {
+                SpinLock::Lock lock(m_sendMutex);
+                m_sendClosed = true;
+                m_sendQueue.clear();
+                m_sendQueueBytes = 0;
+                m_writing = false;
+                waiters.swap(m_drainWaiters);
+            }
+            shutdownSocket();
+            break;
+        }
+    }
+    for (auto &i : waiters) {
+        i.wake();
+    }
+}
+
+/**
+ * @brief 读取完整帧头(2~14字节)
+ * @details 带接收缓冲区的流先窥视前2字节得到帧头长度，再从缓冲区一次取出整个帧头，
+ *          多个帧一起到达时不产生系统调用；其他流先读2字节，再一次读出扩展长度与掩码
+ * @param[out] head 至少14字节
+ * @return size_t 帧头长度，失败返回0
+ */
+static size_t ReadFrameHead(Stream *stream, uint8_t *head) {
+    SocketStream *buffered = dynamic_cast<SocketStream *>(stream);
+    if (buffered && buffered->getReadBufferSize() < 14) {
+        buffered = nullptr;
+    }
+    if (buffered) {
+        if (buffered->fill(2) <= 0) return 0;
+        buffered->peek(head, 2);
+    } else if (stream->readFixSize(head, 2) <= 0) {
+        return 0;
+    }
+
+    size_t head_len = 2;
+    uint8_t payload = head[1] & 0x7F;
+    if (payload == 126) {
+        head_len += 2;
+    } else if (payload == 127) {
+        head_len += 8;
+    }
+    if (head[1] & 0x80) {
+        head_len += 4;
+    }
+
+    if (buffered) {
+        if (buffered->fill(head_len) <= 0) return 0;
+        buffered->peek(head, head_len);
+        buffered->consume(head_len);
+    } else if (head_len > 2 && stream->readFixSize(head + 2, head_len - 2) <= 0) {
+        return 0;
+    }
+    return head_len;
 }
 
 WSFrameMessage::ptr WSRecvMessage(Stream *stream, bool client, IM::NgxMemPool *pool) {
+    // 服务端会话的回复帧经发送队列写出，避免与发送协程的写交错
+    WSSession *session = dynamic_cast<WSSession *>(stream);
     int opcode = 0;
+    bool compressed = false;
     std::string data;
     int cur_len = 0;
     do {
-        // 按字节读取帧头（2字节）
-        uint8_t b1 = 0, b2 = 0;
-        if (stream->readFixSize(&b1, 1) <= 0) break;
-        if (stream->readFixSize(&b2, 1) <= 0) break;
+        // 一次取出整个帧头
+        uint8_t head[14];
+        size_t head_len = ReadFrameHead(stream, head);
+        if (!head_len) break;
+        uint8_t b1 = head[0], b2 = head[1];
 
         WSFrameHead ws_head;  // 仅用于日志展示
         ws_head.fin = (b1 & 0x80) != 0;
@@ -129,15 +464,18 @@ WSFrameMessage::ptr WSRecvMessage(Stream *stream, bool client, IM::NgxMemPool *p
 
         IM_LOG_DEBUG(g_logger) << "WSFrameHead " << ws_head.toString();
 
-        // 读取Payload长度
+        // 解析Payload长度
         uint64_t length = 0;
+        size_t offset = 2;
         if (ws_head.payload == 126) {
             uint16_t len = 0;
-            if (stream->readFixSize(&len, sizeof(len)) <= 0) break;
+            memcpy(&len, head + offset, sizeof(len));
+            offset += sizeof(len);
             length = IM::byteswap(len);
         } else if (ws_head.payload == 127) {
             uint64_t len = 0;
-            if (stream->readFixSize(&len, sizeof(len)) <= 0) break;
+            memcpy(&len, head + offset, sizeof(len));
+            offset += sizeof(len);
             length = IM::byteswap(len);
         } else {
             length = ws_head.payload;
@@ -150,10 +488,10 @@ WSFrameMessage::ptr WSRecvMessage(Stream *stream, bool client, IM::NgxMemPool *p
             break;
         }
 
-        // 读取掩码
+        // 掩码
         char mask_key[4] = {0};
         if (ws_head.mask) {
-            if (stream->readFixSize(mask_key, sizeof(mask_key)) <= 0) break;
+            memcpy(mask_key, head + offset, sizeof(mask_key));
         }
 
         // 读取Payload数据：优先从pool申请临时缓冲区，避免频繁堆分配。
@@ -172,24 +510,24 @@ WSFrameMessage::ptr WSRecvMessage(Stream *stream, bool client, IM::NgxMemPool *p
 
             if (stream->readFixSize(payload_buf, length) <= 0) break;
             if (ws_head.mask) {
-                for (uint64_t i = 0; i < length; ++i) {
-                    payload_buf[i] ^= mask_key[i % 4];
-                }
+                WSMask(payload_buf, payload_buf, length, mask_key);
             }
         }
 
-        // 处理控制帧
+        // 处理控制帧：回复以高优先级写出，不排在批量任务之后；数据帧保持调用方的优先级
         if (ws_head.opcode == WSFrameHead::PING) {
             IM_LOG_INFO(g_logger) << "PING";
-            if (WSPong(stream) <= 0) break;
+            PriorityGuard priority_guard(Coroutine::HIGH);
+            if ((session ? session->pong() : WSPong(stream)) <= 0) break;
             continue;
         } else if (ws_head.opcode == WSFrameHead::PONG) {
             // 忽略
             continue;
         } else if (ws_head.opcode == WSFrameHead::CLOSE) {
             IM_LOG_INFO(g_logger) << "CLOSE";
+            PriorityGuard priority_guard(Coroutine::HIGH);
             // 可以在此解析状态码和原因
-            WSClose(stream, 1000, "");  // 回复CLOSE
+            session ? session->sendClose(1000) : WSClose(stream, 1000, "");  // 回复CLOSE
             break;
         }
 
@@ -200,13 +538,24 @@ WSFrameMessage::ptr WSRecvMessage(Stream *stream, bool client, IM::NgxMemPool *p
                 if (!g_ws_allow_unmasked_client_frames->getValue()) {
                     IM_LOG_WARN(g_logger) << "Unmasked WebSocket frame from client, closing "
                                              "connection (enforce RFC6455)";
-                    WSClose(stream, 1002, "Client must mask frames");
+                    session ? session->sendClose(1002, "Client must mask frames")
+                            : WSClose(stream, 1002, "Client must mask frames");
                     break;
                 } else {
                     IM_LOG_DEBUG(g_logger) << "Unmasked WebSocket frame from client, allowed by config (compat mode)";
                 }
             }
 
+            // RSV1 只能出现在协商了 permessage-deflate 的会话中消息的首帧
+            if (ws_head.rsv1) {
+                if (!session || !session->getDeflate() || ws_head.opcode == WSFrameHead::CONTINUE) {
+                    IM_LOG_WARN(g_logger) << "Unexpected RSV1 in WebSocket frame, closing connection";
+                    session ? session->sendClose(1002, "Unexpected RSV1") : WSClose(stream, 1002, "Unexpected RSV1");
+                    break;
+                }
+                compressed = true;
+            }
+
             if (length > 0) {
                 data.append(payload_buf, static_cast<size_t>(length));
             }
@@ -217,6 +566,17 @@ WSFrameMessage::ptr WSRecvMessage(Stream *stream, bool client, IM::NgxMemPool *p
             }
 
             if (ws_head.fin) {
+                if (compressed) {
+                    std::string plain;
+                    int rt = session->getDeflate()->decompress(data, g_websocket_message_max_size->getValue(), plain);
+                    if (rt) {
+                        IM_LOG_WARN(g_logger) << "WebSocket inflate fail, rt=" << rt;
+                        rt == -2 ? session->sendClose(1009, "Message too big")
+                                 : session->sendClose(1007, "Invalid compressed data");
+                        break;
+                    }
+                    data.swap(plain);
+                }
                 IM_LOG_DEBUG(g_logger) << data;
                 return WSFrameMessage::ptr(new WSFrameMessage(opcode, std::move(data)));
             }
@@ -228,138 +588,91 @@ WSFrameMessage::ptr WSRecvMessage(Stream *stream, bool client, IM::NgxMemPool *p
     return nullptr;
 }
 
-int32_t WSSendMessage(Stream *stream, WSFrameMessage::ptr msg, bool client, bool fin) {
-    do {
-        uint64_t size = msg->getData().size();
-
-        // 首字节：FIN/RSV/OPCODE
-        uint8_t b1 = 0;
-        if (fin) b1 |= 0x80;              // FIN
-        b1 |= (msg->getOpcode() & 0x0F);  // OPCODE
-
-        // 次字节：MASK/PAYLOAD LEN (7位)
-        uint8_t b2 = 0;
-        if (client) b2 |= 0x80;  // 客户端发送必须MASK
-
-        uint8_t len_indicator = 0;
-        if (size < 126) {
-            len_indicator = (uint8_t)size;
-        } else if (size < 65536) {
-            len_indicator = 126;
-        } else {
-            len_indicator = 127;
-        }
-        b2 |= (len_indicator & 0x7F);
-
-        if (stream->writeFixSize(&b1, 1) <= 0) break;
-        if (stream->writeFixSize(&b2, 1) <= 0) break;
-
-        if (len_indicator == 126) {
-            uint16_t len = (uint16_t)size;
-            len = IM::byteswap(len);
-            if (stream->writeFixSize(&len, sizeof(len)) <= 0) break;
-        } else if (len_indicator == 127) {
-            uint64_t len = IM::byteswap(size);
-            if (stream->writeFixSize(&len, sizeof(len)) <= 0) break;
-        }
+size_t WSEncodeFrameHead(uint8_t *buf, int32_t opcode, bool fin, uint64_t size, const char *mask) {
+    // 首字节：FIN/RSV/OPCODE
+    buf[0] = (fin ? 0x80 : 0) | (opcode & 0x0F);
+    // 次字节：MASK/PAYLOAD LEN (7位)，之后是扩展长度与掩码
+    uint8_t b2 = mask ? 0x80 : 0;
+    size_t len = 2;
+    if (size < 126) {
+        buf[1] = b2 | (uint8_t)size;
+    } else if (size < 65536) {
+        buf[1] = b2 | 126;
+        uint16_t ext = IM::byteswap((uint16_t)size);
+        memcpy(buf + len, &ext, sizeof(ext));
+        len += sizeof(ext);
+    } else {
+        buf[1] = b2 | 127;
+        uint64_t ext = IM::byteswap(size);
+        memcpy(buf + len, &ext, sizeof(ext));
+        len += sizeof(ext);
+    }
+    if (mask) {
+        memcpy(buf + len, mask, 4);
+        len += 4;
+    }
+    return len;
+}
 
-        if (client) {
-            // 生成掩码并写入掩码后数据
-            char mask[4];
-            uint32_t rand_value = rand();
-            memcpy(mask, &rand_value, sizeof(mask));
-            if (stream->writeFixSize(mask, sizeof(mask)) <= 0) break;
+int32_t WSSendFrame(Stream *stream, int32_t opcode, bool fin, const void *data, size_t size, bool client) {
+    uint8_t head[kWSMaxFrameHeadSize];
+    std::string masked;
+    const void *payload = data;
+    size_t head_len = 0;
+    if (client) {
+        // 客户端发送必须MASK：生成掩码并写入掩码后数据
+        char mask[4];
+        uint32_t rand_value = rand();
+        memcpy(mask, &rand_value, sizeof(mask));
+        head_len = WSEncodeFrameHead(head, opcode, fin, size, mask);
+        // 复制与掩码一次完成
+        masked.resize(size);
+        WSMask(&masked[0], (const char *)data, size, mask);
+        payload = masked.data();
+    } else {
+        // 服务端发送不使用掩码
+        head_len = WSEncodeFrameHead(head, opcode, fin, size);
+    }
 
-            std::string masked = msg->getData();
-            for (size_t i = 0; i < masked.size(); ++i) {
-                masked[i] ^= mask[i % 4];
-            }
-            if (stream->writeFixSize(masked.data(), masked.size()) <= 0) break;
-            return (int32_t)(2 + (len_indicator == 126 ? 2 : (len_indicator == 127 ? 8 : 0)) + 4 + masked.size());
-        } else {
-            // 服务端发送不使用掩码
-            if (stream->writeFixSize(msg->getData().data(), size) <= 0) break;
-            return (int32_t)(2 + (len_indicator == 126 ? 2 : (len_indicator == 127 ? 8 : 0)) + size);
-        }
-    } while (0);
-    stream->close();
-    return -1;
+    iovec iov[2];
+    iov[0].iov_base = head;
+    iov[0].iov_len = head_len;
+    iov[1].iov_base = (void *)payload;
+    iov[1].iov_len = size;
+    if (stream->writevFixSize(iov, size ? 2 : 1) <= 0) {
+        stream->close();
+        return -1;
+    }
+    return (int32_t)(head_len + size);
+}
+
+int32_t WSSendMessage(Stream *stream, WSFrameMessage::ptr msg, bool client, bool fin) {
+    const std::string &data = msg->getData();
+    return WSSendFrame(stream, msg->getOpcode(), fin, data.data(), data.size(), client);
 }
 
 int32_t WSSession::pong() {
-    return WSPong(this);
+    return enqueueFrame(WSFrameHead::PONG, true, "");
 }
 
 int32_t WSPing(Stream *stream) {
-    uint8_t b1 = 0x80 | (uint8_t)WSFrameHead::PING;  // FIN + PING
-    uint8_t b2 = 0x00;                               // 无掩码、长度0
-    if (stream->writeFixSize(&b1, 1) <= 0) {
-        stream->close();
-        return -1;
-    }
-    if (stream->writeFixSize(&b2, 1) <= 0) {
-        stream->close();
-        return -1;
-    }
-    return 2;
+    return WSSendFrame(stream, WSFrameHead::PING, true, nullptr, 0, false);
 }
 
 int32_t WSPong(Stream *stream) {
-    uint8_t b1 = 0x80 | (uint8_t)WSFrameHead::PONG;  // FIN + PONG
-    uint8_t b2 = 0x00;                               // 无掩码、长度0
-    if (stream->writeFixSize(&b1, 1) <= 0) {
-        stream->close();
-        return -1;
-    }
-    if (stream->writeFixSize(&b2, 1) <= 0) {
-        stream->close();
-        return -1;
-    }
-    return 2;
+    return WSSendFrame(stream, WSFrameHead::PONG, true, nullptr, 0, false);
 }
 
 int32_t WSClose(Stream *stream, uint16_t code, const std::string &reason) {
-    // CLOSE 帧：FIN + OPCODE(CLOSE)
-    uint8_t b1 = 0x80 | (uint8_t)WSFrameHead::CLOSE;
+    // CLOSE 帧载荷：状态码(网络字节序) + 原因
     std::string payload;
     payload.resize(2);
-    // 状态码为网络字节序
     uint16_t ncode = htons(code);
     memcpy(&payload[0], &ncode, 2);
     if (!reason.empty()) {
         payload.append(reason);
     }
-
-    uint8_t b2 = 0x00;  // 服务端发给客户端不掩码
-    size_t size = payload.size();
-    uint8_t len_indicator = 0;
-    if (size < 126) {
-        len_indicator = (uint8_t)size;
-        b2 |= (len_indicator & 0x7F);
-        if (stream->writeFixSize(&b1, 1) <= 0) goto fail;
-        if (stream->writeFixSize(&b2, 1) <= 0) goto fail;
-    } else if (size < 65536) {
-        len_indicator = 126;
-        b2 |= (len_indicator & 0x7F);
-        if (stream->writeFixSize(&b1, 1) <= 0) goto fail;
-        if (stream->writeFixSize(&b2, 1) <= 0) goto fail;
-        uint16_t len = IM::byteswap((uint16_t)size);
-        if (stream->writeFixSize(&len, sizeof(len)) <= 0) goto fail;
-    } else {
-        len_indicator = 127;
-        b2 |= (len_indicator & 0x7F);
-        if (stream->writeFixSize(&b1, 1) <= 0) goto fail;
-        if (stream->writeFixSize(&b2, 1) <= 0) goto fail;
-        uint64_t len = IM::byteswap((uint64_t)size);
-        if (stream->writeFixSize(&len, sizeof(len)) <= 0) goto fail;
-    }
-    if (size > 0) {
-        if (stream->writeFixSize(payload.data(), payload.size()) <= 0) goto fail;
-    }
-    return (int32_t)(2 + (len_indicator == 126 ? 2 : (len_indicator == 127 ? 8 : 0)) + size);
-
-fail:
-    stream->close();
-    return -1;
+    // 服务端发给客户端不掩码
+    return WSSendFrame(stream, WSFrameHead::CLOSE, true, payload.data(), payload.size(), false);
 }
-}  // namespace IM::http
\ No newline at end of file
+}  // namespace IM::http
@@ -9,15 +9,20 @@
 #ifndef __IM_NET_HTTP_WS_SESSION_HPP__
 #define __IM_NET_HTTP_WS_SESSION_HPP__
 
+#include <deque>
+#include <list>
 #include <memory>
 #include <stdint.h>
 #include <string>
+#include <vector>
 
 #include "core/config/config.hpp"
+#include "core/io/lock.hpp"
 
 #include "http_session.hpp"
 
 namespace IM::http {
+class WSDeflate;
 
 /**
  * @struct  WSFrameHead
@@ -107,18 +112,76 @@ class WSFrameMessage {
     std::string m_data;  ///< 消息内容
 };
 
+/// 帧头最大长度：2字节基本头 + 8字节扩展长度 + 4字节掩码
+static const size_t kWSMaxFrameHeadSize = 14;
+
+/**
+ * @class   WSFrameBuffer
+ * @brief   编码完成的不可变服务端帧（帧头 + 载荷），按引用计数共享
+ *
+ * 广播时载荷只序列化、成帧一次，所有会话的发送队列引用同一块内存，不再逐个复制。
+ */
+class WSFrameBuffer {
+   public:
+    using ptr = std::shared_ptr<const WSFrameBuffer>;  ///< 智能指针类型
+
+    /**
+     * @brief   编码一帧（不掩码）
+     * @param   payload 载荷
+     * @param   opcode  操作码，默认文本帧
+     * @param   fin     是否为消息最后一帧
+     */
+    static ptr Create(const std::string &payload, int32_t opcode = WSFrameHead::TEXT_FRAME, bool fin = true);
+
+    /**
+     * @brief   完整帧数据
+     */
+    const std::string &getData() const { return m_data; }
+
+    /**
+     * @brief   载荷，协商了压缩的会话需要重新压缩成帧
+     */
+    const char *getPayload() const { return m_data.data() + m_headLen; }
+    size_t getPayloadSize() const { return m_data.size() - m_headLen; }
+
+    int32_t getOpcode() const { return m_opcode; }
+    bool isFin() const { return m_fin; }
+
+   private:
+    WSFrameBuffer(std::string data, size_t head_len, int32_t opcode, bool fin)
+        : m_data(std::move(data)), m_headLen(head_len), m_opcode(opcode), m_fin(fin) {}
+
+   private:
+    std::string m_data;  ///< 帧头 + 载荷
+    size_t m_headLen;    ///< 帧头长度
+    int32_t m_opcode;    ///< 操作码
+    bool m_fin;          ///< 是否为消息最后一帧
+};
+
 /**
  * @class   WSSession
  * @brief   WebSocket协议会话类，继承自HttpSession
  *
  * 管理单个WebSocket连接的生命周期，包括握手、消息收发、心跳、关闭等。
  * 支持服务端和客户端两种模式。
- * @note    线程不安全，需由上层保证并发安全。
+ * 发送经由有界发送队列：任意协程/线程并发调用 sendMessage 只负责入队，同一时刻只有一个发送协程
+ * 把排队的帧合并为一次 writev 写出；客户端读得慢导致队列超过上限(websocket.send_queue.*)时，
+ * 按配置丢弃最早的数据帧或断开连接。控制帧与分片帧不可丢弃但同样计入上限，空队列总是接纳一帧。
+ * 发送协程按启动它的入队协程的优先级调度，由控制帧启动时按 HIGH 调度，PONG 不会排在批量任务之后。
+ * @note    接收(recvMessage)只能由一个协程调用。
  */
-class WSSession : public HttpSession {
+class WSSession : public HttpSession, public std::enable_shared_from_this<WSSession> {
    public:
     using ptr = std::shared_ptr<WSSession>;  ///< 智能指针类型
 
+    /**
+     * @brief   发送队列满时的处理策略
+     */
+    enum OverflowPolicy {
+        DROP_OLDEST = 0,  ///< 丢弃最早入队的数据帧
+        DISCONNECT = 1    ///< 断开跟不上的慢客户端
+    };
+
     /**
      * @brief   构造函数
      * @param   sock   套接字对象
@@ -129,7 +192,7 @@ class WSSession : public HttpSession {
     /**
      * @brief   处理WebSocket握手（服务端/客户端）
      * @return  握手成功返回HttpRequest指针，失败返回nullptr
-     * @note    仅在连接建立初期调用
+     * @note    仅在连接建立初期调用；客户端请求 permessage-deflate 且配置开启时协商压缩
      */
     HttpRequest::ptr handleShake();
 
@@ -144,7 +207,8 @@ class WSSession : public HttpSession {
      * @brief   发送一条WebSocket消息
      * @param   msg  消息对象
      * @param   fin  是否为消息最后一帧（默认true）
-     * @return  实际发送字节数，失败返回负值
+     * @return  入队的帧长度，连接已关闭或因队列满被断开时返回负值
+     * @note    帧进入发送队列后立即返回，由发送协程写出，不会阻塞调用方
      */
     int32_t sendMessage(WSFrameMessage::ptr msg, bool fin = true);
 
@@ -153,10 +217,17 @@ class WSSession : public HttpSession {
      * @param   msg    消息内容
      * @param   opcode 操作码，默认文本帧
      * @param   fin    是否为消息最后一帧
-     * @return  实际发送字节数，失败返回负值
+     * @return  入队的帧长度，失败返回负值
      */
     int32_t sendMessage(const std::string &msg, int32_t opcode = WSFrameHead::TEXT_FRAME, bool fin = true);
 
+    /**
+     * @brief   发送已编码的共享帧，只入队引用，不复制数据
+     * @param   frame  共享帧
+     * @return  入队的帧长度，失败返回负值
+     */
+    int32_t sendFrame(const WSFrameBuffer::ptr &frame);
+
     /**
      * @brief   主动发送PING帧
      * @return  发送结果
@@ -169,6 +240,38 @@ class WSSession : public HttpSession {
      */
     int32_t pong();
 
+    /**
+     * @brief   发送关闭帧
+     * @param   code    关闭状态码
+     * @param   reason  关闭原因
+     * @return  发送结果
+     * @note    返回时关闭帧及之前排队的帧已写出(或连接已断开)，之后可以直接关闭连接
+     */
+    int32_t sendClose(uint16_t code = 1000, const std::string &reason = "");
+
+    /**
+     * @brief   发送队列中等待写出的帧数
+     */
+    size_t getSendQueueSize() const;
+
+    /**
+     * @brief   因发送队列满被丢弃的帧数
+     */
+    uint64_t getDroppedFrames() const;
+
+    /**
+     * @brief   permessage-deflate 上下文，未协商时为空
+     */
+    const std::shared_ptr<WSDeflate> &getDeflate() const { return m_deflate; }
+
+    /**
+     * @brief   把同一帧发给多个会话
+     * @param   sessions  目标会话
+     * @param   frame     共享帧
+     * @return  成功入队的会话数
+     */
+    static size_t Broadcast(const std::vector<WSSession::ptr> &sessions, const WSFrameBuffer::ptr &frame);
+
    private:
     /**
      * @brief   服务端握手处理
@@ -181,6 +284,62 @@ class WSSession : public HttpSession {
      * @return  是否成功
      */
     bool handleClientShake();
+
+    /**
+     * @brief   待发送的帧：栈式帧头 + 独占载荷，或引用共享帧
+     */
+    struct OutFrame {
+        uint8_t head[kWSMaxFrameHeadSize] = {};  ///< 编码好的帧头
+        uint8_t headLen = 0;                     ///< 帧头长度
+        bool droppable = false;                  ///< 队列满时可否丢弃(完整的单帧数据消息)
+        std::string payload;                     ///< 载荷
+        WSFrameBuffer::ptr shared;               ///< 共享帧，非空时 head/payload 不使用
+
+        size_t size() const { return shared ? shared->getData().size() : headLen + payload.size(); }
+    };
+
+    /**
+     * @brief   编码并入队一帧
+     * @return  入队的帧长度，失败返回负值
+     */
+    int32_t enqueueFrame(int32_t opcode, bool fin, std::string payload);
+
+    /**
+     * @brief   入队一帧，必要时启动发送协程
+     * @param   frame  待发送的帧
+     * @param   close  是否为关闭帧：此后不再接受新帧，返回前确保本帧及之前排队的帧已写出
+     *                 (发送协程未运行时由当前协程直接写出，否则等待发送协程写完)
+     * @return  入队的帧长度，失败返回负值
+     */
+    int32_t enqueue(OutFrame frame, bool close);
+
+    /**
+     * @brief   发送协程：把队列中的帧批量聚集写出，直到队列为空
+     */
+    void drainSendQueue();
+
+    /**
+     * @brief   协商了压缩时压缩完整的单帧数据消息，改写为置 RSV1 的独占帧
+     * @details 只在发送协程中调用，帧的压缩顺序与写出顺序一致，上下文接管才能正确解压
+     * @return  压缩失败返回false
+     */
+    bool compressFrame(OutFrame &frame);
+
+    /**
+     * @brief   断开连接但保留 fd，由接收协程所在的会话流程最终关闭
+     */
+    void shutdownSocket();
+
+   private:
+    mutable SpinLock m_sendMutex;          ///< 保护发送队列
+    std::deque<OutFrame> m_sendQueue;      ///< 发送队列
+    size_t m_sendQueueBytes = 0;           ///< 发送队列中的字节数
+    bool m_writing = false;                ///< 是否有发送协程在运行
+    bool m_sendClosed = false;             ///< 写出失败或被断开后不再接受新帧
+    bool m_closeQueued = false;            ///< 关闭帧已入队，不再接受新帧
+    std::list<SyncWaiter> m_drainWaiters;  ///< 等待发送协程写完队列的关闭方
+    uint64_t m_droppedFrames = 0;          ///< 因队列满被丢弃的帧数
+    std::shared_ptr<WSDeflate> m_deflate;  ///< permessage-deflate 上下文，握手后只读
 };
 
 /**
@@ -190,6 +349,13 @@ class WSSession : public HttpSession {
  */
 extern IM::ConfigVar<uint32_t>::ptr g_websocket_message_max_size;
 
+/**
+ * @var g_websocket_recv_buffer_size
+ * @brief   WebSocket连接的用户态接收缓冲区大小配置项
+ * @note    帧头与小帧从缓冲区解析，0 表示不使用缓冲区
+ */
+extern IM::ConfigVar<uint32_t>::ptr g_websocket_recv_buffer_size;
+
 /**
  * @brief   从流中接收一条WebSocket消息
  * @param   stream  数据流指针
@@ -198,6 +364,29 @@ extern IM::ConfigVar<uint32_t>::ptr g_websocket_message_max_size;
  */
 WSFrameMessage::ptr WSRecvMessage(Stream *stream, bool client, IM::NgxMemPool *pool = nullptr);
 
+/**
+ * @brief   编码帧头
+ * @param   buf     输出缓冲区，至少 kWSMaxFrameHeadSize 字节
+ * @param   opcode  操作码
+ * @param   fin     是否为消息最后一帧
+ * @param   size    载荷长度
+ * @param   mask    4字节掩码，nullptr 表示不掩码（服务端发送）
+ * @return  帧头长度
+ */
+size_t WSEncodeFrameHead(uint8_t *buf, int32_t opcode, bool fin, uint64_t size, const char *mask = nullptr);
+
+/**
+ * @brief   发送一帧：帧头在栈上编码，与载荷一次 writev 写出
+ * @param   stream  数据流指针
+ * @param   opcode  操作码
+ * @param   fin     是否为消息最后一帧
+ * @param   data    载荷
+ * @param   size    载荷长度
+ * @param   client  是否为客户端模式（客户端发送需掩码，载荷会被复制后掩码）
+ * @return  实际发送字节数，失败返回负值并关闭流
+ */
+int32_t WSSendFrame(Stream *stream, int32_t opcode, bool fin, const void *data, size_t size, bool client);
+
 /**
  * @brief   发送一条WebSocket消息到流
  * @param   stream  数据流指针
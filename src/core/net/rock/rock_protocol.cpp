@@ -3,7 +3,9 @@
 #include "core/base/endian.hpp"
 #include "core/base/macro.hpp"
 #include "core/config/config.hpp"
+#include "core/io/compute_pool.hpp"
 #include "core/net/streams/zlib_stream.hpp"
+#include "core/util/time_util.hpp"
 
 namespace IM {
 static auto g_logger = IM_LOG_NAME("system");
@@ -34,7 +36,11 @@ std::shared_ptr<RockResponse> RockRequest::createResponse() {
 
 std::string RockRequest::toString() const {
     std::stringstream ss;
-    ss << "[RockRequest sn=" << m_sn << " cmd=" << m_cmd << " body.length=" << m_body.size() << "]";
+    ss << "[RockRequest sn=" << m_sn << " cmd=" << m_cmd << " body.length=" << m_body.size();
+    if (m_timeout) {
+        ss << " timeout=" << m_timeout;
+    }
+    ss << "]";
     return ss.str();
 }
 
@@ -52,6 +58,9 @@ bool RockRequest::serializeToByteArray(ByteArray::ptr bytearray) {
         bool v = true;
         v &= Request::serializeToByteArray(bytearray);
         v &= RockBody::serializeToByteArray(bytearray);
+        if (m_timeout) {
+            bytearray->writeUint32(m_timeout);
+        }
         return v;
     } catch (...) {
         IM_LOG_ERROR(g_logger) << "RockRequest serializeToByteArray error";
@@ -64,6 +73,10 @@ bool RockRequest::parseFromByteArray(ByteArray::ptr bytearray) {
         bool v = true;
         v &= Request::parseFromByteArray(bytearray);
         v &= RockBody::parseFromByteArray(bytearray);
+        if (bytearray->getReadSize() > 0) {
+            m_timeout = bytearray->readUint32();
+            m_deadline = m_timeout ? TimeUtil::NowToMS() + m_timeout : 0;
+        }
         return v;
     } catch (...) {
         IM_LOG_ERROR(g_logger) << "RockRequest parseFromByteArray error";
@@ -186,16 +199,22 @@ Message::ptr RockMessageDecoder::parseFrom(Stream::ptr stream) {
 
         ba->setPosition(0);
         if (header.flag & 0x1) {  // gizp
-            auto zstream = ZlibStream::CreateGzip(false);
-            if (zstream->write(ba, -1) != Z_OK) {
-                IM_LOG_ERROR(g_logger) << "RockMessageDecoder ungzip error";
+            // 解压在计算池执行，避免大包阻塞同线程的其他连接
+            ba = ComputePool::Await([&ba]() -> ByteArray::ptr {
+                auto zstream = ZlibStream::CreateGzip(false);
+                if (zstream->write(ba, -1) != Z_OK) {
+                    IM_LOG_ERROR(g_logger) << "RockMessageDecoder ungzip error";
+                    return nullptr;
+                }
+                if (zstream->flush() != Z_OK) {
+                    IM_LOG_ERROR(g_logger) << "RockMessageDecoder ungzip flush error";
+                    return nullptr;
+                }
+                return zstream->getByteArray();
+            });
+            if (!ba) {
                 return nullptr;
             }
-            if (zstream->flush() != Z_OK) {
-                IM_LOG_ERROR(g_logger) << "RockMessageDecoder ungzip flush error";
-                return nullptr;
-            }
-            ba = zstream->getByteArray();
         }
         uint8_t type = ba->readFuint8();
         Message::ptr msg;
@@ -233,17 +252,25 @@ int32_t RockMessageDecoder::serializeTo(Stream::ptr stream, Message::ptr msg) {
     ba->setPosition(0);
     header.length = ba->getDataSize();
     if ((uint32_t)header.length >= g_rock_protocol_gzip_min_length->getValue()) {
-        auto zstream = ZlibStream::CreateGzip(true);
-        if (zstream->write(ba, -1) != Z_OK) {
-            IM_LOG_ERROR(g_logger) << "RockMessageDecoder serializeTo gizp error";
-            return -1;
-        }
-        if (zstream->flush() != Z_OK) {
-            IM_LOG_ERROR(g_logger) << "RockMessageDecoder serializeTo gizp flush error";
-            return -2;
+        // 压缩在计算池执行，避免大包阻塞同线程的其他连接
+        int32_t rt = 0;
+        ba = ComputePool::Await([&ba, &rt]() -> ByteArray::ptr {
+            auto zstream = ZlibStream::CreateGzip(true);
+            if (zstream->write(ba, -1) != Z_OK) {
+                IM_LOG_ERROR(g_logger) << "RockMessageDecoder serializeTo gizp error";
+                rt = -1;
+                return nullptr;
+            }
+            if (zstream->flush() != Z_OK) {
+                IM_LOG_ERROR(g_logger) << "RockMessageDecoder serializeTo gizp flush error";
+                rt = -2;
+                return nullptr;
+            }
+            return zstream->getByteArray();
+        });
+        if (!ba) {
+            return rt;
         }
-
-        ba = zstream->getByteArray();
         header.flag |= 0x1;
         header.length = ba->getDataSize();
     }
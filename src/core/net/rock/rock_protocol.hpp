@@ -58,12 +58,28 @@ class RockRequest : public Request, public RockBody {
 
     std::shared_ptr<RockResponse> createResponse();
 
+    /**
+     * @brief 调用方剩余的时间预算(毫秒)，0表示不限
+     * @details 作为可选字段追加在消息体之后，不携带该字段的旧版本消息与之互通
+     */
+    uint32_t getTimeout() const { return m_timeout; }
+    void setTimeout(uint32_t v) { m_timeout = v; }
+
+    /**
+     * @brief 本地截止时间(毫秒时间戳)，解析时由 timeout 换算，0表示不限，不参与序列化
+     */
+    uint64_t getDeadline() const { return m_deadline; }
+
     virtual std::string toString() const override;
     virtual const std::string &getName() const override;
     virtual int32_t getType() const override;
 
     virtual bool serializeToByteArray(ByteArray::ptr bytearray) override;
     virtual bool parseFromByteArray(ByteArray::ptr bytearray) override;
+
+   protected:
+    uint32_t m_timeout = 0;   ///< 时间预算(毫秒)
+    uint64_t m_deadline = 0;  ///< 本地截止时间
 };
 
 class RockResponse : public Response, public RockBody {
@@ -10,10 +10,14 @@ static Logger::ptr g_logger = IM_LOG_NAME("system");
 RockServer::RockServer(const std::string &type, IOManager *worker, IOManager *io_worker, IOManager *accept_worker)
     : TcpServer(worker, io_worker, accept_worker) {
     m_type = type;
+    // 服务间 RPC 链路是长连接，空闲是常态，不使用 tcp_server.read_timeout；
+    // 对端失联由 TCP keepalive 发现，连接断开后由客户端重连
+    setRecvTimeout((uint64_t)-1);
 }
 
 void RockServer::handleClient(Socket::ptr client) {
     IM_LOG_DEBUG(g_logger) << "handleClient " << *client;
+    client->setOption(SOL_SOCKET, SO_KEEPALIVE, (int)1);
     RockSession::ptr session(new RockSession(client));
     session->setWorker(m_worker);
     ModuleMgr::GetInstance()->foreach (Module::ROCK, [session](Module::ptr m) { m->onConnect(session); });
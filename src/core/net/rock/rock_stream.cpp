@@ -2,7 +2,9 @@
 
 #include "core/base/macro.hpp"
 #include "core/config/config.hpp"
+#include "core/io/stack_profiler.hpp"
 #include "core/io/worker.hpp"
+#include "core/util/deadline_context.hpp"
 #include "core/util/time_util.hpp"
 #include "core/util/trace_context.hpp"
 
@@ -11,6 +13,9 @@ static Logger::ptr g_logger = IM_LOG_NAME("system");
 static ConfigVar<std::unordered_map<std::string, std::unordered_map<std::string, std::string>>>::ptr g_rock_services =
     Config::Lookup("rock_services", std::unordered_map<std::string, std::unordered_map<std::string, std::string>>(),
                    "rock_services");
+// Rock 连接数少、单包较大，按大缓冲区读取
+static ConfigVar<uint32_t>::ptr g_rock_recv_buffer_size =
+    Config::Lookup("rock.recv_buffer_size", (uint32_t)(1024 * 64), "rock per-connection receive buffer size");
 
 std::string RockResult::toString() const {
     std::stringstream ss;
@@ -21,6 +26,7 @@ std::string RockResult::toString() const {
 }
 
 RockStream::RockStream(Socket::ptr sock) : AsyncSocketStream(sock, true), m_decoder(new RockMessageDecoder) {
+    setReadBuffer(g_rock_recv_buffer_size->getValue());
     IM_LOG_DEBUG(g_logger) << "RockStream::RockStream " << this << " " << (sock ? sock->toString() : "");
 }
 
@@ -44,6 +50,12 @@ RockResult::ptr RockStream::request(RockRequest::ptr req, uint32_t timeout_ms) {
         if (req->getTraceId().empty()) {
             req->setTraceId(TraceContext::GetTraceId());
         }
+        // 超时不超过调用方的剩余时间，剩余时间随请求下发，下游据此放弃已过期的请求
+        timeout_ms = DeadlineContext::Clamp(timeout_ms);
+        if (timeout_ms == 0) {
+            return std::make_shared<RockResult>(AsyncSocketStream::TIMEOUT, 0, nullptr, req);
+        }
+        req->setTimeout(timeout_ms);
         RockCtx::ptr ctx(new RockCtx);
         ctx->request = req;
         ctx->sn = req->getSn();
@@ -126,7 +138,24 @@ AsyncSocketStream::Ctx::ptr RockStream::doRecv() {
 
 void RockStream::handleRequest(RockRequest::ptr req) {
     TraceGuard guard(req->getTraceId());
+    if (StackProfiler::IsEnabled()) {
+        StackProfiler::SetTag("rock:" + std::to_string(req->getCmd()));
+    }
     RockResponse::ptr rsp = req->createResponse();
+    // 在队列中等待期间调用方已经超时，结果不会再被使用，不再执行
+    uint64_t timeout = 0;
+    if (req->getDeadline()) {
+        uint64_t now = TimeUtil::NowToMS();
+        if (now >= req->getDeadline()) {
+            IM_LOG_DEBUG(g_logger) << "drop expired request " << req->toString();
+            rsp->setResult(504);
+            rsp->setResultStr("deadline exceeded");
+            sendMessage(rsp);
+            return;
+        }
+        timeout = req->getDeadline() - now;
+    }
+    DeadlineGuard deadline_guard(timeout);
     if (!m_requestHandler(req, rsp, std::dynamic_pointer_cast<RockStream>(shared_from_this()))) {
         sendMessage(rsp);
         close();
@@ -54,6 +54,8 @@ bool AsyncSocketStream::start() {
                 break;
             }
         }
+        // 重连后上一条连接残留的未解析数据作废
+        m_readBuffer.clear();
 
         if (m_connectCb) {
             if (!m_connectCb(shared_from_this())) {
@@ -15,11 +15,48 @@ bool SocketStream::isConnected() const {
     return m_socket && m_socket->isConnected();
 }
 
+int SocketStream::recvToBuffer() {
+    iovec iovs[2];
+    size_t cnt = m_readBuffer.getWriteBuffers(iovs);
+    if (!cnt) {
+        return -1;
+    }
+    int rt = m_socket->recv(iovs, cnt);
+    if (rt > 0) {
+        m_readBuffer.commitWrite(rt);
+    }
+    return rt;
+}
+
+int SocketStream::fill(size_t length) {
+    if (!isConnected() || length > m_readBuffer.capacity()) {
+        return -1;
+    }
+    while (m_readBuffer.size() < length) {
+        int rt = recvToBuffer();
+        if (rt <= 0) {
+            return rt;
+        }
+    }
+    return m_readBuffer.size();
+}
+
 int SocketStream::read(void *buffer, size_t length) {
     if (!isConnected()) {
         return -1;
     }
-    return m_socket->recv(buffer, length);
+    if (!m_readBuffer.empty()) {
+        return m_readBuffer.read(buffer, length);
+    }
+    // 未启用缓冲区或大块读取(如帧载荷)直接读入目标内存，避免多一次拷贝
+    if (length >= m_readBuffer.capacity()) {
+        return m_socket->recv(buffer, length);
+    }
+    int rt = recvToBuffer();
+    if (rt <= 0) {
+        return rt;
+    }
+    return m_readBuffer.read(buffer, length);
 }
 
 int SocketStream::read(ByteArray::ptr ba, size_t length) {
@@ -27,6 +64,24 @@ int SocketStream::read(ByteArray::ptr ba, size_t length) {
         return -1;
     }
 
+    if (m_readBuffer.empty() && length < m_readBuffer.capacity()) {
+        int rt = recvToBuffer();
+        if (rt <= 0) {
+            return rt;
+        }
+    }
+    if (!m_readBuffer.empty()) {
+        iovec iovs[2];
+        size_t cnt = m_readBuffer.getReadBuffers(iovs, length);
+        size_t rt = 0;
+        for (size_t i = 0; i < cnt; ++i) {
+            ba->write(iovs[i].iov_base, iovs[i].iov_len);
+            rt += iovs[i].iov_len;
+        }
+        m_readBuffer.consume(rt);
+        return rt;
+    }
+
     // 获取可写缓冲区
     std::vector<iovec> iovs;
     ba->getWriteBuffers(iovs, length);
@@ -58,6 +113,13 @@ int SocketStream::write(ByteArray::ptr ba, size_t length) {
     return rt;
 }
 
+int SocketStream::writev(const iovec *iov, size_t count) {
+    if (!isConnected()) {
+        return -1;
+    }
+    return m_socket->send(iov, count);
+}
+
 void SocketStream::close() {
     if (m_socket) {
         m_socket->close();
@@ -10,6 +10,7 @@
 #ifndef __IM_NET_STREAMS_SOCKET_STREAM_HPP__
 #define __IM_NET_STREAMS_SOCKET_STREAM_HPP__
 
+#include "core/ds/ring_buffer.hpp"
 #include "core/io/iomanager.hpp"
 #include "core/net/core/socket.hpp"
 #include "core/net/core/stream.hpp"
@@ -35,6 +36,45 @@ class SocketStream : public Stream {
      */
     ~SocketStream();
 
+    /**
+     * @brief 设置用户态接收缓冲区
+     * @details 启用后小块读取由缓冲区提供，缓冲区读空时一次 recv 尽量读满，不小于缓冲区容量的读取直接读 Socket。
+     *          已缓存的数据被丢弃，应在开始读取之前设置
+     * @param[in] size 缓冲区大小，0 表示不使用缓冲区(默认)
+     */
+    void setReadBuffer(size_t size) { m_readBuffer.reset(size); }
+
+    /**
+     * @brief 接收缓冲区容量，未启用时为0
+     */
+    size_t getReadBufferSize() const { return m_readBuffer.capacity(); }
+
+    /**
+     * @brief 接收缓冲区中尚未读取的字节数
+     */
+    size_t getBufferedSize() const { return m_readBuffer.size(); }
+
+    /**
+     * @brief 确保接收缓冲区中至少有 length 字节，不足时从 Socket 读取
+     * @param[in] length 需要的字节数，不能超过缓冲区容量
+     * @return
+     *      @retval >0 缓冲区中的字节数(不小于length)
+     *      @retval =0 socket被远端关闭
+     *      @retval <0 socket错误，或未启用缓冲区、length 超过容量
+     */
+    int fill(size_t length);
+
+    /**
+     * @brief 从接收缓冲区复制数据，不移出
+     * @return size_t 实际复制的字节数
+     */
+    size_t peek(void *buffer, size_t length) const { return m_readBuffer.peek(buffer, length); }
+
+    /**
+     * @brief 从接收缓冲区移出数据
+     */
+    void consume(size_t length) { m_readBuffer.consume(length); }
+
     /**
      * @brief 从 Socket 读取数据到指定内存缓冲区
      * @param[out] buffer 待接收数据的内存
@@ -79,6 +119,17 @@ class SocketStream : public Stream {
      */
     virtual int write(ByteArray::ptr ba, size_t length) override;
 
+    /**
+     * @brief 一次 sendmsg 写出多段内存
+     * @param[in] iov 内存段
+     * @param[in] count 内存段数量
+     * @return
+     *      @retval >0 返回实际发送的数据长度
+     *      @retval =0 socket被远端关闭
+     *      @retval <0 socket错误
+     */
+    virtual int writev(const iovec *iov, size_t count) override;
+
     /**
      * @brief 关闭socket
      */
@@ -114,9 +165,16 @@ class SocketStream : public Stream {
      */
     std::string getLocalAddressString();
 
+   private:
+    /**
+     * @brief 一次 recv 把 Socket 中的数据读入接收缓冲区的空闲空间
+     */
+    int recvToBuffer();
+
    protected:
-    Socket::ptr m_socket;  /// Socket类
-    bool m_owner;          /// 是否主控
+    Socket::ptr m_socket;         /// Socket类
+    bool m_owner;                 /// 是否主控
+    ds::RingBuffer m_readBuffer;  /// 用户态接收缓冲区
 };
 }  // namespace IM
 
@@ -53,9 +53,9 @@ int ZlibStream::write(const void *buffer, size_t length) {
     ivc.iov_base = (void *)buffer;
     ivc.iov_len = length;
     if (m_encode) {
-        return encode(&ivc, 1, false);
+        return encode(&ivc, 1, Z_NO_FLUSH);
     } else {
-        return decode(&ivc, 1, false);
+        return decode(&ivc, 1, Z_NO_FLUSH);
     }
 }
 
@@ -63,12 +63,45 @@ int ZlibStream::write(ByteArray::ptr ba, size_t length) {
     std::vector<iovec> buffers;
     ba->getReadBuffers(buffers, length);
     if (m_encode) {
-        return encode(&buffers[0], buffers.size(), false);
+        return encode(&buffers[0], buffers.size(), Z_NO_FLUSH);
     } else {
-        return decode(&buffers[0], buffers.size(), false);
+        return decode(&buffers[0], buffers.size(), Z_NO_FLUSH);
     }
 }
 
+int ZlibStream::sync(const void *buffer, size_t length) {
+    iovec ivc;
+    ivc.iov_base = (void *)buffer;
+    ivc.iov_len = length;
+    if (m_encode) {
+        return encode(&ivc, 1, Z_SYNC_FLUSH);
+    } else {
+        return decode(&ivc, 1, Z_SYNC_FLUSH);
+    }
+}
+
+int ZlibStream::reset() {
+    clearResult();
+    return m_encode ? deflateReset(&m_zstream) : inflateReset(&m_zstream);
+}
+
+void ZlibStream::clearResult() {
+    if (m_free) {
+        for (auto &i : m_buffs) {
+            free(i.iov_base);
+        }
+    }
+    m_buffs.clear();
+}
+
+size_t ZlibStream::getResultSize() const {
+    size_t rt = 0;
+    for (auto &i : m_buffs) {
+        rt += i.iov_len;
+    }
+    return rt;
+}
+
 void ZlibStream::close() {
     flush();
 }
@@ -103,14 +136,15 @@ int ZlibStream::init(Type type, int level, int window_bits, int memlevel, Strate
     }
 }
 
-int ZlibStream::encode(const iovec *v, const uint64_t &size, bool finish) {
+int ZlibStream::encode(const iovec *v, const uint64_t &size, int flush_mode) {
     int ret = 0;
     int flush = 0;
     for (uint64_t i = 0; i < size; ++i) {
         m_zstream.avail_in = v[i].iov_len;
         m_zstream.next_in = (Bytef *)v[i].iov_base;
 
-        flush = finish ? (i == size - 1 ? Z_FINISH : Z_NO_FLUSH) : Z_NO_FLUSH;
+        // 刷新方式只作用于最后一段输入
+        flush = i == size - 1 ? flush_mode : Z_NO_FLUSH;
 
         iovec *ivc = nullptr;
         do {
@@ -140,14 +174,15 @@ int ZlibStream::encode(const iovec *v, const uint64_t &size, bool finish) {
     return Z_OK;
 }
 
-int ZlibStream::decode(const iovec *v, const uint64_t &size, bool finish) {
+int ZlibStream::decode(const iovec *v, const uint64_t &size, int flush_mode) {
     int ret = 0;
     int flush = 0;
+    size_t total = m_maxResultSize ? getResultSize() : 0;
     for (uint64_t i = 0; i < size; ++i) {
         m_zstream.avail_in = v[i].iov_len;
         m_zstream.next_in = (Bytef *)v[i].iov_base;
 
-        flush = finish ? (i == size - 1 ? Z_FINISH : Z_NO_FLUSH) : Z_NO_FLUSH;
+        flush = i == size - 1 ? flush_mode : Z_NO_FLUSH;
 
         iovec *ivc = nullptr;
         do {
@@ -164,11 +199,18 @@ int ZlibStream::decode(const iovec *v, const uint64_t &size, bool finish) {
             m_zstream.avail_out = m_buffSize - ivc->iov_len;
             m_zstream.next_out = (Bytef *)ivc->iov_base + ivc->iov_len;
 
+            size_t before = ivc->iov_len;
             ret = inflate(&m_zstream, flush);
-            if (ret == Z_STREAM_ERROR) {
+            // 输入来自网络，损坏的数据需要报告给调用方；Z_BUF_ERROR 只表示本次没有进展
+            if (ret == Z_STREAM_ERROR || ret == Z_DATA_ERROR || ret == Z_MEM_ERROR || ret == Z_NEED_DICT) {
                 return ret;
             }
             ivc->iov_len = m_buffSize - m_zstream.avail_out;
+            // 限制解压后的大小，防止很小的输入解压出巨量数据
+            total += ivc->iov_len - before;
+            if (m_maxResultSize && total > m_maxResultSize) {
+                return Z_MEM_ERROR;
+            }
         } while (m_zstream.avail_out == 0);
     }
 
@@ -184,9 +226,9 @@ int ZlibStream::flush() {
     ivc.iov_len = 0;
 
     if (m_encode) {
-        return encode(&ivc, 1, true);
+        return encode(&ivc, 1, Z_FINISH);
     } else {
-        return decode(&ivc, 1, true);
+        return decode(&ivc, 1, Z_FINISH);
     }
 }
 
@@ -59,6 +59,32 @@ class ZlibStream : public Stream {
 
     int flush();
 
+    /**
+     * @brief 写入数据并以 Z_SYNC_FLUSH 刷新，输出按字节对齐且以 00 00 FF FF 结尾，流可继续使用
+     * @details 用于 WebSocket permessage-deflate：每条消息同步刷新一次，多条消息共享压缩上下文
+     */
+    int sync(const void *buffer, size_t length);
+
+    /**
+     * @brief 重置压缩上下文并释放已输出的数据，流可继续使用
+     */
+    int reset();
+
+    /**
+     * @brief 释放已输出的数据，不影响压缩上下文
+     */
+    void clearResult();
+
+    /**
+     * @brief 已输出的字节数
+     */
+    size_t getResultSize() const;
+
+    /**
+     * @brief 解压输出上限，超过时 write/sync 返回 Z_MEM_ERROR，0 表示不限制
+     */
+    void setMaxResultSize(size_t v) { m_maxResultSize = v; }
+
     bool isFree() const { return m_free; }
     void setFree(bool v) { m_free = v; }
 
@@ -73,8 +99,8 @@ class ZlibStream : public Stream {
     int init(Type type = DEFLATE, int level = DEFAULT_COMPRESSION, int window_bits = 15, int memlevel = 8,
              Strategy strategy = DEFAULT);
 
-    int encode(const iovec *v, const uint64_t &size, bool finish);
-    int decode(const iovec *v, const uint64_t &size, bool finish);
+    int encode(const iovec *v, const uint64_t &size, int flush);
+    int decode(const iovec *v, const uint64_t &size, int flush);
 
    private:
     z_stream m_zstream;
@@ -82,6 +108,7 @@ class ZlibStream : public Stream {
     bool m_encode;
     bool m_free;
     std::vector<iovec> m_buffs;
+    size_t m_maxResultSize = 0;
 };
 }  // namespace IM
 
@@ -446,6 +446,9 @@ int Application::run_coroutine() {
             server->setName(i.name);
         }
 
+        // 设置服务器配置(reuse_port 等需在 bind 之前生效)
+        server->setConf(i);
+
         // 绑定服务器地址
         std::vector<Address::ptr> fails;
         if (!server->bind(address, fails, i.ssl)) {
@@ -463,8 +466,7 @@ int Application::run_coroutine() {
             }
         }
 
-        // 设置服务器配置并添加到服务器列表
-        server->setConf(i);
+        // 添加到服务器列表
         m_servers[i.type].push_back(server);
         svrs.push_back(server);
     }
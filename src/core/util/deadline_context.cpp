@@ -0,0 +1,47 @@
+#include "core/util/deadline_context.hpp"
+
+#include "core/io/coroutine.hpp"
+#include "core/util/time_util.hpp"
+
+namespace IM {
+
+uint64_t DeadlineContext::GetDeadline() {
+    auto f = Coroutine::GetThis();
+    if (f) {
+        return f->getDeadline();
+    }
+    return 0;
+}
+
+void DeadlineContext::SetDeadline(uint64_t deadline) {
+    auto f = Coroutine::GetThis();
+    if (f) {
+        f->setDeadline(deadline);
+    }
+}
+
+uint64_t DeadlineContext::GetRemaining() {
+    uint64_t deadline = GetDeadline();
+    if (!deadline) {
+        return ~0ull;
+    }
+    uint64_t now = TimeUtil::NowToMS();
+    return now < deadline ? deadline - now : 0;
+}
+
+uint64_t DeadlineContext::Clamp(uint64_t timeout_ms) {
+    uint64_t remaining = GetRemaining();
+    return remaining < timeout_ms ? remaining : timeout_ms;
+}
+
+DeadlineGuard::DeadlineGuard(uint64_t timeout_ms) : m_prev(DeadlineContext::GetDeadline()) {
+    if (!timeout_ms) {
+        return;
+    }
+    uint64_t deadline = TimeUtil::NowToMS() + timeout_ms;
+    if (!m_prev || deadline < m_prev) {
+        DeadlineContext::SetDeadline(deadline);
+    }
+}
+
+}  // namespace IM
@@ -0,0 +1,67 @@
+/**
+ * @file deadline_context.hpp
+ * @brief 请求截止时间上下文
+ * @author DreamTraveler233
+ * @date 2026-01-10
+ *
+ * 截止时间与 Trace ID 一样保存在当前协程上，沿调用链自动生效：
+ * - HTTP/WS 入口按 http.request.timeout / ws.message.timeout 为每个请求(消息)设置截止时间
+ * - RockStream::request 把超时限制在剩余时间内，并把剩余时间写入请求，下游服务据此恢复截止时间，
+ *   收到时已过期的请求不再执行，直接返回 504
+ * - hook 的 socket IO 与 connect 阻塞等待时不超过剩余时间，已过期时直接以 ETIMEDOUT 失败
+ * - MySQL/Redis 命令在已过期时不再发出；已发出的命令不受截止时间打断(连接标记为 ignoreDeadline)，
+ *   否则读到一半的回复会让池化连接状态错乱
+ * - Async 任务继承调用方的截止时间
+ */
+
+#ifndef __IM_UTIL_DEADLINE_CONTEXT_HPP__
+#define __IM_UTIL_DEADLINE_CONTEXT_HPP__
+
+#include <stdint.h>
+
+namespace IM {
+
+class DeadlineContext {
+   public:
+    /**
+     * @brief 当前协程的截止时间(毫秒时间戳)，0表示未设置
+     */
+    static uint64_t GetDeadline();
+    static void SetDeadline(uint64_t deadline);
+
+    /**
+     * @brief 剩余时间(毫秒)，未设置截止时间返回 ~0ull，已过期返回0
+     */
+    static uint64_t GetRemaining();
+
+    /**
+     * @brief 是否已过期
+     */
+    static bool IsExpired() { return GetRemaining() == 0; }
+
+    /**
+     * @brief 把超时时间限制在剩余时间内
+     * @param[in] timeout_ms 超时时间(毫秒)，~0ull 表示不超时
+     */
+    static uint64_t Clamp(uint64_t timeout_ms);
+};
+
+/**
+ * @brief 在作用域内设置截止时间，析构时恢复外层的截止时间
+ * @details 外层已有更早的截止时间时保留外层，下游的预算不会超过上游
+ */
+class DeadlineGuard {
+   public:
+    /**
+     * @param[in] timeout_ms 从现在起的超时时间(毫秒)，0表示不设置
+     */
+    DeadlineGuard(uint64_t timeout_ms);
+    ~DeadlineGuard() { DeadlineContext::SetDeadline(m_prev); }
+
+   private:
+    uint64_t m_prev;  ///< 外层的截止时间
+};
+
+}  // namespace IM
+
+#endif  // __IM_UTIL_DEADLINE_CONTEXT_HPP__
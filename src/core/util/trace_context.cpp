@@ -9,11 +9,8 @@
 namespace IM {
 
 std::string TraceContext::GetTraceId() {
-    auto f = Coroutine::GetThis();
-    if (f) {
-        return f->getTraceId();
-    }
-    return "";
+    // 每条日志都会读取 TraceID，不能借此创建主协程：主协程构造/析构期间尚无 shared_ptr 持有它
+    return Coroutine::GetCurrentTraceId();
 }
 
 void TraceContext::SetTraceId(const std::string &traceId) {
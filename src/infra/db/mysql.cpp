@@ -2,6 +2,8 @@
 
 #include "core/base/macro.hpp"
 #include "core/config/config.hpp"
+#include "core/net/core/fd_manager.hpp"
+#include "core/util/deadline_context.hpp"
 #include "core/util/string_util.hpp"
 #include "core/util/time_util.hpp"
 
@@ -10,6 +12,15 @@ static auto g_logger = IM_LOG_NAME("system");
 static auto g_mysql_dbs =
     Config::Lookup("mysql.dbs", std::map<std::string, std::map<std::string, std::string>>(), "mysql dbs");
 
+// 当前请求已超过截止时间时不再发出命令，调用方的结果已无人等待
+static bool CheckDeadline(const char *sql) {
+    if (DeadlineContext::IsExpired()) {
+        IM_LOG_WARN(g_logger) << "mysql deadline exceeded, skip: " << sql;
+        return false;
+    }
+    return true;
+}
+
 bool mysql_time_to_time_t(const MYSQL_TIME &mt, time_t &ts) {
     struct tm tm;
     ts = 0;
@@ -75,6 +86,10 @@ static MYSQL *mysql_init(std::map<std::string, std::string> &params, const int &
         mysql_close(mysql);
         return nullptr;
     }
+    // 回复读到一半被请求截止时间打断会让连接状态错乱，截止时间只在命令发出前检查
+    if (FdCtx::ptr ctx = FdMgr::GetInstance()->get(mysql->net.fd)) {
+        ctx->setIgnoreDeadline(true);
+    }
     return mysql;
 }
 
@@ -138,6 +153,10 @@ int MySQL::execute(const char *format, ...) {
 
 int MySQL::execute(const char *format, va_list ap) {
     m_cmd = StringUtil::Formatv(format, ap);
+    if (!CheckDeadline(m_cmd.c_str())) {
+        m_hasError = true;
+        return -1;
+    }
     int r = ::mysql_query(m_mysql.get(), m_cmd.c_str());
     if (r) {
         IM_LOG_ERROR(g_logger) << "cmd=" << cmd() << ", error: " << getErrStr();
@@ -150,6 +169,10 @@ int MySQL::execute(const char *format, va_list ap) {
 
 int MySQL::execute(const std::string &sql) {
     m_cmd = sql;
+    if (!CheckDeadline(m_cmd.c_str())) {
+        m_hasError = true;
+        return -1;
+    }
     int r = ::mysql_query(m_mysql.get(), m_cmd.c_str());
     if (r) {
         IM_LOG_ERROR(g_logger) << "cmd=" << cmd() << ", error: " << getErrStr();
@@ -186,6 +209,10 @@ static MYSQL_RES *my_mysql_query(MYSQL *mysql, const char *sql) {
         return nullptr;
     }
 
+    if (!CheckDeadline(sql)) {
+        return nullptr;
+    }
+
     if (::mysql_query(mysql, sql)) {
         IM_LOG_ERROR(g_logger) << "mysql_query(" << sql << ") error:" << mysql_error(mysql);
         return nullptr;
@@ -466,6 +493,9 @@ int MySQLStmt::bindTime(int idx, const time_t &value) {
 }
 
 int MySQLStmt::execute() {
+    if (!CheckDeadline("stmt execute")) {
+        return -1;
+    }
     mysql_stmt_bind_param(m_stmt, &m_binds[0]);
     return mysql_stmt_execute(m_stmt);
 }
@@ -475,6 +505,9 @@ int64_t MySQLStmt::getLastInsertId() {
 }
 
 ISQLData::ptr MySQLStmt::query() {
+    if (!CheckDeadline("stmt query")) {
+        return nullptr;
+    }
     mysql_stmt_bind_param(m_stmt, &m_binds[0]);
     return MySQLStmtRes::Create(shared_from_this());
 }
@@ -916,7 +949,11 @@ bool MySQLTransaction::rollback() {
     if (m_isFinished) {
         return true;
     }
+    // 回滚不受请求截止时间限制，否则连接归还连接池时仍处于事务中
+    uint64_t deadline = DeadlineContext::GetDeadline();
+    DeadlineContext::SetDeadline(0);
     int rt = execute("ROLLBACK");
+    DeadlineContext::SetDeadline(deadline);
     if (rt == 0) {
         m_isFinished = true;
     } else {
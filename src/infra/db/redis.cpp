@@ -2,6 +2,8 @@
 
 #include "core/base/macro.hpp"
 #include "core/config/config.hpp"
+#include "core/net/core/fd_manager.hpp"
+#include "core/util/deadline_context.hpp"
 #include "core/util/hash_util.hpp"
 
 namespace IM {
@@ -9,6 +11,15 @@ static Logger::ptr g_logger = IM_LOG_NAME("system");
 static ConfigVar<std::map<std::string, std::map<std::string, std::string>>>::ptr g_redis =
     Config::Lookup("redis.config", std::map<std::string, std::map<std::string, std::string>>(), "redis config");
 
+// 当前请求已超过截止时间时不再发出命令，调用方的结果已无人等待
+static bool CheckDeadline(const std::string &name) {
+    if (DeadlineContext::IsExpired()) {
+        IM_LOG_WARN(g_logger) << "redis deadline exceeded, skip command (" << name << ")";
+        return false;
+    }
+    return true;
+}
+
 static std::string get_value(const std::map<std::string, std::string> &m, const std::string &key,
                              const std::string &def = "") {
     auto it = m.find(key);
@@ -95,6 +106,10 @@ bool Redis::connect(const std::string &ip, int port, uint64_t ms) {
     auto c = redisConnectWithTimeout(ip.c_str(), port, tv);
     if (c) {
         m_context.reset(c, redisFree);
+        // 回复读到一半被请求截止时间打断会让连接状态错乱，截止时间只在命令发出前检查
+        if (FdCtx::ptr ctx = FdMgr::GetInstance()->get(c->fd)) {
+            ctx->setIgnoreDeadline(true);
+        }
 
         if (m_cmdTimeout.tv_sec || m_cmdTimeout.tv_usec) {
             setTimeout(m_cmdTimeout.tv_sec * 1000 + m_cmdTimeout.tv_usec / 1000);
@@ -145,6 +160,9 @@ ReplyPtr Redis::cmd(const char *fmt, ...) {
 }
 
 ReplyPtr Redis::cmd(const char *fmt, va_list ap) {
+    if (!CheckDeadline(m_name)) {
+        return nullptr;
+    }
     auto r = (redisReply *)redisvCommand(m_context.get(), fmt, ap);
     if (!r) {
         if (m_logEnable) {
@@ -165,6 +183,9 @@ ReplyPtr Redis::cmd(const char *fmt, va_list ap) {
 }
 
 ReplyPtr Redis::cmd(const std::vector<std::string> &argv) {
+    if (!CheckDeadline(m_name)) {
+        return nullptr;
+    }
     std::vector<const char *> v;
     std::vector<size_t> l;
     for (auto &i : argv) {
@@ -308,6 +329,9 @@ ReplyPtr RedisCluster::cmd(const char *fmt, ...) {
 }
 
 ReplyPtr RedisCluster::cmd(const char *fmt, va_list ap) {
+    if (!CheckDeadline(m_name)) {
+        return nullptr;
+    }
     auto r = (redisReply *)redisClustervCommand(m_context.get(), fmt, ap);
     if (!r) {
         if (m_logEnable) {
@@ -328,6 +352,9 @@ ReplyPtr RedisCluster::cmd(const char *fmt, va_list ap) {
 }
 
 ReplyPtr RedisCluster::cmd(const std::vector<std::string> &argv) {
+    if (!CheckDeadline(m_name)) {
+        return nullptr;
+    }
     std::vector<const char *> v;
     std::vector<size_t> l;
     for (auto &i : argv) {
@@ -595,6 +622,9 @@ ReplyPtr FoxRedis::cmd(const char *fmt, ...) {
 }
 
 ReplyPtr FoxRedis::cmd(const char *fmt, va_list ap) {
+    if (!CheckDeadline(m_name)) {
+        return nullptr;
+    }
     char *buf = nullptr;
     // int len = vasprintf(&buf, fmt, ap);
     int len = redisvFormatCommand(&buf, fmt, ap);
@@ -623,6 +653,9 @@ ReplyPtr FoxRedis::cmd(const char *fmt, va_list ap) {
 }
 
 ReplyPtr FoxRedis::cmd(const std::vector<std::string> &argv) {
+    if (!CheckDeadline(m_name)) {
+        return nullptr;
+    }
     // Ctx::ptr ctx(new Ctx(this));
     // ctx->parts = argv;
     FCtx fctx;
@@ -937,6 +970,9 @@ ReplyPtr FoxRedisCluster::cmd(const char *fmt, ...) {
 }
 
 ReplyPtr FoxRedisCluster::cmd(const char *fmt, va_list ap) {
+    if (!CheckDeadline(m_name)) {
+        return nullptr;
+    }
     char *buf = nullptr;
     // int len = vasprintf(&buf, fmt, ap);
     int len = redisvFormatCommand(&buf, fmt, ap);
@@ -964,6 +1000,9 @@ ReplyPtr FoxRedisCluster::cmd(const char *fmt, va_list ap) {
 }
 
 ReplyPtr FoxRedisCluster::cmd(const std::vector<std::string> &argv) {
+    if (!CheckDeadline(m_name)) {
+        return nullptr;
+    }
     // Ctx::ptr ctx(new Ctx(this));
     // ctx->parts = argv;
     FCtx fctx;
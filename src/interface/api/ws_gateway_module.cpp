@@ -3,10 +3,12 @@
 #include <atomic>
 #include <jwt-cpp/jwt.h>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "core/base/macro.hpp"
 #include "core/config/config.hpp"
+#include "core/io/future.hpp"
 #include "core/net/core/address.hpp"
 #include "core/net/http/ws_server.hpp"
 #include "core/net/http/ws_servlet.hpp"
@@ -75,6 +77,8 @@ struct ConnCtx {
     std::string conn_id;   // 连接唯一ID
 };
 
+static const size_t kPushFanout = 16;  // 批量推送的并发协程数
+
 static std::atomic<uint64_t> s_conn_seq{1};
 static IM::RWMutex s_ws_mutex;  // 保护会话表
 // 记录连接与上下文、会话弱引用，key: WSSession* 原始地址
@@ -87,6 +91,8 @@ static std::unordered_map<void *, ConnItem> s_ws_conns;
 // Forward declarations for helper functions used in routing helpers
 static void SendEvent(IM::http::WSSession::ptr session, const std::string &event, const Json::Value &payload,
                       const std::string &ackid);
+static IM::http::WSFrameBuffer::ptr BuildEventFrame(const std::string &event, const Json::Value &payload,
+                                                    const std::string &ackid);
 static std::vector<IM::http::WSSession::ptr> CollectSessions(uint64_t uid);
 
 namespace {
@@ -306,8 +312,8 @@ static std::string PresenceGetRoute(uint64_t uid) {
 static void PushToUserLocalOnly(uint64_t uid, const std::string &event, const Json::Value &payload,
                                 const std::string &ackid) {
     auto sessions = CollectSessions(uid);
-    for (auto &s : sessions) {
-        SendEvent(s, event, payload, ackid);
+    if (!sessions.empty()) {
+        IM::http::WSSession::Broadcast(sessions, BuildEventFrame(event, payload, ackid));
     }
 }
 
@@ -324,14 +330,25 @@ static void DeliverToGatewayRpc(const std::string &gateway_rpc, uint64_t uid, co
 }
 }  // namespace
 
-// 发送下行统一封装：{"event":"...","payload":{...},"ackid":"..."}
-static void SendEvent(IM::http::WSSession::ptr session, const std::string &event, const Json::Value &payload,
-                      const std::string &ackid = "") {
+// 下行消息统一格式：{"event":"...","payload":{...},"ackid":"..."}
+static std::string EncodeEvent(const std::string &event, const Json::Value &payload, const std::string &ackid) {
     Json::Value root;
     root["event"] = event;
     root["payload"] = payload.isNull() ? Json::Value(Json::objectValue) : payload;
     if (!ackid.empty()) root["ackid"] = ackid;
-    session->sendMessage(IM::JsonUtil::ToString(root));
+    return IM::JsonUtil::ToString(root);
+}
+
+// 发送下行消息，只进入会话的发送队列，不等待网络写出；客户端跟不上时按 websocket.send_queue 配置处理
+static void SendEvent(IM::http::WSSession::ptr session, const std::string &event, const Json::Value &payload,
+                      const std::string &ackid = "") {
+    session->sendMessage(EncodeEvent(event, payload, ackid));
+}
+
+// 序列化并成帧一次，供多个会话共享同一份帧数据
+static IM::http::WSFrameBuffer::ptr BuildEventFrame(const std::string &event, const Json::Value &payload,
+                                                    const std::string &ackid) {
+    return IM::http::WSFrameBuffer::Create(EncodeEvent(event, payload, ackid));
 }
 
 // 根据 uid 收集当前在线的会话（强引用），避免长时间持锁
@@ -353,6 +370,40 @@ static std::vector<IM::http::WSSession::ptr> CollectSessions(uint64_t uid) {
     return out;
 }
 
+// 一次扫描会话表，收集一批 uid 的在线会话；online 输出本机有连接的 uid
+static std::vector<IM::http::WSSession::ptr> CollectSessions(const std::unordered_set<uint64_t> &uids,
+                                                             std::unordered_set<uint64_t> *online) {
+    std::vector<IM::http::WSSession::ptr> out;
+    IM::RWMutex::ReadLock lock(s_ws_mutex);
+    for (auto &kv : s_ws_conns) {
+        const auto &item = kv.second;
+        if (!uids.count(item.ctx.uid)) {
+            continue;
+        }
+        if (auto sp = item.weak.lock()) {
+            out.push_back(std::move(sp));
+            online->insert(item.ctx.uid);
+        }
+    }
+    return out;
+}
+
+// 本机无连接的用户：查询 presence 路由，转发到目标网关
+static void PushToRemoteUser(uint64_t uid, const std::string &event, const Json::Value &payload) {
+    const auto gateway_rpc = PresenceGetRoute(uid);
+    if (gateway_rpc.empty()) {
+        return;
+    }
+
+    // 避免误投递到本机导致 RPC 回环
+    const auto local_rpc = GetLocalRockAddr();
+    if (!local_rpc.empty() && gateway_rpc == local_rpc) {
+        return;
+    }
+
+    DeliverToGatewayRpc(gateway_rpc, uid, event, payload);
+}
+
 bool WsGatewayModule::onServerReady() {
     std::vector<IM::TcpServer::ptr> wsServers;
     // 1. 获取所有已注册的WebSocket服务器实例
@@ -497,7 +548,9 @@ bool WsGatewayModule::onServerReady() {
 
             // 2) 内置事件处理
             if (event == "ping") {
-                // 应用层心跳，回复pong
+                // 应用层心跳，回复pong；整个处理过程(含 presence 续租 RPC)以高优先级调度，
+                // 避免负载高时心跳排在批量任务之后超时，导致误判下线
+                IM::PriorityGuard priority_guard(IM::Coroutine::HIGH);
                 Json::Value p;
                 p["ts"] = (Json::UInt64)IM::TimeUtil::NowToMS();
                 SendEvent(session, "pong", p);
@@ -624,30 +677,58 @@ bool WsGatewayModule::handleRockNotify(IM::RockNotify::ptr notify, IM::RockStrea
 // ===== 主动推送接口实现 =====
 void WsGatewayModule::PushToUser(uint64_t uid, const std::string &event, const Json::Value &payload,
                                  const std::string &ackid) {
-    // 1) 本机有连接则直接推送
-    {
-        auto sessions = CollectSessions(uid);
-        if (!sessions.empty()) {
-            for (auto &s : sessions) {
-                SendEvent(s, event, payload, ackid);
-            }
-            return;
-        }
+    // 1) 本机有连接则直接推送，多端登录的各个连接共享同一帧
+    auto sessions = CollectSessions(uid);
+    if (!sessions.empty()) {
+        IM::http::WSSession::Broadcast(sessions, BuildEventFrame(event, payload, ackid));
+        return;
     }
 
-    // 2) 本机无连接：查询 presence 路由到目标网关
-    const auto gateway_rpc = PresenceGetRoute(uid);
-    if (gateway_rpc.empty()) {
+    // 2) 本机无连接：经 presence 路由到目标网关
+    PushToRemoteUser(uid, event, payload);
+}
+
+void WsGatewayModule::PushToUsers(const std::vector<uint64_t> &uids, const std::string &event,
+                                  const Json::Value &payload) {
+    if (uids.empty()) {
         return;
     }
+    // 1) 本机在线的用户：只序列化、成帧一次，所有会话的发送队列引用同一帧
+    std::unordered_set<uint64_t> targets(uids.begin(), uids.end());
+    std::unordered_set<uint64_t> online;
+    auto sessions = CollectSessions(targets, &online);
+    if (!sessions.empty()) {
+        IM::http::WSSession::Broadcast(sessions, BuildEventFrame(event, payload, ""));
+    }
 
-    // 3) 避免误投递到本机导致 RPC 回环
-    const auto local_rpc = GetLocalRockAddr();
-    if (!local_rpc.empty() && gateway_rpc == local_rpc) {
+    // 2) 其余用户需要 presence 查询与跨网关 RPC，逐个推送时总延迟是各次往返之和。
+    // 按步长分给若干协程并发推送，等待全部完成，因此任务可以按引用使用参数
+    std::vector<uint64_t> remote;
+    for (auto uid : targets) {
+        if (!online.count(uid)) {
+            remote.push_back(uid);
+        }
+    }
+    size_t fanout = std::min(kPushFanout, remote.size());
+    if (fanout <= 1) {
+        for (auto uid : remote) {
+            PushToRemoteUser(uid, event, payload);
+        }
         return;
     }
-
-    DeliverToGatewayRpc(gateway_rpc, uid, event, payload);
+    std::vector<IM::Future<void>> futures;
+    futures.reserve(fanout);
+    for (size_t i = 0; i < fanout; ++i) {
+        futures.push_back(IM::Async([&remote, &event, &payload, i, fanout]() {
+            for (size_t k = i; k < remote.size(); k += fanout) {
+                PushToRemoteUser(remote[k], event, payload);
+            }
+        }));
+    }
+    IM::WhenAll(futures);
+    for (auto &f : futures) {
+        f.get();
+    }
 }
 
 void WsGatewayModule::PushImMessage(uint8_t talk_mode, uint64_t to_from_id, uint64_t from_id, const Json::Value &body) {
@@ -672,9 +753,7 @@ void WsGatewayModule::PushImMessage(uint8_t talk_mode, uint64_t to_from_id, uint
                     std::vector<uint64_t> talk_users;
                     std::string lerr;
                     if (talk_repo->listUsersByTalkId(talk_id, talk_users, &lerr)) {
-                        for (auto uid : talk_users) {
-                            PushToUser(uid, "im.message", payload);
-                        }
+                        PushToUsers(talk_users, "im.message", payload);
                         return;
                     }
                 }
@@ -38,6 +38,9 @@ class WsGatewayModule : public IM::RockModule {
     static void PushToUser(uint64_t uid, const std::string &event, const Json::Value &payload = Json::Value(),
                            const std::string &ackid = "");
 
+    // 推送通用事件到一批用户(如群成员)：本机连接共享一次编码的帧，其余用户并发跨网关投递，全部完成后返回
+    static void PushToUsers(const std::vector<uint64_t> &uids, const std::string &event, const Json::Value &payload);
+
     // 主动推送一条 IM 消息事件
     static void PushImMessage(uint8_t talk_mode, uint64_t to_from_id, uint64_t from_id, const Json::Value &body);
 
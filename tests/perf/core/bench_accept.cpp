@@ -0,0 +1,108 @@
+/**
+ * @file bench_accept.cpp
+ * @brief TcpServer 建连速率对比：单 accept 线程 vs SO_REUSEPORT 多监听
+ *
+ * 用法: bench_accept [IO 线程数，默认 4] [客户端线程数，默认 8] [每客户端线程连接数，默认 5000]
+ * 客户端线程以阻塞方式在回环地址上反复 connect/close，服务端 handleClient 只计数并关闭连接，
+ * 统计两种模式下每秒完成的 accept 次数。
+ */
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "core/io/iomanager.hpp"
+#include "core/net/core/fd_manager.hpp"
+#include "core/net/core/tcp_server.hpp"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief 只统计连接数的服务器
+ */
+class CountServer : public IM::TcpServer {
+   public:
+    CountServer(IM::IOManager *io, IM::IOManager *accept, std::atomic<uint64_t> &accepted)
+        : IM::TcpServer(io, io, accept), m_accepted(accepted) {}
+
+   protected:
+    void handleClient(IM::Socket::ptr client) override {
+        ++m_accepted;
+        client->close();
+    }
+
+   private:
+    std::atomic<uint64_t> &m_accepted;
+};
+
+void Bench(bool reuse_port, int io_threads, int clients, int conns) {
+    std::atomic<uint64_t> accepted = {0};
+    IM::IOManager accept_worker(1, false, "accept");
+    IM::IOManager io_worker(io_threads, false, "io");
+
+    auto server = std::make_shared<CountServer>(&io_worker, &accept_worker, accepted);
+    server->setReusePort(reuse_port);
+    std::vector<IM::Address::ptr> addrs = {IM::Address::LookupAny("127.0.0.1:0")};
+    std::vector<IM::Address::ptr> fails;
+    if (!server->bind(addrs, fails)) {
+        printf("bind fail\n");
+        exit(1);
+    }
+    // main 线程未开启 hook，手动注册到 FdManager，由 hook 接管为非阻塞
+    for (auto &sock : server->getSocks()) {
+        IM::FdMgr::GetInstance()->get(sock->getSocket(), true);
+    }
+    // 所有监听 socket 共享同一个端口
+    sockaddr_in addr = *(const sockaddr_in *)server->getSocks()[0]->getLocalAddress()->getAddr();
+    server->start();
+
+    auto begin = Clock::now();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < clients; ++i) {
+        threads.emplace_back([&addr, conns] {
+            for (int j = 0; j < conns; ++j) {
+                int fd = socket(AF_INET, SOCK_STREAM, 0);
+                if (connect(fd, (const sockaddr *)&addr, sizeof(addr)) != 0) {
+                    perror("connect");
+                } else {
+                    // 等服务端先关闭，TIME_WAIT 留在服务端，避免客户端临时端口耗尽
+                    char c;
+                    while (recv(fd, &c, 1, 0) > 0) {
+                    }
+                }
+                close(fd);
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    uint64_t total = (uint64_t)clients * conns;
+    while (accepted < total && Clock::now() - begin < std::chrono::seconds(30)) {
+        usleep(1000);
+    }
+    double sec = std::chrono::duration<double>(Clock::now() - begin).count();
+    printf("%-12s %2d io threads %2zu listeners %8lu accepts %10.0f accepts/s\n",
+           reuse_port ? "reuse_port" : "single", io_threads, server->getSocks().size(),
+           (unsigned long)accepted.load(), accepted / sec);
+    server->stop();
+}
+}  // namespace
+
+int main(int argc, char **argv) {
+    int io_threads = argc > 1 ? atoi(argv[1]) : 4;
+    int clients = argc > 2 ? atoi(argv[2]) : 8;
+    int conns = argc > 3 ? atoi(argv[3]) : 5000;
+
+    Bench(false, io_threads, clients, conns);
+    Bench(true, io_threads, clients, conns);
+    return 0;
+}
@@ -0,0 +1,192 @@
+/**
+ * @file bench_affinity.cpp
+ * @brief 线程池 CPU 亲和性/NUMA 绑定对往返延迟的影响
+ *
+ * 用法: bench_affinity [连接数，默认 64] [每连接往返次数，默认 5000] [每个池的线程数，默认 2]
+ * 回显端与请求端各是一个 IOManager，在回环 TCP 连接上往返 64 字节消息，统计每次往返延迟的分位数。
+ * 对比以下放置方式：
+ * - float:       不设置亲和性，线程由内核调度在任意 CPU 间迁移
+ * - pinned:      回显池与请求池各占一半 CPU，逐线程绑核(cpu_pin)
+ * - numa_local:  两个池都绑定到节点0(CPU 与内存)
+ * - numa_remote: 回显池在节点0、请求池在节点1，仅多 NUMA 节点的机器上运行
+ */
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "core/io/cpu_affinity.hpp"
+#include "core/io/iomanager.hpp"
+#include "core/net/core/fd_manager.hpp"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+const size_t kMessageSize = 64;
+
+/**
+ * @brief 建立一条回环 TCP 连接，返回两端的 fd
+ */
+bool Connect(int listen_fd, const sockaddr_in &addr, int fds[2]) {
+    int client = socket(AF_INET, SOCK_STREAM, 0);
+    if (connect(client, (const sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(client);
+        return false;
+    }
+    int server = accept(listen_fd, nullptr, nullptr);
+    int on = 1;
+    setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    setsockopt(server, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    // 注册到 FdManager，由 hook 接管为非阻塞
+    IM::FdMgr::GetInstance()->get(client, true);
+    IM::FdMgr::GetInstance()->get(server, true);
+    fds[0] = client;
+    fds[1] = server;
+    return true;
+}
+
+/**
+ * @brief 读满 len 字节
+ */
+bool RecvAll(int fd, char *buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = recv(fd, buf, len, 0);
+        if (n <= 0) {
+            return false;
+        }
+        buf += n;
+        len -= n;
+    }
+    return true;
+}
+
+/**
+ * @brief 取 [first, last) 范围内的 CPU 作为绑核集合
+ */
+IM::ThreadAffinity PinRange(int first, int last) {
+    std::vector<int> cpus;
+    for (int i = first; i < last; ++i) {
+        cpus.push_back(i);
+    }
+    IM::ThreadAffinity affinity;
+    affinity.cpus = cpus;
+    affinity.pin = true;
+    return affinity;
+}
+
+void Bench(const char *name, const IM::ThreadAffinity &server_affinity, const IM::ThreadAffinity &client_affinity,
+           int listen_fd, const sockaddr_in &addr, int conns, int rounds, int threads) {
+    std::vector<std::pair<int, int>> pairs;
+    for (int i = 0; i < conns; ++i) {
+        int fds[2];
+        if (!Connect(listen_fd, addr, fds)) {
+            perror("connect");
+            exit(1);
+        }
+        pairs.emplace_back(fds[0], fds[1]);
+    }
+
+    // 每个连接独占一段延迟记录，避免统计本身引入共享写
+    std::vector<std::vector<uint32_t>> latencies(conns);
+    std::atomic<int> done = {0};
+    auto begin = Clock::now();
+    {
+        IM::IOManager server(threads, false, "echo", server_affinity);
+        IM::IOManager client(threads, false, "req", client_affinity);
+        for (int i = 0; i < conns; ++i) {
+            int client_fd = pairs[i].first;
+            int server_fd = pairs[i].second;
+            server.schedule([server_fd, rounds] {
+                char buf[kMessageSize];
+                for (int k = 0; k < rounds; ++k) {
+                    if (!RecvAll(server_fd, buf, sizeof(buf)) || send(server_fd, buf, sizeof(buf), 0) <= 0) {
+                        break;
+                    }
+                }
+            });
+            std::vector<uint32_t> *out = &latencies[i];
+            client.schedule([client_fd, rounds, out, &done] {
+                char buf[kMessageSize] = {0};
+                out->reserve(rounds);
+                for (int k = 0; k < rounds; ++k) {
+                    auto start = Clock::now();
+                    if (send(client_fd, buf, sizeof(buf), 0) <= 0 || !RecvAll(client_fd, buf, sizeof(buf))) {
+                        break;
+                    }
+                    out->push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+                }
+                ++done;
+            });
+        }
+        while (done < conns) {
+            usleep(1000);
+        }
+    }
+    double sec = std::chrono::duration<double>(Clock::now() - begin).count();
+
+    std::vector<uint32_t> all;
+    for (auto &i : latencies) {
+        all.insert(all.end(), i.begin(), i.end());
+    }
+    std::sort(all.begin(), all.end());
+    if (!all.empty()) {
+        auto pct = [&all](double p) { return all[std::min(all.size() - 1, (size_t)(all.size() * p))] / 1000.0; };
+        printf("%-12s %8lu rtt %10.0f rtt/s  p50=%7.1fus p99=%7.1fus p999=%8.1fus\n", name, (unsigned long)all.size(),
+               all.size() / sec, pct(0.50), pct(0.99), pct(0.999));
+    }
+
+    for (auto &p : pairs) {
+        close(p.first);
+        close(p.second);
+    }
+}
+}  // namespace
+
+int main(int argc, char **argv) {
+    int conns = argc > 1 ? atoi(argv[1]) : 64;
+    int rounds = argc > 2 ? atoi(argv[2]) : 5000;
+    int threads = argc > 3 ? atoi(argv[3]) : 2;
+
+    int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    if (bind(listen_fd, (sockaddr *)&addr, sizeof(addr)) != 0 || listen(listen_fd, 1024) != 0 ||
+        getsockname(listen_fd, (sockaddr *)&addr, &len) != 0) {
+        perror("listen");
+        return 1;
+    }
+
+    int cpus = std::thread::hardware_concurrency();
+    int nodes = IM::ThreadAffinity::GetNumaNodeCount();
+    printf("cpus=%d numa_nodes=%d conns=%d rounds=%d threads/pool=%d\n", cpus, nodes, conns, rounds, threads);
+
+    // 预热：首轮会计入线程栈、FdCtx、任务缓存等的首次分配，不参与对比
+    Bench("warmup", IM::ThreadAffinity(), IM::ThreadAffinity(), listen_fd, addr, conns, rounds / 10 + 1, threads);
+    Bench("float", IM::ThreadAffinity(), IM::ThreadAffinity(), listen_fd, addr, conns, rounds, threads);
+    if (cpus >= 2) {
+        Bench("pinned", PinRange(0, cpus / 2), PinRange(cpus / 2, cpus), listen_fd, addr, conns, rounds, threads);
+    } else {
+        Bench("pinned", PinRange(0, 1), PinRange(0, 1), listen_fd, addr, conns, rounds, threads);
+    }
+    IM::ThreadAffinity node0 = IM::ThreadAffinity::Create("", 0, false);
+    Bench("numa_local", node0, node0, listen_fd, addr, conns, rounds, threads);
+    if (nodes >= 2) {
+        IM::ThreadAffinity node1 = IM::ThreadAffinity::Create("", 1, false);
+        Bench("numa_remote", node0, node1, listen_fd, addr, conns, rounds, threads);
+    } else {
+        printf("%-12s skipped (single NUMA node)\n", "numa_remote");
+    }
+    close(listen_fd);
+    return 0;
+}
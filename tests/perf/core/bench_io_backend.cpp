@@ -0,0 +1,142 @@
+/**
+ * @file bench_io_backend.cpp
+ * @brief IOManager IO 后端对比：epoll vs io_uring
+ *
+ * 用法: bench_io_backend [连接数，默认 64] [每连接往返次数，默认 20000] [线程数，默认 4]
+ * 在回环地址上建立若干 TCP 连接，每个连接一端回显、一端发起 64 字节请求并等待应答，
+ * 所有读写都走 hook 后的 send/recv，两种后端通过 iomanager.backend 配置项切换。
+ */
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+#include "core/config/config.hpp"
+#include "core/io/iomanager.hpp"
+#include "core/net/core/fd_manager.hpp"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+const size_t kMessageSize = 64;
+
+/**
+ * @brief 建立一条回环 TCP 连接，返回两端的 fd
+ */
+bool Connect(int listen_fd, const sockaddr_in &addr, int fds[2]) {
+    int client = socket(AF_INET, SOCK_STREAM, 0);
+    if (connect(client, (const sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(client);
+        return false;
+    }
+    int server = accept(listen_fd, nullptr, nullptr);
+    int on = 1;
+    setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    setsockopt(server, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    // 注册到 FdManager，由 hook 接管为非阻塞
+    IM::FdMgr::GetInstance()->get(client, true);
+    IM::FdMgr::GetInstance()->get(server, true);
+    fds[0] = client;
+    fds[1] = server;
+    return true;
+}
+
+/**
+ * @brief 读满 len 字节
+ */
+bool RecvAll(int fd, char *buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = recv(fd, buf, len, 0);
+        if (n <= 0) {
+            return false;
+        }
+        buf += n;
+        len -= n;
+    }
+    return true;
+}
+
+void Bench(const char *backend, int listen_fd, const sockaddr_in &addr, int conns, int rounds, int threads) {
+    IM::Config::Lookup<std::string>("iomanager.backend")->setValue(backend);
+    std::vector<std::pair<int, int>> pairs;
+    for (int i = 0; i < conns; ++i) {
+        int fds[2];
+        if (!Connect(listen_fd, addr, fds)) {
+            perror("connect");
+            exit(1);
+        }
+        pairs.emplace_back(fds[0], fds[1]);
+    }
+
+    std::atomic<uint64_t> done = {0};
+    auto begin = Clock::now();
+    {
+        IM::IOManager iom(threads, false, "bench");
+        if (strcmp(backend, "io_uring") == 0 && !iom.getIoUring()) {
+            printf("%-8s unavailable, skipped\n", backend);
+            rounds = 0;
+        }
+        for (auto &p : pairs) {
+            int client = p.first;
+            int server = p.second;
+            iom.schedule([server, rounds] {
+                char buf[kMessageSize];
+                for (int i = 0; i < rounds; ++i) {
+                    if (!RecvAll(server, buf, sizeof(buf)) || send(server, buf, sizeof(buf), 0) <= 0) {
+                        break;
+                    }
+                }
+            });
+            iom.schedule([client, rounds, &done] {
+                char buf[kMessageSize] = {0};
+                for (int i = 0; i < rounds; ++i) {
+                    if (send(client, buf, sizeof(buf), 0) <= 0 || !RecvAll(client, buf, sizeof(buf))) {
+                        break;
+                    }
+                    ++done;
+                }
+            });
+        }
+    }
+    double sec = std::chrono::duration<double>(Clock::now() - begin).count();
+    if (done > 0) {
+        printf("%-8s %4d conns %8lu round trips %10.0f rtt/s %8.2f us/rtt(per conn)\n", backend, conns,
+               (unsigned long)done.load(), done / sec, sec * 1e6 * conns / done);
+    }
+
+    for (auto &p : pairs) {
+        close(p.first);
+        close(p.second);
+    }
+}
+}  // namespace
+
+int main(int argc, char **argv) {
+    int conns = argc > 1 ? atoi(argv[1]) : 64;
+    int rounds = argc > 2 ? atoi(argv[2]) : 20000;
+    int threads = argc > 3 ? atoi(argv[3]) : 4;
+
+    int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    if (bind(listen_fd, (sockaddr *)&addr, sizeof(addr)) != 0 || listen(listen_fd, 1024) != 0 ||
+        getsockname(listen_fd, (sockaddr *)&addr, &len) != 0) {
+        perror("listen");
+        return 1;
+    }
+
+    Bench("epoll", listen_fd, addr, conns, rounds, threads);
+    Bench("io_uring", listen_fd, addr, conns, rounds, threads);
+    close(listen_fd);
+    return 0;
+}
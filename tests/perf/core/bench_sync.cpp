@@ -0,0 +1,236 @@
+/**
+ * @file bench_sync.cpp
+ * @brief 协程同步原语与 pthread 版本的对比
+ *
+ * 用法: bench_sync [每项操作数，默认 200000] [工作线程数，默认 2]
+ * 负载：
+ * - mutex:      64 个协程竞争同一把锁，临界区只做自增，每次解锁后让出，对比 Mutex 与 CoroutineMutex
+ * - mutex_hold: 同上但临界区内让出一次(模拟临界区内的 RPC/IO)。Mutex 持锁挂起后，
+ *               同线程的其他协程会阻塞在 pthread 锁上导致工作线程全部卡死，因此只测 CoroutineMutex，
+ *               同时统计另一个协程在此期间的执行次数，证明工作线程没有被阻塞
+ * - pingpong:   两个执行流通过容量为 0 的通道往返传递整数，
+ *               对比两个线程的 std::mutex + std::condition_variable 队列与两个协程的 Channel
+ * - pipe:       4 个生产者、4 个消费者通过容量 128 的队列传递整数，对比线程 + 条件变量队列与协程 + Channel
+ */
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "core/io/channel.hpp"
+#include "core/io/scheduler.hpp"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+const int kCoroutines = 64;  ///< mutex 负载的协程数
+const int kPipeWorkers = 4;  ///< pipe 负载的生产者/消费者数量
+
+void Report(const char *name, const char *impl, uint64_t ops, Clock::duration cost) {
+    double sec = std::chrono::duration<double>(cost).count();
+    printf("%-10s %-16s ops=%-8lu cost=%.3fs ops/s=%.2fM\n", name, impl, (unsigned long)ops, sec, ops / sec / 1e6);
+}
+
+void WaitDone(const std::atomic<int> &done, int total) {
+    while (done.load(std::memory_order_acquire) < total) {
+        usleep(100);
+    }
+}
+
+/**
+ * @brief 当前协程让出，并立即重新投递到调度器队尾
+ */
+void Yield() {
+    IM::Scheduler::GetThis()->schedule(IM::Coroutine::GetThis());
+    IM::Coroutine::YieldToHold();
+}
+
+template <class MutexType>
+void BenchMutex(IM::Scheduler &sc, const char *impl, uint64_t ops, bool hold) {
+    MutexType mutex;
+    uint64_t counter = 0;
+    std::atomic<int> done = {0};
+    std::atomic<uint64_t> ticks = {0};
+    std::atomic<bool> stop = {false};
+    if (hold) {
+        sc.schedule([&]() {
+            while (!stop.load(std::memory_order_relaxed)) {
+                ticks.fetch_add(1, std::memory_order_relaxed);
+                Yield();
+            }
+            done.fetch_add(1, std::memory_order_release);
+        });
+    }
+    uint64_t per = ops / kCoroutines;
+    auto start = Clock::now();
+    for (int i = 0; i < kCoroutines; ++i) {
+        sc.schedule([&]() {
+            for (uint64_t k = 0; k < per; ++k) {
+                {
+                    typename MutexType::Lock lock(mutex);
+                    ++counter;
+                    if (hold) {
+                        Yield();
+                    }
+                }
+                Yield();
+            }
+            done.fetch_add(1, std::memory_order_release);
+        });
+    }
+    WaitDone(done, kCoroutines);
+    auto cost = Clock::now() - start;
+    stop = true;
+    WaitDone(done, kCoroutines + (hold ? 1 : 0));
+    if (counter != per * kCoroutines) {
+        printf("counter mismatch %lu\n", (unsigned long)counter);
+        exit(1);
+    }
+    Report(hold ? "mutex_hold" : "mutex", impl, counter, cost);
+    if (hold) {
+        printf("%-10s %-16s other coroutine ran %lu times\n", "", "", (unsigned long)ticks.load());
+    }
+}
+
+/**
+ * @brief 基于 std::mutex + std::condition_variable 的有界队列，作为 pthread 版本的基准
+ */
+class ThreadQueue {
+   public:
+    explicit ThreadQueue(size_t capacity) : m_capacity(capacity ? capacity : 1) {}
+
+    void push(int v) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notFull.wait(lock, [this]() { return m_queue.size() < m_capacity; });
+        m_queue.push_back(v);
+        m_notEmpty.notify_one();
+    }
+
+    int pop() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notEmpty.wait(lock, [this]() { return !m_queue.empty(); });
+        int v = m_queue.front();
+        m_queue.pop_front();
+        m_notFull.notify_one();
+        return v;
+    }
+
+   private:
+    size_t m_capacity;
+    std::mutex m_mutex;
+    std::condition_variable m_notFull;
+    std::condition_variable m_notEmpty;
+    std::deque<int> m_queue;
+};
+
+void BenchPingPongThread(uint64_t ops) {
+    ThreadQueue ping(0), pong(0);
+    auto start = Clock::now();
+    std::thread peer([&]() {
+        for (uint64_t i = 0; i < ops; ++i) {
+            pong.push(ping.pop() + 1);
+        }
+    });
+    for (uint64_t i = 0; i < ops; ++i) {
+        ping.push(i);
+        pong.pop();
+    }
+    peer.join();
+    Report("pingpong", "thread+condvar", ops, Clock::now() - start);
+}
+
+void BenchPingPongChannel(IM::Scheduler &sc, uint64_t ops) {
+    IM::Channel<int> ping(0), pong(0);
+    std::atomic<int> done = {0};
+    auto start = Clock::now();
+    sc.schedule([&]() {
+        int v;
+        for (uint64_t i = 0; i < ops; ++i) {
+            ping.recv(v);
+            pong.send(v + 1);
+        }
+        done.fetch_add(1, std::memory_order_release);
+    });
+    sc.schedule([&]() {
+        int v;
+        for (uint64_t i = 0; i < ops; ++i) {
+            ping.send(i);
+            pong.recv(v);
+        }
+        done.fetch_add(1, std::memory_order_release);
+    });
+    WaitDone(done, 2);
+    Report("pingpong", "coroutine+chan", ops, Clock::now() - start);
+}
+
+void BenchPipeThread(uint64_t ops) {
+    ThreadQueue queue(128);
+    uint64_t per = ops / kPipeWorkers;
+    std::vector<std::thread> threads;
+    auto start = Clock::now();
+    for (int i = 0; i < kPipeWorkers; ++i) {
+        threads.emplace_back([&]() {
+            for (uint64_t k = 0; k < per; ++k) {
+                queue.push(k);
+            }
+        });
+        threads.emplace_back([&]() {
+            for (uint64_t k = 0; k < per; ++k) {
+                queue.pop();
+            }
+        });
+    }
+    for (auto &i : threads) {
+        i.join();
+    }
+    Report("pipe", "thread+condvar", per * kPipeWorkers, Clock::now() - start);
+}
+
+void BenchPipeChannel(IM::Scheduler &sc, uint64_t ops) {
+    IM::Channel<int> ch(128);
+    uint64_t per = ops / kPipeWorkers;
+    std::atomic<int> done = {0};
+    auto start = Clock::now();
+    for (int i = 0; i < kPipeWorkers; ++i) {
+        sc.schedule([&]() {
+            for (uint64_t k = 0; k < per; ++k) {
+                ch.send(k);
+            }
+            done.fetch_add(1, std::memory_order_release);
+        });
+        sc.schedule([&]() {
+            int v;
+            for (uint64_t k = 0; k < per; ++k) {
+                ch.recv(v);
+            }
+            done.fetch_add(1, std::memory_order_release);
+        });
+    }
+    WaitDone(done, kPipeWorkers * 2);
+    Report("pipe", "coroutine+chan", per * kPipeWorkers, Clock::now() - start);
+}
+}  // namespace
+
+int main(int argc, char **argv) {
+    uint64_t ops = argc > 1 ? strtoull(argv[1], nullptr, 10) : 200000;
+    int threads = argc > 2 ? atoi(argv[2]) : 2;
+
+    IM::Scheduler sc(threads, false, "bench");
+    sc.start();
+    BenchMutex<IM::Mutex>(sc, "pthread Mutex", ops, false);
+    BenchMutex<IM::CoroutineMutex>(sc, "CoroutineMutex", ops, false);
+    BenchMutex<IM::CoroutineMutex>(sc, "CoroutineMutex", ops / 4, true);
+    BenchPingPongThread(ops);
+    BenchPingPongChannel(sc, ops);
+    BenchPipeThread(ops);
+    BenchPipeChannel(sc, ops);
+    sc.stop();
+    return 0;
+}
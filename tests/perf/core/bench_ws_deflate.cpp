@@ -0,0 +1,118 @@
+/**
+ * @file bench_ws_deflate.cpp
+ * @brief WebSocket permessage-deflate：带宽节省与压缩/解压 CPU 开销
+ *
+ * 用法: bench_ws_deflate [每种配置的消息数，默认 20000]
+ * 生成网关下行事件形式的 JSON 消息(im.message 等，键名重复、内容各不相同)，按连接上的顺序逐条压缩再解压，
+ * 统计压缩后字节数占原始字节数的比例、每条消息的压缩与解压耗时，以及每个会话上下文的内存估算。
+ * 对比的配置：
+ * - takeover:    上下文接管，后续消息可以引用前面消息中的内容
+ * - no_takeover: 每条消息后重置上下文(server/client_no_context_takeover)
+ * - 压缩级别 1 与 6，窗口 15 与 10 位
+ * 解压结果逐条与原文比对。
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "core/net/http/ws_deflate.hpp"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+using IM::http::WSDeflate;
+
+const char *kWords[] = {"hello", "ok", "收到", "明天见", "好的", "today", "meeting", "文件", "图片", "群公告"};
+
+/**
+ * @brief 一条网关下行事件，正文长度约为 body_size
+ */
+std::string MakeEvent(size_t seq, size_t body_size) {
+    std::string content;
+    while (content.size() < body_size) {
+        content += kWords[rand() % (sizeof(kWords) / sizeof(kWords[0]))];
+        content += ' ';
+    }
+    char buf[256];
+    snprintf(buf, sizeof(buf),
+             "{\"event\":\"im.message\",\"payload\":{\"to_from_id\":%zu,\"from_id\":%zu,\"talk_mode\":2,"
+             "\"body\":{\"msg_id\":\"%016zx\",\"sequence\":%zu,\"msg_type\":1,"
+             "\"created_at\":\"2026-01-10 12:%02zu:%02zu\",\"content\":\"",
+             100000 + seq % 50, 200000 + seq % 500, seq * 2654435761u, seq, seq / 60 % 60, seq % 60);
+    return buf + content + "\"}}}";
+}
+
+/**
+ * @brief 服务端参数的镜像，作为客户端上下文解压服务端的输出
+ */
+WSDeflate::Params Mirror(const WSDeflate::Params &p) {
+    WSDeflate::Params rt = p;
+    rt.serverMaxWindowBits = p.clientMaxWindowBits;
+    rt.clientMaxWindowBits = p.serverMaxWindowBits;
+    rt.serverNoContextTakeover = p.clientNoContextTakeover;
+    rt.clientNoContextTakeover = p.serverNoContextTakeover;
+    return rt;
+}
+
+void Bench(const char *name, const std::vector<std::string> &msgs, bool takeover, int level, int window_bits) {
+    WSDeflate::Params params;
+    params.serverNoContextTakeover = !takeover;
+    params.clientNoContextTakeover = !takeover;
+    params.serverMaxWindowBits = window_bits;
+    params.clientMaxWindowBits = window_bits;
+    params.memLevel = std::min(8, window_bits - 7);
+    auto server = WSDeflate::Create(params, level);
+    auto client = WSDeflate::Create(Mirror(params), level);
+
+    size_t raw = 0;
+    size_t wire = 0;
+    double compress_sec = 0;
+    double decompress_sec = 0;
+    std::string compressed;
+    std::string plain;
+    for (auto &msg : msgs) {
+        auto t0 = Clock::now();
+        if (!server->compress(msg.data(), msg.size(), compressed)) {
+            printf("compress fail\n");
+            exit(1);
+        }
+        auto t1 = Clock::now();
+        if (client->decompress(compressed, 1 << 24, plain) || plain != msg) {
+            printf("decompress mismatch\n");
+            exit(1);
+        }
+        auto t2 = Clock::now();
+        compress_sec += std::chrono::duration<double>(t1 - t0).count();
+        decompress_sec += std::chrono::duration<double>(t2 - t1).count();
+        raw += msg.size();
+        wire += compressed.size();
+    }
+    printf("%-24s raw=%6zuB  wire=%5.1f%%  compress=%7.2fus  decompress=%6.2fus  mem=%4zuKB\n", name,
+           raw / msgs.size(), wire * 100.0 / raw, compress_sec * 1e6 / msgs.size(),
+           decompress_sec * 1e6 / msgs.size(), WSDeflate::EstimateMemory(params) / 1024);
+}
+}  // namespace
+
+int main(int argc, char **argv) {
+    int count = argc > 1 ? atoi(argv[1]) : 20000;
+    const size_t bodies[] = {32, 256, 2048, 16384};
+    for (size_t body : bodies) {
+        srand(1);
+        std::vector<std::string> msgs;
+        // 大消息按比例减少条数，使每项耗时相近
+        size_t n = body > 2048 ? count / 8 : count;
+        for (size_t i = 0; i < n; ++i) {
+            msgs.push_back(MakeEvent(i, body));
+        }
+        printf("--- body=%zu\n", body);
+        Bench("takeover   l1 w15", msgs, true, 1, 15);
+        Bench("takeover   l6 w15", msgs, true, 6, 15);
+        Bench("takeover   l1 w10", msgs, true, 1, 10);
+        Bench("no_takeover l1 w15", msgs, false, 1, 15);
+        Bench("no_takeover l6 w15", msgs, false, 6, 15);
+    }
+    return 0;
+}
@@ -0,0 +1,136 @@
+/**
+ * @file bench_ws_frame.cpp
+ * @brief WebSocket 帧发送：逐段 write 与单次 writev 的对比
+ *
+ * 用法: bench_ws_frame [每种载荷的帧数，默认 200000]
+ * 发送端在普通线程中向 socketpair 写帧，另一个线程持续读空对端，统计每秒帧数与每帧系统调用次数。
+ * - legacy: 旧实现，首字节、次字节、扩展长度、掩码、载荷分别 writeFixSize
+ * - writev: WSSendFrame，帧头在栈上编码，与载荷一次 writev 写出
+ * 每种方式分别测服务端(不掩码)与客户端(掩码)路径。
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <thread>
+#include <unistd.h>
+
+#include "core/base/endian.hpp"
+#include "core/net/http/ws_session.hpp"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief 直接读写 fd 的流，统计写系统调用次数
+ */
+class FdStream : public IM::Stream {
+   public:
+    explicit FdStream(int fd) : m_fd(fd) {}
+
+    int read(void *buffer, size_t length) override { return ::recv(m_fd, buffer, length, 0); }
+    int read(IM::ByteArray::ptr ba, size_t length) override { return -1; }
+    int write(const void *buffer, size_t length) override {
+        ++m_syscalls;
+        return ::send(m_fd, buffer, length, 0);
+    }
+    int write(IM::ByteArray::ptr ba, size_t length) override { return -1; }
+    int writev(const iovec *iov, size_t count) override {
+        ++m_syscalls;
+        return ::writev(m_fd, iov, count);
+    }
+    void close() override {}
+
+    uint64_t syscalls() const { return m_syscalls; }
+
+   private:
+    int m_fd;
+    uint64_t m_syscalls = 0;
+};
+
+/**
+ * @brief 旧的逐段写出实现，仅用于对比
+ */
+int32_t LegacySendFrame(IM::Stream *stream, int32_t opcode, const std::string &data, bool client) {
+    uint64_t size = data.size();
+    uint8_t b1 = 0x80 | (opcode & 0x0F);
+    uint8_t b2 = client ? 0x80 : 0;
+    uint8_t len_indicator = size < 126 ? (uint8_t)size : (size < 65536 ? 126 : 127);
+    b2 |= len_indicator;
+    if (stream->writeFixSize(&b1, 1) <= 0 || stream->writeFixSize(&b2, 1) <= 0) {
+        return -1;
+    }
+    if (len_indicator == 126) {
+        uint16_t len = IM::byteswap((uint16_t)size);
+        if (stream->writeFixSize(&len, sizeof(len)) <= 0) return -1;
+    } else if (len_indicator == 127) {
+        uint64_t len = IM::byteswap(size);
+        if (stream->writeFixSize(&len, sizeof(len)) <= 0) return -1;
+    }
+    if (client) {
+        char mask[4];
+        uint32_t rand_value = rand();
+        memcpy(mask, &rand_value, sizeof(mask));
+        if (stream->writeFixSize(mask, sizeof(mask)) <= 0) return -1;
+        std::string masked = data;
+        for (size_t i = 0; i < masked.size(); ++i) {
+            masked[i] ^= mask[i % 4];
+        }
+        return stream->writeFixSize(masked.data(), masked.size());
+    }
+    return stream->writeFixSize(data.data(), size);
+}
+
+void Bench(const char *name, size_t payload, int frames, bool client, bool legacy) {
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+        perror("socketpair");
+        exit(1);
+    }
+    std::thread reader([&] {
+        char buf[64 * 1024];
+        while (::recv(fds[1], buf, sizeof(buf), 0) > 0) {
+        }
+    });
+
+    FdStream stream(fds[0]);
+    std::string data(payload, 'x');
+    auto begin = Clock::now();
+    for (int i = 0; i < frames; ++i) {
+        int32_t rt = legacy ? LegacySendFrame(&stream, IM::http::WSFrameHead::TEXT_FRAME, data, client)
+                            : IM::http::WSSendFrame(&stream, IM::http::WSFrameHead::TEXT_FRAME, true, data.data(),
+                                                    data.size(), client);
+        if (rt <= 0) {
+            perror("send");
+            break;
+        }
+    }
+    double sec = std::chrono::duration<double>(Clock::now() - begin).count();
+    shutdown(fds[0], SHUT_WR);
+    reader.join();
+    close(fds[0]);
+    close(fds[1]);
+
+    printf("%-8s %-6s payload=%-6zu %10.0f frames/s  %7.1f ns/frame  %.2f syscalls/frame\n", name,
+           client ? "client" : "server", payload, frames / sec, sec * 1e9 / frames,
+           (double)stream.syscalls() / frames);
+}
+}  // namespace
+
+int main(int argc, char **argv) {
+    int frames = argc > 1 ? atoi(argv[1]) : 200000;
+    const size_t payloads[] = {32, 512, 4096, 70000};
+    for (size_t payload : payloads) {
+        // 大载荷按比例减少帧数，使每项耗时相近
+        int n = payload > 4096 ? frames / 20 : frames;
+        for (bool client : {false, true}) {
+            Bench("legacy", payload, n, client, true);
+            Bench("writev", payload, n, client, false);
+        }
+    }
+    return 0;
+}
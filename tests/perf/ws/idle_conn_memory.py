@@ -0,0 +1,159 @@
+#!/usr/bin/env python3
+
+import argparse
+import base64
+import datetime as _dt
+import json
+import os
+import re
+import resource
+import shutil
+import socket
+import subprocess
+import sys
+import time
+from pathlib import Path
+
+
+def _wait_port(host: str, port: int, timeout_s: float) -> bool:
+    deadline = time.time() + timeout_s
+    while time.time() < deadline:
+        try:
+            with socket.create_connection((host, port), timeout=0.2):
+                return True
+        except OSError:
+            time.sleep(0.1)
+    return False
+
+
+def _read_rss_kb(pid: int) -> int:
+    for line in Path(f"/proc/{pid}/status").read_text().splitlines():
+        if line.startswith("VmRSS:"):
+            return int(line.split()[1])
+    return 0
+
+
+def _raise_nofile(n: int) -> None:
+    soft, hard = resource.getrlimit(resource.RLIMIT_NOFILE)
+    want = min(hard, max(soft, n + 256))
+    if want > soft:
+        resource.setrlimit(resource.RLIMIT_NOFILE, (want, hard))
+
+
+def _patch_shared_stack(server_yaml: Path, enable: int) -> None:
+    # 只修改 type: ws 的服务器条目，插入/替换 shared_stack 字段
+    out: list[str] = []
+    for line in server_yaml.read_text(encoding="utf-8").splitlines():
+        if re.match(r"^\s*shared_stack\s*:", line):
+            continue
+        out.append(line)
+        m = re.match(r"^(\s*)type:\s*ws\s*$", line)
+        if m:
+            out.append(f"{m.group(1)}shared_stack: {int(enable)}")
+    if not any("shared_stack" in x for x in out):
+        raise RuntimeError(f"no ws server found in {server_yaml}")
+    server_yaml.write_text("\n".join(out) + "\n", encoding="utf-8")
+
+
+def _open_idle(host: str, port: int, count: int, token: str, platform: str) -> list[socket.socket]:
+    socks: list[socket.socket] = []
+    for _ in range(count):
+        s = socket.create_connection((host, port), timeout=5)
+        if token:
+            # 完成握手后保持静默，协程停在 recvMessage 中
+            key = base64.b64encode(os.urandom(16)).decode()
+            req = (
+                f"GET /wss/default.io?token={token}&platform={platform} HTTP/1.1\r\n"
+                f"Host: {host}:{port}\r\n"
+                "Upgrade: websocket\r\n"
+                "Connection: Upgrade\r\n"
+                f"Sec-WebSocket-Key: {key}\r\n"
+                "Sec-WebSocket-Version: 13\r\n"
+                "\r\n"
+            )
+            s.sendall(req.encode())
+            head = s.recv(4096)
+            if b" 101 " not in head.split(b"\r\n", 1)[0]:
+                s.close()
+                raise RuntimeError(f"handshake failed: {head[:120]!r}")
+        # 未提供 token 时只建立 TCP 连接，协程停在 handleShake 的读等待中
+        socks.append(s)
+    return socks
+
+
+def _run_one(args: argparse.Namespace, repo_root: Path, conf_dir: Path, label: str, out_dir: Path) -> dict:
+    server_log = out_dir / f"{label}.server.log"
+    with server_log.open("w") as logf:
+        proc = subprocess.Popen([args.binary, "-c", str(conf_dir), "-s"], cwd=str(repo_root), stdout=logf,
+                                stderr=subprocess.STDOUT, text=True)
+    socks: list[socket.socket] = []
+    try:
+        if not _wait_port(args.host, args.port, args.startup_timeout):
+            raise RuntimeError(f"server not listening on {args.host}:{args.port}, see {server_log}")
+        time.sleep(args.settle)
+        rss_before = _read_rss_kb(proc.pid)
+        socks = _open_idle(args.host, args.port, args.connections, args.token, args.platform)
+        time.sleep(args.settle)
+        rss_after = _read_rss_kb(proc.pid)
+        delta_kb = max(0, rss_after - rss_before)
+        return {
+            "label": label,
+            "connections": len(socks),
+            "rss_before_kb": rss_before,
+            "rss_after_kb": rss_after,
+            "bytes_per_conn": delta_kb * 1024.0 / max(1, len(socks)),
+        }
+    finally:
+        for s in socks:
+            s.close()
+        proc.terminate()
+        try:
+            proc.wait(timeout=10)
+        except subprocess.TimeoutExpired:
+            proc.kill()
+
+
+def main() -> int:
+    ap = argparse.ArgumentParser(description="bytes-per-idle-connection of gateway_ws: private stack vs shared stack")
+    ap.add_argument("--binary", default="./bin/gateway_ws")
+    ap.add_argument("--src-conf", default="bin/config/gateway_ws")
+    ap.add_argument("--host", default="127.0.0.1")
+    ap.add_argument("--port", type=int, default=8081)
+    ap.add_argument("--connections", type=int, default=5000)
+    ap.add_argument("--token", default=os.environ.get("IM_TOKEN", ""),
+                    help="complete the WS handshake with this token; without it connections stay pre-handshake")
+    ap.add_argument("--platform", default="web")
+    ap.add_argument("--settle", type=float, default=2.0, help="seconds to wait before sampling RSS")
+    ap.add_argument("--startup-timeout", type=float, default=15.0)
+    ap.add_argument("--results-dir", default="tests/perf/results")
+    args = ap.parse_args()
+
+    repo_root = Path(__file__).resolve().parents[3]
+    src_conf = (repo_root / args.src_conf).resolve()
+    ts = _dt.datetime.now().strftime("%Y%m%d-%H%M%S")
+    out_dir = (repo_root / args.results_dir / "ws_idle_conn" / ts).resolve()
+    out_dir.mkdir(parents=True, exist_ok=True)
+    _raise_nofile(args.connections)
+
+    results = []
+    for label, enable in (("private_stack", 0), ("shared_stack", 1)):
+        conf_dir = out_dir / f"conf_{label}"
+        shutil.copytree(src_conf, conf_dir)
+        _patch_shared_stack(conf_dir / "server.yaml", enable)
+        results.append(_run_one(args, repo_root, conf_dir, label, out_dir))
+
+    print("=" * 72)
+    print(f" IDLE CONNECTION MEMORY: {args.connections} conns, handshake={'yes' if args.token else 'no'}")
+    print("-" * 72)
+    print(f"{'Mode':<16} {'RSS before(KB)':>15} {'RSS after(KB)':>15} {'Bytes/conn':>15}")
+    for r in results:
+        print(f"{r['label']:<16} {r['rss_before_kb']:>15} {r['rss_after_kb']:>15} {r['bytes_per_conn']:>15.0f}")
+    print("=" * 72)
+
+    (out_dir / "idle_conn.json").write_text(json.dumps(results, indent=2), encoding="utf-8")
+    print(f"[OK] results written to: {out_dir}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
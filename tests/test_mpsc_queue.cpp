@@ -0,0 +1,203 @@
+#include "core/ds/mpsc_queue.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+#define CHECK(cond)                                                                                 \
+    do {                                                                                             \
+        if (!(cond)) {                                                                               \
+            std::cerr << "[FAIL] " << __FILE__ << ":" << __LINE__ << " CHECK(" #cond ")\n"; \
+            std::abort();                                                                            \
+        }                                                                                            \
+    } while (0)
+
+struct Item {
+    std::atomic<Item *> next = {nullptr};
+    int value = 0;
+};
+
+using ItemQueue = IM::ds::IntrusiveMpscQueue<Item, &Item::next>;
+
+static void test_value_empty_transitions()
+{
+    IM::ds::MpscQueue<int> q;
+    int v = -1;
+
+    CHECK(q.empty());
+    CHECK(!q.pop(v));
+
+    // 只有由空变为非空的那次 push 返回 true
+    CHECK(q.push(1));
+    CHECK(!q.push(2));
+    CHECK(!q.push(3));
+    CHECK(q.size() == 3);
+
+    CHECK(q.pop(v) && v == 1);
+    CHECK(q.pop(v) && v == 2);
+    CHECK(!q.push(4));
+    CHECK(q.pop(v) && v == 3);
+    CHECK(q.pop(v) && v == 4);
+    CHECK(q.empty());
+    CHECK(!q.pop(v));
+
+    // 读空后再次 push 重新报告由空变为非空
+    CHECK(q.push(5));
+    CHECK(q.pop(v) && v == 5);
+    CHECK(q.push(6));
+    CHECK(q.pop(v) && v == 6);
+    CHECK(!q.pop(v));
+}
+
+static void test_value_move_only()
+{
+    IM::ds::MpscQueue<std::unique_ptr<int>> q;
+    CHECK(q.push(std::make_unique<int>(7)));
+    CHECK(!q.push(std::make_unique<int>(8)));
+
+    std::unique_ptr<int> v;
+    CHECK(q.pop(v) && v && *v == 7);
+    CHECK(q.pop(v) && v && *v == 8);
+    // 析构时释放未取出的元素
+    q.push(std::make_unique<int>(9));
+}
+
+static void test_intrusive_empty_transitions()
+{
+    ItemQueue q;
+    Item a, b, c;
+    a.value = 1;
+    b.value = 2;
+    c.value = 3;
+
+    CHECK(q.empty());
+    CHECK(q.pop() == nullptr);
+
+    // 单个元素：出队时需要重新挂上哨兵
+    CHECK(q.push(&a));
+    CHECK(q.pop() == &a);
+    CHECK(q.pop() == nullptr);
+    CHECK(q.empty());
+
+    // 同一元素出队后可再次入队
+    CHECK(q.push(&a));
+    CHECK(!q.push(&b));
+    CHECK(q.pop() == &a);
+    CHECK(!q.push(&c));
+    CHECK(q.pop() == &b);
+    CHECK(q.pop() == &c);
+    CHECK(q.pop() == nullptr);
+
+    for (int i = 0; i < 100; ++i) {
+        CHECK(q.push(&b));
+        CHECK(q.pop() == &b);
+        CHECK(q.empty());
+    }
+}
+
+// 多个生产者并发 push：元素不丢不重，同一生产者的元素保持入队顺序
+static void test_intrusive_concurrent()
+{
+    const int kProducers = 4;
+    const int kPerProducer = 20000;
+
+    ItemQueue q;
+    std::vector<std::unique_ptr<Item[]>> items;
+    for (int p = 0; p < kProducers; ++p) {
+        items.emplace_back(new Item[kPerProducer]);
+        for (int i = 0; i < kPerProducer; ++i) {
+            items[p][i].value = p * kPerProducer + i;
+        }
+    }
+
+    std::atomic<int> wakeups = {0};
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&, p]() {
+            for (int i = 0; i < kPerProducer; ++i) {
+                if (q.push(&items[p][i])) {
+                    wakeups.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+
+    std::vector<int> last(kProducers, -1);
+    int popped = 0;
+    while (popped < kProducers * kPerProducer) {
+        Item *item = q.pop();
+        if (!item) {
+            std::this_thread::yield();
+            continue;
+        }
+        int p = item->value / kPerProducer;
+        int i = item->value % kPerProducer;
+        CHECK(i == last[p] + 1);
+        last[p] = i;
+        ++popped;
+    }
+    for (auto &t : producers) {
+        t.join();
+    }
+
+    CHECK(q.pop() == nullptr);
+    CHECK(q.empty());
+    CHECK(wakeups.load() >= 1);
+}
+
+static void test_value_concurrent()
+{
+    const int kProducers = 4;
+    const int kPerProducer = 20000;
+
+    IM::ds::MpscQueue<int> q;
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&, p]() {
+            for (int i = 0; i < kPerProducer; ++i) {
+                q.push(p * kPerProducer + i);
+            }
+        });
+    }
+
+    std::vector<int> last(kProducers, -1);
+    int popped = 0;
+    int v = 0;
+    while (popped < kProducers * kPerProducer) {
+        if (!q.pop(v)) {
+            std::this_thread::yield();
+            continue;
+        }
+        int p = v / kPerProducer;
+        int i = v % kPerProducer;
+        CHECK(i == last[p] + 1);
+        last[p] = i;
+        ++popped;
+    }
+    for (auto &t : producers) {
+        t.join();
+    }
+
+    CHECK(!q.pop(v));
+    CHECK(q.empty());
+    CHECK(q.push(1));
+}
+
+} // namespace
+
+int main()
+{
+    test_value_empty_transitions();
+    test_value_move_only();
+    test_value_concurrent();
+    test_intrusive_empty_transitions();
+    test_intrusive_concurrent();
+
+    std::cout << "[OK] test_mpsc_queue\n";
+    return 0;
+}
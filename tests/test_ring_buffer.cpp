@@ -0,0 +1,196 @@
+#include "core/ds/ring_buffer.hpp"
+
+#include <sys/uio.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+namespace {
+
+#define CHECK(cond)                                                                                 \
+    do {                                                                                             \
+        if (!(cond)) {                                                                               \
+            std::cerr << "[FAIL] " << __FILE__ << ":" << __LINE__ << " CHECK(" #cond ")\n"; \
+            std::abort();                                                                            \
+        }                                                                                            \
+    } while (0)
+
+// 模拟 readv：把 data 依次写入 getWriteBuffers 返回的内存段
+static size_t write_all(IM::ds::RingBuffer &rb, const std::string &data)
+{
+    iovec iov[2];
+    size_t cnt = rb.getWriteBuffers(iov);
+    size_t off = 0;
+    for (size_t i = 0; i < cnt && off < data.size(); ++i) {
+        size_t n = std::min(iov[i].iov_len, data.size() - off);
+        memcpy(iov[i].iov_base, data.data() + off, n);
+        off += n;
+    }
+    rb.commitWrite(off);
+    return off;
+}
+
+static std::string peek_all(const IM::ds::RingBuffer &rb, size_t len)
+{
+    std::string out(len, '\0');
+    out.resize(rb.peek(&out[0], len));
+    return out;
+}
+
+static void test_empty()
+{
+    IM::ds::RingBuffer rb(8);
+    iovec iov[2];
+
+    CHECK(rb.empty());
+    CHECK(rb.capacity() == 8);
+    CHECK(rb.available() == 8);
+    CHECK(rb.getReadBuffers(iov, 8) == 0);
+
+    // 空缓冲区的空闲空间是一整段
+    CHECK(rb.getWriteBuffers(iov) == 1);
+    CHECK(iov[0].iov_len == 8);
+
+    char buf[4];
+    CHECK(rb.peek(buf, sizeof(buf)) == 0);
+    CHECK(rb.read(buf, sizeof(buf)) == 0);
+    rb.consume(4);
+    CHECK(rb.empty());
+
+    IM::ds::RingBuffer none;
+    CHECK(none.capacity() == 0);
+    CHECK(none.getWriteBuffers(iov) == 0);
+}
+
+static void test_full()
+{
+    IM::ds::RingBuffer rb(8);
+    iovec iov[2];
+
+    CHECK(write_all(rb, "abcdefghij") == 8);
+    CHECK(rb.size() == 8);
+    CHECK(rb.available() == 0);
+    CHECK(rb.getWriteBuffers(iov) == 0);
+    // 超出空闲空间的提交被截断
+    rb.commitWrite(4);
+    CHECK(rb.size() == 8);
+    CHECK(peek_all(rb, 16) == "abcdefgh");
+}
+
+// 写位置与读位置都绕回：写入与读取各拆成两段
+static void test_wraparound()
+{
+    IM::ds::RingBuffer rb(8);
+    iovec iov[2];
+
+    CHECK(write_all(rb, "abcdef") == 6);
+    rb.consume(4);
+    CHECK(rb.size() == 2);
+    CHECK(peek_all(rb, 8) == "ef");
+
+    // 空闲空间：尾部2字节 + 头部4字节
+    CHECK(rb.getWriteBuffers(iov) == 2);
+    CHECK(iov[0].iov_len == 2);
+    CHECK(iov[1].iov_len == 4);
+    CHECK(write_all(rb, "ghijkl") == 6);
+    CHECK(rb.available() == 0);
+
+    // 可读数据同样跨越末尾
+    CHECK(rb.getReadBuffers(iov, 8) == 2);
+    CHECK(iov[0].iov_len == 4);
+    CHECK(iov[1].iov_len == 4);
+    CHECK(std::string((char *)iov[0].iov_base, iov[0].iov_len) == "efgh");
+    CHECK(std::string((char *)iov[1].iov_base, iov[1].iov_len) == "ijkl");
+
+    // len 限制在第一段内时只返回一段
+    CHECK(rb.getReadBuffers(iov, 3) == 1);
+    CHECK(iov[0].iov_len == 3);
+
+    // peek 不移动读位置
+    CHECK(peek_all(rb, 6) == "efghij");
+    CHECK(peek_all(rb, 6) == "efghij");
+    CHECK(rb.size() == 8);
+
+    // 部分 consume 后读位置越过末尾
+    rb.consume(5);
+    CHECK(rb.size() == 3);
+    CHECK(peek_all(rb, 8) == "jkl");
+
+    char buf[8];
+    CHECK(rb.read(buf, 2) == 2);
+    CHECK(std::string(buf, 2) == "jk");
+    CHECK(rb.read(buf, 8) == 1);
+    CHECK(buf[0] == 'l');
+    CHECK(rb.empty());
+
+    // 读空后回到起点，空闲空间重新是一整段
+    CHECK(rb.getWriteBuffers(iov) == 1);
+    CHECK(iov[0].iov_len == 8);
+}
+
+// 逐字节错位的写入/读取，覆盖读写位置的所有组合
+static void test_stream()
+{
+    const size_t kCap = 7;
+    IM::ds::RingBuffer rb(kCap);
+    std::string expected;
+    std::string got;
+    char next = 0;
+
+    for (int round = 0; round < 200; ++round) {
+        size_t wlen = round % (kCap + 1);
+        std::string chunk;
+        for (size_t i = 0; i < wlen; ++i) {
+            chunk.push_back(next++);
+        }
+        size_t written = write_all(rb, chunk);
+        CHECK(written == std::min(wlen, kCap - (expected.size() - got.size())));
+        expected.append(chunk, 0, written);
+        // 未写入的部分下一轮重新生成，保持序列连续
+        next -= (char)(wlen - written);
+
+        size_t rlen = (round * 3) % (kCap + 1);
+        std::string head = peek_all(rb, rlen);
+        CHECK(head == expected.substr(got.size(), head.size()));
+        rb.consume(rlen);
+        got += head;
+        CHECK(rb.size() == expected.size() - got.size());
+    }
+
+    got += peek_all(rb, kCap);
+    rb.consume(kCap);
+    CHECK(got == expected);
+    CHECK(rb.empty());
+}
+
+static void test_reset()
+{
+    IM::ds::RingBuffer rb(4);
+    write_all(rb, "abc");
+    rb.consume(2);
+
+    rb.reset(16);
+    CHECK(rb.capacity() == 16);
+    CHECK(rb.empty());
+    CHECK(write_all(rb, "0123456789") == 10);
+    rb.clear();
+    CHECK(rb.empty());
+    CHECK(rb.available() == 16);
+}
+
+} // namespace
+
+int main()
+{
+    test_empty();
+    test_full();
+    test_wraparound();
+    test_stream();
+    test_reset();
+
+    std::cout << "[OK] test_ring_buffer\n";
+    return 0;
+}
@@ -0,0 +1,221 @@
+#include "core/io/task_func.hpp"
+
+#include <array>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace {
+
+#define CHECK(cond)                                                                                 \
+    do {                                                                                             \
+        if (!(cond)) {                                                                               \
+            std::cerr << "[FAIL] " << __FILE__ << ":" << __LINE__ << " CHECK(" #cond ")\n"; \
+            std::abort();                                                                            \
+        }                                                                                            \
+    } while (0)
+
+static int g_calls = 0;
+
+static void free_func()
+{
+    ++g_calls;
+}
+
+// 统计存活实例数，检查移动与销毁不泄漏、不重复析构
+struct Counted {
+    static int alive;
+
+    explicit Counted(int *calls) : calls(calls) { ++alive; }
+    Counted(Counted &&o) noexcept : calls(o.calls) { ++alive; }
+    Counted(const Counted &o) : calls(o.calls) { ++alive; }
+    ~Counted() { --alive; }
+
+    void operator()() { ++*calls; }
+
+    int *calls;
+};
+int Counted::alive = 0;
+
+// 超过内联容量的可调用对象
+struct Big {
+    explicit Big(int *calls) : calls(calls) { ++Counted::alive; }
+    Big(Big &&o) noexcept : calls(o.calls), pad(o.pad) { ++Counted::alive; }
+    ~Big() { --Counted::alive; }
+
+    void operator()() { ++*calls; }
+
+    int *calls;
+    std::array<char, 64> pad{};
+};
+
+// 移动可能抛异常，只能放在堆上
+struct ThrowingMove {
+    explicit ThrowingMove(int *calls) : calls(calls) {}
+    ThrowingMove(ThrowingMove &&o) : calls(o.calls) {}
+
+    void operator()() { ++*calls; }
+
+    int *calls;
+};
+
+static_assert(IM::TaskFunc::IsInline<Counted>(), "small functor should be inline");
+static_assert(IM::TaskFunc::IsInline<std::function<void()>>(), "std::function should be inline");
+static_assert(!IM::TaskFunc::IsInline<Big>(), "big functor should be on heap");
+static_assert(!IM::TaskFunc::IsInline<ThrowingMove>(), "throwing move should be on heap");
+static_assert(!std::is_copy_constructible<IM::TaskFunc>::value, "TaskFunc is move-only");
+
+static void test_empty()
+{
+    IM::TaskFunc a;
+    CHECK(!a);
+    IM::TaskFunc b(nullptr);
+    CHECK(!b);
+
+    // 空的 std::function 与空函数指针构造出空回调
+    IM::TaskFunc c(std::function<void()>{});
+    CHECK(!c);
+    void (*fp)() = nullptr;
+    IM::TaskFunc d(fp);
+    CHECK(!d);
+
+    IM::TaskFunc e(std::move(a));
+    CHECK(!e);
+    e.reset();
+    CHECK(!e);
+}
+
+static void test_invoke()
+{
+    g_calls = 0;
+    IM::TaskFunc f(&free_func);
+    CHECK(f);
+    f();
+    f();
+    CHECK(g_calls == 2);
+
+    int calls = 0;
+    IM::TaskFunc lambda([&calls]() { ++calls; });
+    lambda();
+    CHECK(calls == 1);
+
+    std::function<void()> sf = [&calls]() { calls += 10; };
+    IM::TaskFunc from_std(sf);
+    from_std();
+    CHECK(calls == 11);
+    // 原 std::function 仍然可用
+    sf();
+    CHECK(calls == 21);
+}
+
+static void test_inline_lifetime()
+{
+    int calls = 0;
+    {
+        IM::TaskFunc a{Counted(&calls)};
+        CHECK(Counted::alive == 1);
+
+        IM::TaskFunc b(std::move(a));
+        CHECK(!a);
+        CHECK(b);
+        CHECK(Counted::alive == 1);
+        b();
+        CHECK(calls == 1);
+
+        IM::TaskFunc c;
+        c = std::move(b);
+        CHECK(!b);
+        CHECK(Counted::alive == 1);
+        c();
+        CHECK(calls == 2);
+
+        // 赋值时释放原有对象
+        c = IM::TaskFunc(Counted(&calls));
+        CHECK(Counted::alive == 1);
+        c = nullptr;
+        CHECK(!c);
+        CHECK(Counted::alive == 0);
+
+        IM::TaskFunc d{Counted(&calls)};
+        CHECK(Counted::alive == 1);
+    }
+    CHECK(Counted::alive == 0);
+}
+
+static void test_heap_lifetime()
+{
+    int calls = 0;
+    {
+        IM::TaskFunc a{Big(&calls)};
+        CHECK(Counted::alive == 1);
+
+        // 堆上对象移动时只转移指针
+        IM::TaskFunc b(std::move(a));
+        CHECK(!a);
+        CHECK(Counted::alive == 1);
+        b();
+        CHECK(calls == 1);
+
+        IM::TaskFunc c{ThrowingMove(&calls)};
+        IM::TaskFunc d(std::move(c));
+        d();
+        CHECK(calls == 2);
+
+        b = std::move(d);
+        CHECK(Counted::alive == 0);
+        b();
+        CHECK(calls == 3);
+    }
+    CHECK(Counted::alive == 0);
+}
+
+static void test_move_only_capture()
+{
+    auto p = std::make_unique<int>(5);
+    int seen = 0;
+
+    IM::TaskFunc a([p = std::move(p), &seen]() { seen = *p; });
+    IM::TaskFunc b(std::move(a));
+    b();
+    CHECK(seen == 5);
+
+    // 移动转移所有权，不增加引用计数
+    auto sp = std::make_shared<int>(1);
+    IM::TaskFunc c([sp]() {});
+    CHECK(sp.use_count() == 2);
+    IM::TaskFunc d(std::move(c));
+    CHECK(sp.use_count() == 2);
+    d.reset();
+    CHECK(sp.use_count() == 1);
+}
+
+static void test_self_move_assign()
+{
+    int calls = 0;
+    IM::TaskFunc a{Counted(&calls)};
+    IM::TaskFunc &ref = a;
+    a = std::move(ref);
+    CHECK(a);
+    a();
+    CHECK(calls == 1);
+    a.reset();
+    CHECK(Counted::alive == 0);
+}
+
+} // namespace
+
+int main()
+{
+    test_empty();
+    test_invoke();
+    test_inline_lifetime();
+    test_heap_lifetime();
+    test_move_only_capture();
+    test_self_move_assign();
+
+    std::cout << "[OK] test_task_func\n";
+    return 0;
+}
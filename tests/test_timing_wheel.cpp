@@ -0,0 +1,223 @@
+#include "core/config/config.hpp"
+#include "core/io/timer.hpp"
+
+#include <sys/time.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// TimerManager 通过 gettimeofday 取时间，测试里替换它以便精确推进与回拨时钟
+static uint64_t g_fake_now_ms = 0;
+
+extern "C" int gettimeofday(struct timeval *tv, void *)
+{
+    tv->tv_sec = g_fake_now_ms / 1000;
+    tv->tv_usec = (g_fake_now_ms % 1000) * 1000;
+    return 0;
+}
+
+namespace {
+
+#define CHECK(cond)                                                                                 \
+    do {                                                                                             \
+        if (!(cond)) {                                                                               \
+            std::cerr << "[FAIL] " << __FILE__ << ":" << __LINE__ << " CHECK(" #cond ")\n"; \
+            std::abort();                                                                            \
+        }                                                                                            \
+    } while (0)
+
+class TestTimerManager : public IM::TimerManager {
+   public:
+    // 推进到 now_ms 并同步执行到期回调
+    void runUntil(uint64_t now_ms)
+    {
+        g_fake_now_ms = now_ms;
+        std::vector<std::function<void()>> cbs;
+        listExpiredCb(cbs);
+        for (auto &cb : cbs) {
+            cb();
+        }
+    }
+
+   protected:
+    void onTimerInsertedAtFront() override {}
+};
+
+static void set_backend(const std::string &backend)
+{
+    IM::Config::Lookup<std::string>("timer.backend")->setValue(backend);
+}
+
+// 步进推进，按毫秒记录每个定时器的触发时间
+static void test_expiry_order()
+{
+    g_fake_now_ms = 1000000;
+    TestTimerManager mgr;
+
+    std::vector<int> order;
+    std::vector<uint64_t> fired_at(5, 0);
+    // 跨越第0层(256ms)、第1层(16s)与第2层的定时器
+    const uint64_t delays[] = {30, 10, 300, 20000, 255};
+    for (int i = 0; i < 5; ++i) {
+        mgr.addTimer(delays[i], [&order, &fired_at, i]() {
+            order.push_back(i);
+            fired_at[i] = g_fake_now_ms;
+        });
+    }
+
+    for (uint64_t t = 1000000; t <= 1000000 + 20000; ++t) {
+        mgr.runUntil(t);
+    }
+
+    CHECK(order.size() == 5);
+    CHECK(order[0] == 1);
+    CHECK(order[1] == 0);
+    CHECK(order[2] == 4);
+    CHECK(order[3] == 2);
+    CHECK(order[4] == 3);
+    for (int i = 0; i < 5; ++i) {
+        CHECK(fired_at[i] == 1000000 + delays[i]);
+    }
+    CHECK(!mgr.hasTimer());
+}
+
+// 大步跳跃推进(如 epoll 超时后一次处理)，高层槽位级联后也不能提前或漏掉
+static void test_cascade_jump()
+{
+    g_fake_now_ms = 5000000;
+    TestTimerManager mgr;
+
+    int fired = 0;
+    const uint64_t delay = 256 * 64 + 5;
+    mgr.addTimer(delay, [&fired]() { ++fired; });
+
+    uint64_t next = mgr.getNextTimer();
+    CHECK(next <= delay);
+
+    mgr.runUntil(5000000 + delay - 1);
+    CHECK(fired == 0);
+    mgr.runUntil(5000000 + delay + 1000);
+    CHECK(fired == 1);
+    CHECK(mgr.getNextTimer() == ~0ull);
+}
+
+static void test_cancel()
+{
+    g_fake_now_ms = 2000000;
+    TestTimerManager mgr;
+
+    int fired_a = 0, fired_b = 0;
+    auto a = mgr.addTimer(50, [&fired_a]() { ++fired_a; });
+    auto b = mgr.addTimer(100, [&fired_b]() { ++fired_b; });
+
+    CHECK(a->cancel());
+    // 重复取消失败
+    CHECK(!a->cancel());
+
+    mgr.runUntil(2000000 + 60);
+    CHECK(fired_a == 0);
+    CHECK(fired_b == 0);
+    CHECK(mgr.hasTimer());
+
+    CHECK(b->cancel());
+    CHECK(!mgr.hasTimer());
+    mgr.runUntil(2000000 + 200);
+    CHECK(fired_b == 0);
+}
+
+static void test_recurring()
+{
+    g_fake_now_ms = 3000000;
+    TestTimerManager mgr;
+
+    int fired = 0;
+    auto t = mgr.addTimer(100, [&fired]() { ++fired; }, true);
+    for (uint64_t now = 3000000; now <= 3000000 + 1000; now += 10) {
+        mgr.runUntil(now);
+    }
+    CHECK(fired == 10);
+    CHECK(t->cancel());
+}
+
+// 时钟小幅回退(未达到 rollover 阈值)：回退后新加的定时器必须按时到期
+static void test_clock_step_back()
+{
+    g_fake_now_ms = 10000000;
+    TestTimerManager mgr;
+
+    int fired_old = 0, fired_new = 0;
+    mgr.addTimer(50, [&fired_old]() { ++fired_old; });
+    mgr.runUntil(10000000 + 10);
+
+    // 回拨 10 分钟
+    const uint64_t back = 10000000 + 10 - 10 * 60 * 1000;
+    g_fake_now_ms = back;
+    mgr.addTimer(50, [&fired_new]() { ++fired_new; });
+    // 不能再报告回拨前的时间点
+    CHECK(mgr.getNextTimer() <= 50);
+
+    mgr.runUntil(back + 1);
+    CHECK(mgr.getNextTimer() <= 49);
+    mgr.runUntil(back + 50);
+    CHECK(fired_new == 1);
+    // 回拨前的定时器保留原时间点，与 set 后端一致
+    CHECK(fired_old == 0);
+    mgr.runUntil(10000000 + 50);
+    CHECK(fired_old == 1);
+}
+
+// 时钟大幅回退(超过 rollover 阈值)：全部定时器立即到期，重复定时器按新时间继续
+static void test_clock_rollover()
+{
+    g_fake_now_ms = 20000000;
+    TestTimerManager mgr;
+
+    int fired_once = 0, fired_recurring = 0;
+    mgr.addTimer(1000, [&fired_once]() { ++fired_once; });
+    auto r = mgr.addTimer(100, [&fired_recurring]() { ++fired_recurring; }, true);
+
+    const uint64_t back = 20000000 - 2 * 60 * 60 * 1000;
+    mgr.runUntil(back);
+    CHECK(fired_once == 1);
+    CHECK(fired_recurring == 1);
+
+    // 重复定时器重新放置到新的时间线上
+    CHECK(mgr.getNextTimer() <= 100);
+    mgr.runUntil(back + 99);
+    CHECK(fired_recurring == 1);
+    mgr.runUntil(back + 100);
+    CHECK(fired_recurring == 2);
+
+    // 回退后新加的定时器同样按时到期
+    int fired_new = 0;
+    mgr.addTimer(30, [&fired_new]() { ++fired_new; });
+    mgr.runUntil(back + 130);
+    CHECK(fired_new == 1);
+    CHECK(r->cancel());
+}
+
+static void run_all(const std::string &backend)
+{
+    set_backend(backend);
+    test_expiry_order();
+    test_cascade_jump();
+    test_cancel();
+    test_recurring();
+    test_clock_step_back();
+    test_clock_rollover();
+}
+
+} // namespace
+
+int main()
+{
+    run_all("wheel");
+    // set 后端作为对照，两种后端的行为应当一致
+    run_all("set");
+
+    std::cout << "[OK] test_timing_wheel\n";
+    return 0;
+}
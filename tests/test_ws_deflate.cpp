@@ -0,0 +1,269 @@
+#include "core/base/macro.hpp"
+#include "core/config/config.hpp"
+#include "core/net/http/ws_deflate.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+namespace {
+
+#define CHECK(cond)                                                                                 \
+    do {                                                                                             \
+        if (!(cond)) {                                                                               \
+            std::cerr << "[FAIL] " << __FILE__ << ":" << __LINE__ << " CHECK(" #cond ")\n"; \
+            std::abort();                                                                            \
+        }                                                                                            \
+    } while (0)
+
+using IM::http::WSDeflate;
+
+static const std::string kPrefix = "websocket.permessage_deflate.";
+
+static void set_bool(const std::string &name, bool v)
+{
+    IM::Config::Lookup<bool>(kPrefix + name)->setValue(v);
+}
+
+static void set_u32(const std::string &name, uint32_t v)
+{
+    IM::Config::Lookup<uint32_t>(kPrefix + name)->setValue(v);
+}
+
+// 每个用例从统一的配置开始：开启协商、不限内存、不强制关闭上下文接管
+static void reset_config()
+{
+    set_bool("enable", true);
+    set_u32("level", 1);
+    set_u32("max_memory", 0);
+    set_bool("server_no_context_takeover", false);
+    set_bool("client_no_context_takeover", false);
+    set_u32("server_max_window_bits", 15);
+    set_u32("client_max_window_bits", 15);
+}
+
+// 期望协商成功，返回上下文并检查响应头
+static WSDeflate::ptr accept(const std::string &offers, const std::string &expected)
+{
+    std::string response;
+    auto rt = WSDeflate::Negotiate(offers, response);
+    if (!rt || response != expected) {
+        std::cerr << "offer: " << offers << "\nresponse: " << response << "\nexpected: " << expected << "\n";
+    }
+    CHECK(rt);
+    CHECK(response == expected);
+    return rt;
+}
+
+// 期望拒绝，且不改动响应头
+static void decline(const std::string &offers)
+{
+    std::string response = "untouched";
+    auto rt = WSDeflate::Negotiate(offers, response);
+    if (rt) {
+        std::cerr << "offer: " << offers << "\nresponse: " << response << "\n";
+    }
+    CHECK(!rt);
+    CHECK(response == "untouched");
+}
+
+static void test_disabled()
+{
+    reset_config();
+    set_bool("enable", false);
+    decline("permessage-deflate");
+
+    set_bool("enable", true);
+    decline("");
+    decline("x-webkit-deflate-frame");
+}
+
+static void test_basic()
+{
+    reset_config();
+    auto d = accept("permessage-deflate", "permessage-deflate");
+    CHECK(d->getParams().serverMaxWindowBits == 15);
+    CHECK(d->getParams().clientMaxWindowBits == 15);
+    CHECK(d->getParams().memLevel == 8);
+    CHECK(!d->getParams().serverNoContextTakeover);
+    CHECK(!d->getParams().clientNoContextTakeover);
+
+    // 扩展名不区分大小写，参数两侧的空白被忽略
+    accept("  Permessage-Deflate ;  client_max_window_bits = 10 ",
+           "permessage-deflate; client_max_window_bits=10");
+
+    // 浏览器的典型请求：client_max_window_bits 不带值
+    d = accept("permessage-deflate; client_max_window_bits", "permessage-deflate; client_max_window_bits=15");
+    CHECK(d->getParams().clientMaxWindowBits == 15);
+
+    d = accept("permessage-deflate; server_no_context_takeover; client_no_context_takeover",
+               "permessage-deflate; server_no_context_takeover; client_no_context_takeover");
+    CHECK(d->getParams().serverNoContextTakeover);
+    CHECK(d->getParams().clientNoContextTakeover);
+}
+
+static void test_window_bits()
+{
+    reset_config();
+    auto d = accept("permessage-deflate; server_max_window_bits=10", "permessage-deflate; server_max_window_bits=10");
+    CHECK(d->getParams().serverMaxWindowBits == 10);
+    CHECK(d->getParams().memLevel == 3);
+
+    // 值可以带引号
+    d = accept("permessage-deflate; server_max_window_bits=\"12\"; client_max_window_bits=\"11\"",
+               "permessage-deflate; server_max_window_bits=12; client_max_window_bits=11");
+    CHECK(d->getParams().serverMaxWindowBits == 12);
+    CHECK(d->getParams().clientMaxWindowBits == 11);
+
+    // zlib 不支持 8 位的压缩窗口，客户端要求服务端使用 8 位时拒绝
+    decline("permessage-deflate; server_max_window_bits=8");
+
+    // 非法值
+    decline("permessage-deflate; server_max_window_bits=16");
+    decline("permessage-deflate; server_max_window_bits=7");
+    decline("permessage-deflate; server_max_window_bits=0");
+    decline("permessage-deflate; server_max_window_bits=09");
+    decline("permessage-deflate; server_max_window_bits=abc");
+    decline("permessage-deflate; server_max_window_bits=");
+    decline("permessage-deflate; server_max_window_bits");
+    decline("permessage-deflate; server_max_window_bits=\"12");
+    decline("permessage-deflate; client_max_window_bits=100");
+    // 客户端把自己的窗口限制为 8 位是合法的
+    d = accept("permessage-deflate; client_max_window_bits=8", "permessage-deflate; client_max_window_bits=8");
+    CHECK(d->getParams().clientMaxWindowBits == 8);
+    decline("permessage-deflate; client_max_window_bits=");
+}
+
+static void test_invalid_params()
+{
+    reset_config();
+    // 未知参数
+    decline("permessage-deflate; foo");
+    decline("permessage-deflate; foo=1");
+    // 无值参数带了值
+    decline("permessage-deflate; server_no_context_takeover=1");
+    decline("permessage-deflate; client_no_context_takeover=true");
+    // 重复参数
+    decline("permessage-deflate; server_no_context_takeover; server_no_context_takeover");
+    decline("permessage-deflate; server_max_window_bits=10; server_max_window_bits=10");
+    decline("permessage-deflate; client_max_window_bits; client_max_window_bits=10");
+}
+
+// 按顺序取第一个可以接受的候选
+static void test_fallback()
+{
+    reset_config();
+    accept("x-webkit-deflate-frame, permessage-deflate; client_max_window_bits",
+           "permessage-deflate; client_max_window_bits=15");
+    accept("permessage-deflate; server_max_window_bits=8, permessage-deflate; server_max_window_bits=9",
+           "permessage-deflate; server_max_window_bits=9");
+    accept("permessage-deflate; foo, permessage-deflate", "permessage-deflate");
+    accept("permessage-deflate; server_max_window_bits=10, permessage-deflate",
+           "permessage-deflate; server_max_window_bits=10");
+    decline("permessage-deflate; foo, permessage-deflate; server_max_window_bits=16");
+}
+
+static void test_config_limits()
+{
+    reset_config();
+    set_u32("server_max_window_bits", 12);
+    set_u32("client_max_window_bits", 10);
+
+    // 服务端窗口按配置缩小，客户端未提出时不回应
+    auto d = accept("permessage-deflate", "permessage-deflate");
+    CHECK(d->getParams().serverMaxWindowBits == 12);
+    // 客户端未声明支持时不能限制其窗口
+    CHECK(d->getParams().clientMaxWindowBits == 15);
+
+    d = accept("permessage-deflate; client_max_window_bits; server_max_window_bits=14",
+               "permessage-deflate; server_max_window_bits=12; client_max_window_bits=10");
+    CHECK(d->getParams().clientMaxWindowBits == 10);
+
+    // 客户端要求更小时取较小值
+    accept("permessage-deflate; server_max_window_bits=9; client_max_window_bits=9",
+           "permessage-deflate; server_max_window_bits=9; client_max_window_bits=9");
+
+    // 配置超出范围时按 9~15 处理
+    set_u32("server_max_window_bits", 4);
+    set_u32("client_max_window_bits", 30);
+    d = accept("permessage-deflate; client_max_window_bits", "permessage-deflate; client_max_window_bits=15");
+    CHECK(d->getParams().serverMaxWindowBits == 9);
+
+    // 配置强制关闭上下文接管
+    reset_config();
+    set_bool("server_no_context_takeover", true);
+    set_bool("client_no_context_takeover", true);
+    accept("permessage-deflate", "permessage-deflate; server_no_context_takeover; client_no_context_takeover");
+    accept("permessage-deflate; server_no_context_takeover",
+           "permessage-deflate; server_no_context_takeover; client_no_context_takeover");
+}
+
+static void test_memory_limit()
+{
+    reset_config();
+    set_u32("max_memory", 256 * 1024);
+    // 默认参数放不下时先缩小服务端窗口
+    auto d = accept("permessage-deflate", "permessage-deflate");
+    CHECK(d->getParams().serverMaxWindowBits == 14);
+    CHECK(d->getParams().memLevel == 7);
+    CHECK(WSDeflate::EstimateMemory(d->getParams()) <= 256 * 1024);
+
+    // 服务端窗口缩到最小仍放不下：客户端不支持缩小窗口时拒绝
+    set_u32("max_memory", 40000);
+    decline("permessage-deflate");
+
+    // 客户端支持时再缩小客户端窗口
+    d = accept("permessage-deflate; client_max_window_bits", "permessage-deflate; client_max_window_bits=14");
+    CHECK(d->getParams().serverMaxWindowBits == 9);
+    CHECK(WSDeflate::EstimateMemory(d->getParams()) <= 40000);
+
+    set_u32("max_memory", 1024);
+    decline("permessage-deflate; client_max_window_bits");
+}
+
+// 协商出的上下文能压缩并解压，上下文接管跨消息生效
+static void test_round_trip()
+{
+    reset_config();
+    set_u32("min_size", 64);
+    for (auto offer : {"permessage-deflate", "permessage-deflate; server_no_context_takeover"}) {
+        auto sender = accept(offer, offer);
+        auto receiver = accept(offer, offer);
+        CHECK(!sender->shouldCompress(63));
+        CHECK(sender->shouldCompress(64));
+
+        std::string msg = "{\"type\":\"message\",\"from\":\"alice\",\"to\":\"bob\",\"body\":\"hello\"}";
+        for (int i = 0; i < 3; ++i) {
+            std::string compressed, plain;
+            CHECK(sender->compress(msg.data(), msg.size(), compressed));
+            CHECK(!compressed.empty());
+            CHECK(receiver->decompress(compressed, 1024, plain) == 0);
+            CHECK(plain == msg);
+        }
+
+        std::string compressed, plain;
+        CHECK(sender->compress(msg.data(), msg.size(), compressed));
+        CHECK(receiver->decompress(compressed, msg.size() - 1, plain) == -2);
+    }
+}
+
+} // namespace
+
+int main()
+{
+    // 拒绝协商时的 DEBUG 日志与测试无关
+    IM_LOG_NAME("system")->setLevel(IM::Level::INFO);
+
+    test_disabled();
+    test_basic();
+    test_window_bits();
+    test_invalid_params();
+    test_fallback();
+    test_config_limits();
+    test_memory_limit();
+    test_round_trip();
+
+    std::cout << "[OK] test_ws_deflate\n";
+    return 0;
+}
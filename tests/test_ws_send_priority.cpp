@@ -0,0 +1,141 @@
+#include "core/base/macro.hpp"
+#include "core/io/iomanager.hpp"
+#include "core/net/core/address.hpp"
+#include "core/net/core/socket.hpp"
+#include "core/net/http/ws_session.hpp"
+
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+
+namespace {
+
+#define CHECK(cond)                                                                                 \
+    do {                                                                                             \
+        if (!(cond)) {                                                                               \
+            std::cerr << "[FAIL] " << __FILE__ << ":" << __LINE__ << " CHECK(" #cond ")\n"; \
+            std::abort();                                                                            \
+        }                                                                                            \
+    } while (0)
+
+// 入队帧之前先排入的 NORMAL 批量任务数
+static const int kBulkTasks = 16;
+
+struct Conn {
+    IM::Socket::ptr client;             ///< 对端，由主线程读取
+    IM::http::WSSession::ptr session;  ///< 服务端会话
+};
+
+static Conn make_conn()
+{
+    auto listener = IM::Socket::CreateTCPSocket();
+    CHECK(listener->bind(IM::IPv4Address::Create("127.0.0.1", 0)));
+    CHECK(listener->listen());
+
+    Conn conn;
+    conn.client = IM::Socket::CreateTCPSocket();
+    CHECK(conn.client->connect(listener->getLocalAddress()));
+    auto server = listener->accept();
+    CHECK(server);
+    conn.session.reset(new IM::http::WSSession(server));
+    return conn;
+}
+
+// 对端已收到、尚未读取的字节数
+static int pending_bytes(const Conn &conn)
+{
+    int n = 0;
+    CHECK(::ioctl(conn.client->getSocket(), FIONREAD, &n) == 0);
+    return n;
+}
+
+static void discard(const Conn &conn)
+{
+    char buf[256];
+    while (::recv(conn.client->getSocket(), buf, sizeof(buf), MSG_DONTWAIT) > 0);
+}
+
+/**
+ * @brief 在单线程 IOManager 中先排入 kBulkTasks 个 NORMAL 任务，再调用 send 入队一帧
+ * @return 第一个批量任务执行时对端已收到的字节数：大于0说明发送协程先于批量任务写出了该帧
+ */
+static int run_case(const Conn &conn, IM::Coroutine::Priority sender_priority,
+                    const std::function<void(IM::http::WSSession &)> &send)
+{
+    int seen = -1;
+    {
+        IM::IOManager iom(1, false, "test_ws_send_priority");
+        iom.schedule(
+            [&]() {
+                for (int i = 0; i < kBulkTasks; ++i) {
+                    iom.schedule([&]() {
+                        if (seen < 0) {
+                            seen = pending_bytes(conn);
+                        }
+                    });
+                }
+                send(*conn.session);
+            },
+            -1, sender_priority);
+        iom.stop();
+    }
+    discard(conn);
+    return seen;
+}
+
+// 入队 PONG 的协程即使是 NORMAL，发送协程也以 HIGH 调度，先于排队的批量任务写出
+static void test_pong_ahead_of_normal()
+{
+    Conn conn = make_conn();
+    int seen = run_case(conn, IM::Coroutine::NORMAL, [](IM::http::WSSession &s) { CHECK(s.pong() > 0); });
+    CHECK(seen > 0);
+    conn.session->close();
+}
+
+static void test_ping_ahead_of_normal()
+{
+    Conn conn = make_conn();
+    int seen = run_case(conn, IM::Coroutine::NORMAL, [](IM::http::WSSession &s) { CHECK(s.ping() > 0); });
+    CHECK(seen > 0);
+    conn.session->close();
+}
+
+// 普通协程发出的数据帧按 NORMAL 排在已入队的批量任务之后
+static void test_data_keeps_normal()
+{
+    Conn conn = make_conn();
+    int seen = run_case(conn, IM::Coroutine::NORMAL,
+                        [](IM::http::WSSession &s) { CHECK(s.sendMessage("hello") > 0); });
+    CHECK(seen == 0);
+    conn.session->close();
+}
+
+// 高优先级协程(如应用层心跳回复)发出的数据帧沿用其优先级
+static void test_data_inherits_high()
+{
+    Conn conn = make_conn();
+    int seen = run_case(conn, IM::Coroutine::HIGH,
+                        [](IM::http::WSSession &s) { CHECK(s.sendMessage("pong") > 0); });
+    CHECK(seen > 0);
+    conn.session->close();
+}
+
+} // namespace
+
+int main()
+{
+    // 调度器与协程的 DEBUG 日志与测试无关
+    IM_LOG_NAME("system")->setLevel(IM::Level::INFO);
+
+    test_pong_ahead_of_normal();
+    test_ping_ahead_of_normal();
+    test_data_keeps_normal();
+    test_data_inherits_high();
+
+    std::cout << "[OK] test_ws_send_priority\n";
+    return 0;
+}